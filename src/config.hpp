@@ -18,12 +18,17 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <cmath>
 #include <functional>
 #include <random>
+#include <algorithm>
 
 #include "packages/math/math.hpp"
 #include "packages/render/render.hpp"
+#include "packages/render/compositor.hpp"
+#include "packages/render/resolution_scaler.hpp"
+#include "packages/render/sprite_cache.hpp"
 #include "packages/game_objects/rocket.hpp"
 #include "packages/game_objects/island.hpp"
 #include "packages/game_objects/texture.hpp"
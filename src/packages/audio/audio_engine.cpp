@@ -0,0 +1,244 @@
+#include "audio_engine.hpp"
+
+namespace yume {
+
+    AudioEngine::AudioEngine(int frequency_v, int buffer_samples) {
+        if (Mix_OpenAudio(frequency_v, MIX_DEFAULT_FORMAT, 2, buffer_samples) != 0) {
+            std::cout << "Mix_OpenAudio Error: " << Mix_GetError() << '\n';
+            return;
+        }
+        deviceOpen = true;
+
+        Uint16 format{};
+        Mix_QuerySpec(&frequency, &format, &channels);
+        if (format != AUDIO_S16SYS || channels <= 0) {
+            std::cout << "Unsupported mixer format, the booster synthesis is disabled\n";
+            return;
+        }
+
+        // one-pole smoothing: ~80 ms for thrust changes, ~10 ms for the engine gate so switching never clicks
+        thrustSmoothing = 1.0f - std::exp(-1.0f / (0.08f * frequency));
+        gainSmoothing = 1.0f - std::exp(-1.0f / (0.01f * frequency));
+
+        synthEnabled = true;
+        Mix_SetPostMix(postMix, this);
+
+        std::cout << "Audio: " << frequency << " Hz, " << channels << " channels, " << buffer_samples << " sample buffer ("
+            << buffer_samples * 1000.0f / frequency << " ms)\n";
+    }
+
+    bool AudioEngine::isOpen() const {
+        return deviceOpen;
+    }
+
+    void AudioEngine::loadMusic(const char* file_name, int volume) {
+        if (!deviceOpen || musicLoader.joinable() || musicStarted) {
+            return;
+        }
+
+        musicVolume = volume;
+        musicLoader = std::thread([this, file = std::string(file_name)]() {
+            music = Mix_LoadMUS(file.c_str());
+            if (music == nullptr) {
+                std::cout << "Mix_LoadMUS Error: " << Mix_GetError() << '\n';
+            }
+            musicLoaded.store(true, std::memory_order_release);
+        });
+    }
+
+    void AudioEngine::update() {
+        if (musicStarted || !musicLoaded.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        musicStarted = true;
+        musicLoader.join();
+
+        if (music != nullptr) {
+            Mix_VolumeMusic(musicVolume);
+            Mix_PlayMusic(music, -1);
+        }
+    }
+
+    int AudioEngine::loadSound(const char* file_name) {
+        if (!synthEnabled || soundCount >= max_sounds) {
+            return -1;
+        }
+
+        // Mix_LoadWAV converts to the device format, it is mixed down to mono floats once here
+        Mix_Chunk* chunk = Mix_LoadWAV(file_name);
+        if (chunk == nullptr) {
+            std::cout << "Mix_LoadWAV Error: " << Mix_GetError() << '\n';
+            return -1;
+        }
+
+        const Sint16* pcm = reinterpret_cast<const Sint16*>(chunk->abuf);
+        std::size_t frames = chunk->alen / (sizeof(Sint16) * channels);
+
+        Sound& sound = sounds[soundCount];
+        sound.samples.resize(frames);
+        for (std::size_t i = 0; i < frames; i++) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                sum += pcm[i * channels + c];
+            }
+            sound.samples[i] = sum / (32768.0f * channels);
+        }
+        Mix_FreeChunk(chunk);
+
+        if (frames == 0) {
+            return -1;
+        }
+
+        sound.ready.store(true, std::memory_order_release);
+        return soundCount++;
+    }
+
+    void AudioEngine::setBoosterSound(int sound) {
+        commands.push(Command{ Command::Type::BoosterSound, 0.0f, sound });
+    }
+
+    void AudioEngine::setThrust(float thrust) {
+        if (thrust != postedThrust && commands.push(Command{ Command::Type::Thrust, thrust, -1 })) {
+            postedThrust = thrust;
+        }
+    }
+
+    void AudioEngine::setEngine(bool enabled) {
+        if (static_cast<int>(enabled) != postedEngine && commands.push(Command{ Command::Type::Engine, enabled ? 1.0f : 0.0f, -1 })) {
+            postedEngine = static_cast<int>(enabled);
+        }
+    }
+
+    void AudioEngine::play(int sound, float volume) {
+        if (sound >= 0) {
+            commands.push(Command{ Command::Type::OneShot, volume, sound });
+        }
+    }
+
+    void AudioEngine::postMix(void* udata, Uint8* stream, int len) {
+        AudioEngine* engine = static_cast<AudioEngine*>(udata);
+        engine->mix(reinterpret_cast<Sint16*>(stream), len / static_cast<int>(sizeof(Sint16) * engine->channels));
+    }
+
+    void AudioEngine::processCommands() {
+        Command command{};
+        while (commands.pop(command)) {
+            switch (command.type) {
+            case Command::Type::Thrust:
+                targetThrust = command.value;
+                break;
+            case Command::Type::Engine:
+                engineEnabled = command.value > 0.5f;
+                break;
+            case Command::Type::BoosterSound:
+                boosterSound = command.sound;
+                boosterPosition = 0.0;
+                break;
+            case Command::Type::OneShot: {
+                // reuse a free voice, otherwise steal the one that has been playing the longest
+                Voice* target = &voices[0];
+                for (Voice& voice : voices) {
+                    if (voice.sound < 0) {
+                        target = &voice;
+                        break;
+                    }
+                    if (voice.position > target->position) {
+                        target = &voice;
+                    }
+                }
+                target->sound = command.sound;
+                target->position = 0;
+                target->volume = command.value;
+                break;
+            }
+            }
+        }
+    }
+
+    float AudioEngine::nextNoise() {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        return static_cast<float>(noiseState) / 2147483648.0f - 1.0f;
+    }
+
+    void AudioEngine::mix(Sint16* stream, int frames) {
+        processCommands();
+
+        const Sound* booster = nullptr;
+        if (boosterSound >= 0 && sounds[boosterSound].ready.load(std::memory_order_acquire)) {
+            booster = &sounds[boosterSound];
+        }
+
+        for (int f = 0; f < frames; f++) {
+            smoothThrust += (targetThrust - smoothThrust) * thrustSmoothing;
+
+            // same loudness curve as the old Mix_VolumeChunk(booster, thrust * 7.5f), but continuous
+            float level = std::min(smoothThrust * 7.5f / 128.0f, 1.0f);
+            float targetGain = (engineEnabled && targetThrust > 1.0f) ? level : 0.0f;
+            boosterGain += (targetGain - boosterGain) * gainSmoothing;
+
+            float sample = 0.0f;
+
+            if (booster != nullptr && boosterGain > 0.0001f) {
+                const std::vector<float>& loop = booster->samples;
+                float normalized = smoothThrust / 16.0f;
+
+                std::size_t index = static_cast<std::size_t>(boosterPosition);
+                float frac = static_cast<float>(boosterPosition - index);
+                float s0 = loop[index];
+                float s1 = loop[(index + 1) % loop.size()];
+
+                // the loop is pitched up and the noise low-pass opens as thrust grows
+                boosterPosition += 0.85 + 0.35 * normalized;
+                if (boosterPosition >= loop.size()) {
+                    boosterPosition -= loop.size();
+                }
+                rumble += (nextNoise() - rumble) * (0.02f + 0.2f * normalized);
+
+                sample += ((s0 + (s1 - s0) * frac) * 0.8f + rumble * 0.6f) * boosterGain;
+            }
+
+            for (Voice& voice : voices) {
+                if (voice.sound < 0) {
+                    continue;
+                }
+
+                const std::vector<float>& samples = sounds[voice.sound].samples;
+                sample += samples[voice.position] * voice.volume;
+                voice.position += 1;
+                if (voice.position >= samples.size()) {
+                    voice.sound = -1;
+                }
+            }
+
+            if (sample == 0.0f) {
+                continue;
+            }
+
+            int value = static_cast<int>(sample * 32767.0f);
+            for (int c = 0; c < channels; c++) {
+                int mixed = stream[f * channels + c] + value;
+                stream[f * channels + c] = static_cast<Sint16>(std::clamp(mixed, -32768, 32767));
+            }
+        }
+    }
+
+    AudioEngine::~AudioEngine() {
+        if (musicLoader.joinable()) {
+            musicLoader.join();
+        }
+
+        if (!deviceOpen) {
+            return;
+        }
+
+        Mix_SetPostMix(nullptr, nullptr);
+        Mix_HaltMusic();
+        if (music != nullptr) {
+            Mix_FreeMusic(music);
+        }
+        Mix_CloseAudio();
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef YUME_AUDIO_ENGINE
+#define YUME_AUDIO_ENGINE
+
+#include "../../config.hpp"
+#include "../core/spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace yume {
+
+    // Owns the mixer device. The game thread never takes the mixer lock after startup: thrust, engine state
+    // and one-shots are posted through a lock-free queue and consumed by the post-mix callback,
+    // which synthesizes the booster and mixes the one-shot voices on top of SDL_mixer's output.
+    class AudioEngine {
+    public:
+        static constexpr int max_sounds{ 16 };
+        static constexpr int max_voices{ 8 };
+
+        AudioEngine(int frequency, int buffer_samples);
+
+        bool isOpen() const;
+
+        // loads the music on a worker thread, update() starts playback once it is ready
+        void loadMusic(const char* file_name, int volume);
+        void update();
+
+        // must be called before the sound is used, returns -1 on failure
+        int loadSound(const char* file_name);
+
+        void setBoosterSound(int sound);
+        void setThrust(float thrust);
+        void setEngine(bool enabled);
+        void play(int sound, float volume = 1.0f);
+
+        ~AudioEngine();
+
+    private:
+        struct Command {
+            enum class Type { Thrust, Engine, BoosterSound, OneShot } type;
+            float value;
+            int sound;
+        };
+
+        struct Sound {
+            std::vector<float> samples; // mono, device rate
+            std::atomic<bool> ready{ false };
+        };
+
+        struct Voice {
+            int sound{ -1 };
+            std::size_t position{ 0 };
+            float volume{ 0.0f };
+        };
+
+        bool deviceOpen{ false };
+        bool synthEnabled{ false };
+        int frequency{ 0 };
+        int channels{ 0 };
+
+        std::array<Sound, max_sounds> sounds;
+        int soundCount{ 0 };
+        SpscQueue<Command, 256> commands;
+
+        Mix_Music* music{};
+        int musicVolume{ 0 };
+        std::thread musicLoader;
+        std::atomic<bool> musicLoaded{ false };
+        bool musicStarted{ false };
+
+        // game thread copies of the last posted values, so a fast frame loop does not flood the queue
+        float postedThrust{ -1.0f };
+        int postedEngine{ -1 };
+
+        // audio thread state
+        std::array<Voice, max_voices> voices;
+        int boosterSound{ -1 };
+        double boosterPosition{ 0.0 };
+        float targetThrust{ 0.0f };
+        float smoothThrust{ 0.0f };
+        bool engineEnabled{ true };
+        float boosterGain{ 0.0f };
+        float rumble{ 0.0f };
+        Uint32 noiseState{ 0x9E3779B9u };
+        float thrustSmoothing{ 0.0f };
+        float gainSmoothing{ 0.0f };
+
+        static void postMix(void* udata, Uint8* stream, int len);
+        void mix(Sint16* stream, int frames);
+        void processCommands();
+        float nextNoise();
+    };
+}
+
+#endif
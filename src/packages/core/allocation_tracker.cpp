@@ -0,0 +1,133 @@
+#include "allocation_tracker.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace yume {
+
+    namespace {
+        // all of it is per thread, only the frame thread ever sets tracked
+        thread_local bool tracked = false;
+        thread_local AllocationSubsystem current = AllocationSubsystem::Frame;
+        thread_local AllocationStats frame{};
+        thread_local AllocationStats last{};
+        thread_local std::uint64_t frameCount = 0;
+
+        constexpr const char* subsystem_names[allocation_subsystem_count] = {
+            "frame", "events", "simulation", "autopilot", "interface", "audio", "telemetry", "render"
+        };
+    }
+
+    bool AllocationTracker::enabled() {
+#ifdef YUME_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void AllocationTracker::trackThisThread() {
+        tracked = true;
+    }
+
+    void AllocationTracker::record(std::size_t bytes) {
+        if (!tracked) {
+            return;
+        }
+        frame.count += 1;
+        frame.bytes += bytes;
+        frame.perSubsystem[static_cast<std::size_t>(current)] += 1;
+    }
+
+    void AllocationTracker::endFrame() {
+        last = frame;
+        frame = AllocationStats{};
+        frameCount += 1;
+    }
+
+    const AllocationStats& AllocationTracker::lastFrame() {
+        return last;
+    }
+
+    std::uint64_t AllocationTracker::frames() {
+        return frameCount;
+    }
+
+    bool AllocationTracker::checkSteadyState(std::uint64_t warmup_frames) {
+        if (frameCount <= warmup_frames || last.count == 0) {
+            return true;
+        }
+
+        const AllocationStats& stats = last;
+        std::cout << "frame " << frameCount << " allocated " << stats.count << " times (" << stats.bytes << " bytes):";
+        for (std::size_t i = 0; i < allocation_subsystem_count; i++) {
+            if (stats.perSubsystem[i] > 0) {
+                std::cout << ' ' << subsystem_names[i] << '=' << stats.perSubsystem[i];
+            }
+        }
+        std::cout << '\n';
+        return false;
+    }
+
+    const char* AllocationTracker::name(AllocationSubsystem subsystem) {
+        return subsystem_names[static_cast<std::size_t>(subsystem)];
+    }
+
+    AllocationSubsystem AllocationTracker::swapSubsystem(AllocationSubsystem subsystem) {
+        AllocationSubsystem previous = current;
+        current = subsystem;
+        return previous;
+    }
+}
+
+#ifdef YUME_TRACK_ALLOCATIONS
+
+// The plain and nothrow forms cover every container and std::string allocation. The over-aligned forms keep the
+// library's implementation and are not counted, nothing on the frame path uses them.
+void* operator new(std::size_t size) {
+    yume::AllocationTracker::record(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    yume::AllocationTracker::record(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef YUME_ALLOCATION_TRACKER
+#define YUME_ALLOCATION_TRACKER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace yume {
+
+    enum class AllocationSubsystem { Frame, Events, Simulation, Autopilot, Interface, Audio, Telemetry, Render, Count };
+
+    constexpr std::size_t allocation_subsystem_count = static_cast<std::size_t>(AllocationSubsystem::Count);
+
+    struct AllocationStats {
+        std::uint64_t count;
+        std::uint64_t bytes;
+        std::array<std::uint64_t, allocation_subsystem_count> perSubsystem;
+    };
+
+    // Counts heap allocations made through operator new on the thread that runs the frame loop, split by the
+    // subsystem that was active. Only builds defining YUME_TRACK_ALLOCATIONS (Debug) replace the global operators,
+    // in every other build enabled() is false and the counts stay zero. SDL's own mallocs are not counted.
+    class AllocationTracker {
+    public:
+        static bool enabled();
+
+        static void trackThisThread();
+        static void record(std::size_t bytes);
+
+        // closes the current frame, lastFrame() then holds its counts
+        static void endFrame();
+        static const AllocationStats& lastFrame();
+        static std::uint64_t frames();
+
+        // prints the last frame's breakdown and returns false if it allocated after warmup_frames frames
+        static bool checkSteadyState(std::uint64_t warmup_frames);
+
+        static const char* name(AllocationSubsystem subsystem);
+
+    private:
+        friend class AllocationScope;
+        static AllocationSubsystem swapSubsystem(AllocationSubsystem subsystem);
+    };
+
+    // Attributes the allocations made while it is alive to a subsystem.
+    class AllocationScope {
+    public:
+        explicit AllocationScope(AllocationSubsystem subsystem)
+            : previous(AllocationTracker::swapSubsystem(subsystem)) {}
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+        ~AllocationScope() {
+            AllocationTracker::swapSubsystem(previous);
+        }
+
+    private:
+        AllocationSubsystem previous;
+    };
+}
+
+#endif
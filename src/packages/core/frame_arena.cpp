@@ -0,0 +1,43 @@
+#include "frame_arena.hpp"
+
+#include <iostream>
+
+namespace yume {
+
+    FrameArena::FrameArena(std::size_t capacity_v)
+        : memory(std::make_unique<std::byte[]>(capacity_v)), size(capacity_v) {}
+
+    void* FrameArena::allocate(std::size_t bytes, std::size_t align) {
+        std::size_t start = (offset + align - 1) & ~(align - 1);
+
+        if (start + bytes > size) {
+            if (!overflowReported) {
+                std::cout << "FrameArena: out of memory, " << bytes << " bytes requested with " << size - offset << " left\n";
+                overflowReported = true;
+            }
+            return nullptr;
+        }
+
+        offset = start + bytes;
+        if (offset > peak) {
+            peak = offset;
+        }
+        return memory.get() + start;
+    }
+
+    void FrameArena::reset() {
+        offset = 0;
+    }
+
+    std::size_t FrameArena::used() const {
+        return offset;
+    }
+
+    std::size_t FrameArena::capacity() const {
+        return size;
+    }
+
+    std::size_t FrameArena::highWater() const {
+        return peak;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef YUME_FRAME_ARENA
+#define YUME_FRAME_ARENA
+
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace yume {
+
+    // Bump allocator that is reset once per frame. Nothing is freed individually and nothing touches the heap
+    // after construction; running out returns nullptr and is reported once.
+    class FrameArena {
+    public:
+        explicit FrameArena(std::size_t capacity_v);
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+        template <typename T>
+        T* allocateArray(std::size_t count) {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        void reset();
+
+        std::size_t used() const;
+        std::size_t capacity() const;
+        std::size_t highWater() const;
+
+    private:
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+        std::size_t offset{ 0 };
+        std::size_t peak{ 0 };
+        bool overflowReported{ false };
+    };
+
+    // Formats a line of text into arena memory with std::to_chars, the view stays valid until the arena is reset.
+    // Output that does not fit is cut off.
+    class TextBuilder {
+    public:
+        TextBuilder(FrameArena& arena, std::size_t capacity_v)
+            : begin(arena.allocateArray<char>(capacity_v)), end(begin), limit(begin == nullptr ? nullptr : begin + capacity_v - 1) {
+            if (begin != nullptr) {
+                *end = '\0';
+            }
+        }
+
+        TextBuilder& append(std::string_view text) {
+            for (char c : text) {
+                if (end == limit) break;
+                *end++ = c;
+            }
+            terminate();
+            return *this;
+        }
+
+        TextBuilder& append(int value) {
+            return append(std::to_chars(end, limit, value));
+        }
+
+        // fixed notation, 6 decimals matches std::to_string
+        TextBuilder& append(float value, int precision = 6) {
+            return append(std::to_chars(end, limit, value, std::chars_format::fixed, precision));
+        }
+
+        std::string_view view() const {
+            return std::string_view(begin == nullptr ? "" : begin, static_cast<std::size_t>(end - begin));
+        }
+
+        const char* c_str() const {
+            return begin == nullptr ? "" : begin;
+        }
+
+    private:
+        char* begin;
+        char* end;
+        char* limit;
+
+        TextBuilder& append(std::to_chars_result result) {
+            if (result.ec == std::errc()) {
+                end = result.ptr;
+            }
+            terminate();
+            return *this;
+        }
+
+        void terminate() {
+            if (end != nullptr) {
+                *end = '\0';
+            }
+        }
+    };
+}
+
+#endif
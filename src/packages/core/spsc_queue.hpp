@@ -0,0 +1,63 @@
+#ifndef YUME_SPSC_QUEUE
+#define YUME_SPSC_QUEUE
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace yume {
+
+    // Bounded wait-free queue for exactly one producer thread and one consumer thread.
+    template <typename T, std::size_t Capacity>
+    class SpscQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+        SpscQueue() = default;
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // producer side, returns false when the queue is full
+        bool push(const T& item) {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+
+            buffer[head & (Capacity - 1)] = item;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side, returns false when the queue is empty
+        bool pop(T& item) {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            item = buffer[tail & (Capacity - 1)];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t size() const {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        static constexpr std::size_t capacity() {
+            return Capacity;
+        }
+
+    private:
+        alignas(64) std::atomic<std::size_t> head_{ 0 };
+        alignas(64) std::atomic<std::size_t> tail_{ 0 };
+        alignas(64) std::array<T, Capacity> buffer{};
+    };
+}
+
+#endif
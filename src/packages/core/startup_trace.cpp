@@ -0,0 +1,112 @@
+#include "startup_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace yume {
+
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+
+        // set during static initialization, so the trace also covers what ran before main()
+        const clock_type::time_point origin = clock_type::now();
+
+        struct Event {
+            const char* name;
+            double startMs;
+            double endMs;
+            int lane;
+            bool instant;
+        };
+
+        std::mutex eventsMutex;
+        std::vector<Event> events;
+        std::vector<std::thread::id> lanes;
+
+        // one lane per thread in the order they first record, main() is lane 0
+        int laneOf(std::thread::id thread) {
+            auto found = std::find(lanes.begin(), lanes.end(), thread);
+            if (found != lanes.end()) {
+                return static_cast<int>(found - lanes.begin());
+            }
+            lanes.push_back(thread);
+            return static_cast<int>(lanes.size()) - 1;
+        }
+
+        void add(const char* name, double startMs, double endMs, bool instant) {
+            std::lock_guard<std::mutex> lock(eventsMutex);
+            events.push_back(Event{ name, startMs, endMs, laneOf(std::this_thread::get_id()), instant });
+        }
+    }
+
+    double StartupTrace::now() {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - origin).count();
+    }
+
+    void StartupTrace::record(const char* name, double startMs, double endMs) {
+        add(name, startMs, endMs, false);
+    }
+
+    void StartupTrace::mark(const char* name) {
+        double at = now();
+        add(name, at, at, true);
+    }
+
+    double StartupTrace::markTime(const char* name) {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        for (const Event& event : events) {
+            if (event.instant && std::strcmp(event.name, name) == 0) {
+                return event.startMs;
+            }
+        }
+        return -1.0;
+    }
+
+    void StartupTrace::report() {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        std::vector<Event> sorted = events;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Event& a, const Event& b) { return a.startMs < b.startMs; });
+
+        std::printf("Startup trace (ms since launch)\n");
+        std::printf("  thread    start      end     took  phase\n");
+        for (const Event& event : sorted) {
+            if (event.instant) {
+                std::printf("  %6d %8.2f                    * %s\n", event.lane, event.startMs, event.name);
+            }
+            else {
+                std::printf("  %6d %8.2f %8.2f %8.2f  %s\n", event.lane, event.startMs, event.endMs, event.endMs - event.startMs, event.name);
+            }
+        }
+    }
+
+    // the Trace Event Format, one complete event ("X") per phase and an instant event ("i") per mark
+    bool StartupTrace::writeChromeTrace(const std::string& file_name) {
+        std::FILE* file = std::fopen(file_name.c_str(), "w");
+        if (file == nullptr) {
+            std::printf("Could not write the startup trace to %s\n", file_name.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        std::fprintf(file, "{\"traceEvents\":[\n");
+        for (std::size_t i = 0; i < events.size(); i++) {
+            const Event& event = events[i];
+            if (event.instant) {
+                std::fprintf(file, "  {\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%d,\"ts\":%.1f}", event.name, event.lane, event.startMs * 1000.0);
+            }
+            else {
+                std::fprintf(file, "  {\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f}", event.name, event.lane,
+                    event.startMs * 1000.0, (event.endMs - event.startMs) * 1000.0);
+            }
+            std::fprintf(file, i + 1 < events.size() ? ",\n" : "\n");
+        }
+        std::fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+        std::fclose(file);
+        return true;
+    }
+}
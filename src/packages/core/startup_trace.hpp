@@ -0,0 +1,43 @@
+#ifndef YUME_STARTUP_TRACE
+#define YUME_STARTUP_TRACE
+
+#include <string>
+
+namespace yume {
+
+    // Named startup phases with steady clock timestamps in milliseconds since the process started.
+    // report() prints them in start order, writeChromeTrace() saves them for chrome://tracing or Perfetto.
+    class StartupTrace {
+    public:
+        static double now();
+
+        static void record(const char* name, double startMs, double endMs);
+        // a zero length event, for moments like the first frame on screen
+        static void mark(const char* name);
+        // when the named mark was set, negative if it never was
+        static double markTime(const char* name);
+
+        static void report();
+        static bool writeChromeTrace(const std::string& file_name);
+    };
+
+    // Records the phase from construction to destruction on the calling thread.
+    class StartupPhase {
+    public:
+        explicit StartupPhase(const char* name_v)
+            : name(name_v), start(StartupTrace::now()) {}
+
+        StartupPhase(const StartupPhase&) = delete;
+        StartupPhase& operator=(const StartupPhase&) = delete;
+
+        ~StartupPhase() {
+            StartupTrace::record(name, start, StartupTrace::now());
+        }
+
+    private:
+        const char* name;
+        double start;
+    };
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include "../../config.hpp"
 #include "rocket.hpp"
 
+namespace yume { class SpriteCache; }
+
+class Rocket;
+
 class Island {
 public:
 	yume::vec2<float> position;
@@ -11,14 +15,22 @@ public:
 
 	Island(yume::vec2<float> position_v, yume::vec2<float> size_v, SDL_Renderer* renderer);
 
-	void update(yume::vec2<float>* rocket_position, yume::vec2<float>* rocket_size, yume::vec2<float>* rocket_velocity, bool* rocket_grounded, bool* rocket_on_island, std::function<void()> lvlOut);
+	void update(Rocket* rocket);
+	// the island mask follows size, it is rebuilt the first time it is asked for after a resize
+	const yume::CollisionShapes* collisionShapes(const Rocket* rocket);
 	void render(SDL_Renderer* renderer);
+	void setSpriteCache(yume::SpriteCache* cache);
 
 	~Island();
 
 private:
 	SDL_Texture* islandTexture{};
 	yume::RenderManager renderManager;
+	yume::SpriteCache* spriteCache{ nullptr };
+	yume::AlphaImage alpha;
+	yume::CollisionMask mask;
+	yume::vec2<float> maskSize{ 0, 0 };
+	yume::CollisionShapes shapes{};
 };
 
 #endif
\ No newline at end of file
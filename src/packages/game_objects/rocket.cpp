@@ -1,78 +1,59 @@
 #include "rocket.hpp"
 
 Rocket::Rocket(yume::vec2<float> position_v, yume::vec2<float> size_v, SDL_Renderer* renderer)
-    : position(position_v), size(size_v), velocity(yume::vec2<float>(0, 0)), rotation(90), thrust(0), gravity(9.81), thrustPower(1.0), rotationalVelocity(0.0f), grounded(false), on_island(false) {
+    : position(position_v), size(size_v), velocity(yume::vec2<float>(0, 0)), grounded(false), on_island(false), is_stable(true), rotation(90), thrust(0), gravity(9.81), thrustPower(1.0), rotationalVelocity(0.0f), wind(yume::vec2<float>::ZERO()) {
     rocketTexture = renderManager.loadTexture("res/textures/rocket.png", renderer);
+    collisionMasks = yume::RotatedMaskSet(renderManager.loadAlpha("res/textures/rocket.png"), (int)size.x, (int)size.y, 2.0f);
 }
 
-void Rocket::levelOut() {
-    if (rotation > 105 && rotation < 180) {
-        rotationalVelocity += 0.6f;
-    }
-    else if (rotation < 75 && rotation > 0) {
-        rotationalVelocity -= 0.6f;
-    }
-    else if (rotation >= 75 && rotation <= 105) {
-        if (rotation > 90) {
-            rotationalVelocity -= 0.2f;
-        }
-        else if (rotation < 90) {
-            rotationalVelocity += 0.2f;
-        }
-    }
+yume::RocketState Rocket::state() const {
+    return yume::RocketState{ position, size, velocity, previousVelocity, rotation, thrust, gravity, rotationalVelocity, grounded, on_island, is_stable, engine_enable, wind };
 }
 
-void Rocket::update(float deltaTime) {
-    float radians = rotation * M_PI / 180.0f;
-    yume::vec2<float> thrustForce(cos(radians) * thrust, sin(radians) * thrust);
-
-    if (engine_enable) {
-        velocity = velocity - thrustForce * deltaTime;
-    }
-    velocity.y = velocity.y + gravity * deltaTime;
-
-    position = position + velocity * deltaTime;
-
-    rotationalVelocity = rotationalVelocity * air_resistance_factor;
-    rotation = rotation + rotationalVelocity * deltaTime;
-
-    if (position.y > 495 - size.y) {
-        grounded = true;
-    }
-    else {
-        grounded = false;
-    }
-
-    if (grounded) {
-        position.y = 495 - size.y;
-        velocity = yume::vec2<float>::ZERO();
-        on_island = false;
+void Rocket::setState(const yume::RocketState& state) {
+    position = state.position;
+    size = state.size;
+    velocity = state.velocity;
+    previousVelocity = state.previousVelocity;
+    rotation = state.rotation;
+    thrust = state.thrust;
+    gravity = state.gravity;
+    rotationalVelocity = state.rotationalVelocity;
+    grounded = state.grounded;
+    on_island = state.on_island;
+    is_stable = state.is_stable;
+    engine_enable = state.engine_enable;
+    wind = state.wind;
+}
 
-        levelOut();
-    }
+void Rocket::levelOut() {
+    yume::RocketState current = state();
+    yume::levelOut(current);
+    rotationalVelocity = current.rotationalVelocity;
+}
 
-    if (rotation > 360.0f) {
-        rotation = 0.0f;
-    }
-    else if (rotation < 0.0f) {
-        rotation = 360.0f;
-    }
+void Rocket::update(float deltaTime) {
+    yume::RocketState current = state();
+    yume::stepRocket(current, deltaTime);
+    setState(current);
+}
 
-    if (rotation <= 105.0f && rotation >= 75.0f) {
-        is_stable = true;
+void Rocket::render(SDL_Renderer* renderer) {
+    SDL_Rect rocketRect = { (int)position.x, (int)position.y, (int)size.x, (int)size.y };
+    if (spriteCache != nullptr) {
+        spriteCache->draw(renderer, rocketTexture, rocketRect, rotation - 90);
     }
     else {
-        is_stable = false;
+        SDL_RenderCopyEx(renderer, rocketTexture, nullptr, &rocketRect, rotation - 90, nullptr, SDL_FLIP_NONE);
     }
+}
 
-    if (velocity.x != 0 && velocity.y != 0) {
-        previousVelocity = velocity;
-    }
+void Rocket::setSpriteCache(yume::SpriteCache* cache) {
+    spriteCache = cache;
 }
 
-void Rocket::render(SDL_Renderer* renderer) {
-    SDL_Rect rocketRect = { (int)position.x, (int)position.y, (int)size.x, (int)size.y };
-    SDL_RenderCopyEx(renderer, rocketTexture, nullptr, &rocketRect, rotation - 90, nullptr, SDL_FLIP_NONE);
+const yume::RotatedMaskSet& Rocket::masks() const {
+    return collisionMasks;
 }
 
 bool Rocket::getEngineState() {
@@ -80,26 +61,26 @@ bool Rocket::getEngineState() {
 }
 
 void Rocket::increaseThrust() {
-    if (thrust < max_thrust) {
-        thrust += 0.4f; // 0.32f
+    if (thrust < yume::rocket_max_thrust) {
+        thrust += yume::rocket_thrust_up; // 0.32f
     }
 }
 
 void Rocket::decreaseThrust() {
     if (thrust > 0) {
-        thrust -= 0.5f; // 0.48f
+        thrust -= yume::rocket_thrust_down; // 0.48f
     }
 }
 
 void Rocket::rotateLeft() {
     if (!grounded) {
-        rotationalVelocity -= 3.6f;
+        rotationalVelocity -= yume::rocket_rotate_step;
     }
 }
 
 void Rocket::rotateRight() {
     if (!grounded) {
-        rotationalVelocity += 3.6f;
+        rotationalVelocity += yume::rocket_rotate_step;
     }
 }
 
@@ -2,12 +2,15 @@
 #define YUME_ROCKET
 
 #include "../../config.hpp"
+#include "../simulation/flight_model.hpp"
+
+namespace yume { class SpriteCache; }
 
 class Rocket {
 private:
-    const float max_thrust{ 16.0 };
-    const float air_resistance_factor{ 0.98f }; // 0.98f
     yume::RenderManager renderManager;
+    yume::SpriteCache* spriteCache{ nullptr };
+    yume::RotatedMaskSet collisionMasks;
 
 public:
     yume::vec2<float> position;
@@ -24,11 +27,16 @@ public:
     float thrustPower;
     float rotationalVelocity;
     bool engine_enable = true;
+    yume::vec2<float> wind;
 
     Rocket(yume::vec2<float> position_v, yume::vec2<float> size_v, SDL_Renderer* renderer);
+    yume::RocketState state() const;
+    void setState(const yume::RocketState& state);
     void levelOut();
     void update(float deltaTime);
     void render(SDL_Renderer* renderer);
+    void setSpriteCache(yume::SpriteCache* cache);
+    const yume::RotatedMaskSet& masks() const;
     bool getEngineState();
     void increaseThrust();
     void decreaseThrust();
@@ -40,4 +48,4 @@ public:
     ~Rocket();
 };
 
-#endif
\ No newline at end of file
+#endif
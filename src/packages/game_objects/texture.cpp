@@ -5,21 +5,42 @@ Texture::Texture(yume::vec2<float> position_v, yume::vec2<float> size_v, const c
     texture = renderManager.loadTexture(file_name, renderer); //  IN DEVELOPENT <- C++ TEST XDDD
 }
 
-void Texture::update(std::vector<std::string> fileNames, float duration, float deltaTime, SDL_Renderer* renderer) {
-    timer += deltaTime;
+void Texture::loadFrames(const std::vector<std::string>& fileNames, SDL_Renderer* renderer) {
+    for (SDL_Texture* frame : frames) {
+        SDL_DestroyTexture(frame);
+    }
+    frames.clear();
 
-    if (timer >= duration) {
-        if (texture != nullptr) {
-            SDL_DestroyTexture(texture);
-        }
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+
+    for (const std::string& fileName : fileNames) {
+        frames.push_back(renderManager.loadTexture(fileName.c_str(), renderer));
+    }
+
+    actualAnimIndex = 0;
+    timer = 0.0f;
+    if (!frames.empty()) {
+        texture = frames[0];
+    }
+}
 
-        texture = renderManager.loadTexture(fileNames[actualAnimIndex].c_str(), renderer);
+void Texture::update(float duration, float deltaTime) {
+    if (frames.empty()) {
+        return;
+    }
+
+    timer += deltaTime;
 
+    if (timer >= duration) {
         actualAnimIndex += 1;
-        if (actualAnimIndex >= fileNames.size()) {
+        if (actualAnimIndex >= frames.size()) {
             actualAnimIndex = 0;
         }
 
+        texture = frames[actualAnimIndex];
         timer = 0.0f;
     }
 }
@@ -27,9 +48,23 @@ void Texture::update(std::vector<std::string> fileNames, float duration, float d
 
 void Texture::render(SDL_Renderer* renderer) {
     SDL_Rect rect = { (int)position.x, (int)position.y, (int)size.x, (int)size.y };
-    SDL_RenderCopyEx(renderer, texture, nullptr, &rect, rotation - 90, nullptr, SDL_FLIP_NONE);
+    if (spriteCache != nullptr) {
+        spriteCache->draw(renderer, texture, rect, rotation - 90);
+    }
+    else {
+        SDL_RenderCopyEx(renderer, texture, nullptr, &rect, rotation - 90, nullptr, SDL_FLIP_NONE);
+    }
+}
+
+void Texture::setSpriteCache(yume::SpriteCache* cache) {
+    spriteCache = cache;
 }
 
 Texture::~Texture() {
-    SDL_DestroyTexture(texture);
+    if (frames.empty()) {
+        SDL_DestroyTexture(texture);
+    }
+    for (SDL_Texture* frame : frames) {
+        SDL_DestroyTexture(frame);
+    }
 }
\ No newline at end of file
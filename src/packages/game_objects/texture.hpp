@@ -3,6 +3,8 @@
 
 #include "../../config.hpp"
 
+namespace yume { class SpriteCache; }
+
 class Texture {
 public:
 	yume::vec2<float> position;
@@ -11,14 +13,19 @@ public:
 
 	Texture(yume::vec2<float> position_v, yume::vec2<float> size_v, const char* file_name, SDL_Renderer* renderer);
 
-	void update(std::vector<std::string> file_names, float duration, float deltaTime, SDL_Renderer* renderer);
+	// animation frames are loaded once, update() only switches between them
+	void loadFrames(const std::vector<std::string>& file_names, SDL_Renderer* renderer);
+	void update(float duration, float deltaTime);
 	void render(SDL_Renderer* renderer);
+	void setSpriteCache(yume::SpriteCache* cache);
 
 	~Texture();
 
 private:
 	yume::RenderManager renderManager;
 	SDL_Texture* texture{};
+	yume::SpriteCache* spriteCache{ nullptr };
+	std::vector<SDL_Texture*> frames;
 	float timer{ 0.0f };
 	int actualAnimIndex{ 0 };
 };
@@ -0,0 +1,306 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace yume {
+
+    namespace {
+        thread_local const JobSystem* currentSystem = nullptr;
+        thread_local unsigned currentIndex = 0;
+    }
+
+    bool JobDeque::push(Job* job) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= capacity) {
+            return false;
+        }
+
+        buffer[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* JobDeque::pop() {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = buffer[b & (capacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last job, race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* JobDeque::steal() {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Job* job = buffer[t & (capacity - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    JobSystem::JobSystem(unsigned threadCount_v) {
+        unsigned count = threadCount_v;
+        if (count == 0) {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            auto worker = std::make_unique<Worker>();
+            worker->ring = std::make_unique<Job[]>(ring_size);
+            workers.push_back(std::move(worker));
+        }
+
+        currentSystem = this;
+        currentIndex = 0;
+
+        for (unsigned i = 1; i < count; i++) {
+            threads.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    unsigned JobSystem::threadCount() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    int JobSystem::currentWorker() const {
+        return currentSystem == this ? static_cast<int>(currentIndex) : -1;
+    }
+
+    Job* JobSystem::allocate() {
+        int index = currentWorker();
+        if (index < 0) {
+            Job* job = new Job();
+            job->heapAllocated = true;
+            return job;
+        }
+
+        Worker& worker = *workers[index];
+        Job* job = &worker.ring[worker.ringIndex++ & (ring_size - 1)];
+        if (job->busy.load(std::memory_order_acquire)) {
+            job = new Job();
+            job->heapAllocated = true;
+            return job;
+        }
+        job->busy.store(true, std::memory_order_relaxed);
+        job->heapAllocated = false;
+        return job;
+    }
+
+    void JobSystem::submit(Job* job) {
+        int index = currentWorker();
+
+        if (index >= 0 && workers[index]->deque.push(job)) {
+            wakeOne();
+            return;
+        }
+
+        if (index >= 0) {
+            // deque full, running it right away is still correct
+            execute(job);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            injected.push_back(job);
+            injectedCount.fetch_add(1, std::memory_order_release);
+        }
+        wakeOne();
+    }
+
+    void JobSystem::lockCounter(JobCounter& counter) {
+        int value = counter.pending.load(std::memory_order_relaxed);
+        while (true) {
+            if (value & JobCounter::locked) {
+                std::this_thread::yield();
+                value = counter.pending.load(std::memory_order_relaxed);
+            }
+            else if (counter.pending.compare_exchange_weak(value, value | JobCounter::locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    void JobSystem::chain(JobCounter& dependency, Job* job) {
+        lockCounter(dependency);
+
+        if (dependency.value() == 0) {
+            dependency.pending.fetch_and(~JobCounter::locked, std::memory_order_release);
+            submit(job);
+            return;
+        }
+
+        job->next = dependency.continuations;
+        dependency.continuations = job;
+        dependency.pending.fetch_and(~JobCounter::locked, std::memory_order_release);
+    }
+
+    void JobSystem::finish(Job* job) {
+        JobCounter* counter = job->counter;
+        if (job->heapAllocated) {
+            delete job;
+        }
+        else {
+            job->busy.store(false, std::memory_order_release);
+        }
+
+        if (counter == nullptr) {
+            return;
+        }
+
+        // any job but the last only decrements
+        int value = counter->pending.load(std::memory_order_relaxed);
+        while (true) {
+            if ((value & ~JobCounter::locked) > 1) {
+                if (counter->pending.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+            else if (value & JobCounter::locked) {
+                std::this_thread::yield();
+                value = counter->pending.load(std::memory_order_relaxed);
+            }
+            else if (counter->pending.compare_exchange_weak(value, value | JobCounter::locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        // the last job takes the continuations while it holds the lock, then unlocks and reaches zero at once,
+        // which is the last time it touches the counter
+        Job* ready = counter->continuations;
+        counter->continuations = nullptr;
+        counter->pending.fetch_sub(1 | JobCounter::locked, std::memory_order_acq_rel);
+
+        while (ready != nullptr) {
+            Job* next = ready->next;
+            submit(ready);
+            ready = next;
+        }
+    }
+
+    void JobSystem::execute(Job* job) {
+        job->entry(*job);
+        finish(job);
+    }
+
+    Job* JobSystem::findJob(unsigned self) {
+        if (Job* job = workers[self]->deque.pop()) {
+            return job;
+        }
+
+        if (injectedCount.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            if (!injected.empty()) {
+                Job* job = injected.front();
+                injected.pop_front();
+                injectedCount.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        unsigned count = static_cast<unsigned>(workers.size());
+        for (unsigned offset = 1; offset < count; offset++) {
+            if (Job* job = workers[(self + offset) % count]->deque.steal()) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::wakeOne() {
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            sleepCondition.notify_one();
+        }
+    }
+
+    void JobSystem::wait(JobCounter& counter) {
+        int index = currentWorker();
+
+        while (!counter.done()) {
+            Job* job = index >= 0 ? findJob(static_cast<unsigned>(index)) : nullptr;
+            if (job != nullptr) {
+                execute(job);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::workerLoop(unsigned index) {
+        currentSystem = this;
+        currentIndex = index;
+        int idle = 0;
+
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (Job* job = findJob(index)) {
+                execute(job);
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // the timeout only bounds a missed wake up, submit() notifies sleepers
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            if (Job* job = findJob(index)) {
+                sleepers.fetch_sub(1, std::memory_order_seq_cst);
+                lock.unlock();
+                execute(job);
+                idle = 0;
+                continue;
+            }
+            sleepCondition.wait_for(lock, std::chrono::milliseconds(2));
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            sleepCondition.notify_all();
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (Job* job : injected) {
+            delete job;
+        }
+
+        if (currentSystem == this) {
+            currentSystem = nullptr;
+        }
+    }
+}
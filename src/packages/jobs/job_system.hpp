@@ -0,0 +1,191 @@
+#ifndef YUME_JOB_SYSTEM
+#define YUME_JOB_SYSTEM
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace yume {
+
+    constexpr std::size_t job_payload_size = 64;
+
+    class JobCounter;
+
+    // A job carries its callable inline, spawning one never touches the heap.
+    struct Job {
+        void (*entry)(Job&);
+        JobCounter* counter;
+        Job* next;
+        bool heapAllocated;
+        std::atomic<bool> busy{ false };  // a ring slot stays taken from allocate() until the job finishes
+        alignas(std::max_align_t) unsigned char payload[job_payload_size];
+    };
+
+    // Counts unfinished jobs. Jobs can wait on it with JobSystem::wait() or be chained with JobSystem::runAfter().
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool done() const {
+            return value() == 0;
+        }
+
+        int value() const {
+            return pending.load(std::memory_order_acquire) & ~locked;
+        }
+
+    private:
+        friend class JobSystem;
+        // the lock is a bit of pending, the last job clears it and the count in one step, so once a waiter sees
+        // zero nothing touches the counter again and it can go out of scope
+        static constexpr int locked = 1 << 30;
+        std::atomic<int> pending{ 0 };
+        Job* continuations{ nullptr };
+    };
+
+    // Chase-Lev deque: the owning worker pushes and pops at the bottom, other workers steal from the top.
+    class JobDeque {
+    public:
+        static constexpr std::int64_t capacity = 4096;
+
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        alignas(64) std::atomic<std::int64_t> top{ 0 };
+        alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+        std::atomic<Job*> buffer[capacity]{};
+    };
+
+    // One worker per core, each with its own deque and job ring. The thread that creates the system is worker 0
+    // and executes jobs whenever it waits, so a wait on the main thread never idles a core.
+    class JobSystem {
+    public:
+        // 0 threads means one per hardware thread, the creating thread counts as one of them
+        explicit JobSystem(unsigned threads = 0);
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        unsigned threadCount() const;
+
+        template <typename F>
+        void run(F&& function, JobCounter* counter = nullptr) {
+            Job* job = makeJob(std::forward<F>(function), counter);
+            if (counter != nullptr) {
+                counter->pending.fetch_add(1, std::memory_order_relaxed);
+            }
+            submit(job);
+        }
+
+        // the job is only queued once dependency reaches zero
+        template <typename F>
+        void runAfter(JobCounter& dependency, F&& function, JobCounter* counter = nullptr) {
+            Job* job = makeJob(std::forward<F>(function), counter);
+            if (counter != nullptr) {
+                counter->pending.fetch_add(1, std::memory_order_relaxed);
+            }
+            chain(dependency, job);
+        }
+
+        // executes queued jobs until the counter reaches zero
+        void wait(JobCounter& counter);
+
+        // calls body(begin, end) over [0, count) in chunks of at most grain items
+        template <typename F>
+        void parallelFor(std::size_t count, std::size_t grain, F&& body) {
+            if (count == 0) {
+                return;
+            }
+            grain = grain == 0 ? 1 : grain;
+            if ((count + grain - 1) / grain > max_chunks) {
+                grain = (count + max_chunks - 1) / max_chunks;
+            }
+
+            if (threads.empty() || count <= grain) {
+                body(std::size_t{ 0 }, count);
+                return;
+            }
+
+            JobCounter counter;
+            auto* shared = &body;
+            for (std::size_t begin = grain; begin < count; begin += grain) {
+                std::size_t end = begin + grain < count ? begin + grain : count;
+                run([shared, begin, end]() { (*shared)(begin, end); }, &counter);
+            }
+
+            // the caller takes the first chunk itself instead of queuing it
+            body(std::size_t{ 0 }, grain);
+            wait(counter);
+        }
+
+        ~JobSystem();
+
+    private:
+        struct Worker {
+            JobDeque deque;
+            std::unique_ptr<Job[]> ring;
+            std::size_t ringIndex{ 0 };
+        };
+
+        // a worker's ring slot is reused after ring_size spawns, a slot whose job is still queued or parked on a
+        // counter is skipped for the heap
+        static constexpr std::size_t ring_size = 8192;
+        static constexpr std::size_t max_chunks = 1024;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+        std::atomic<bool> stopping{ false };
+
+        // jobs submitted from threads that are not workers
+        std::mutex injectMutex;
+        std::deque<Job*> injected;
+        std::atomic<int> injectedCount{ 0 };
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        std::atomic<int> sleepers{ 0 };
+
+        template <typename F>
+        Job* makeJob(F&& function, JobCounter* counter) {
+            using Callable = std::decay_t<F>;
+            static_assert(sizeof(Callable) <= job_payload_size, "job captures are too large, capture a pointer instead");
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "job captures are over-aligned");
+
+            Job* job = allocate();
+            job->counter = counter;
+            job->next = nullptr;
+            job->entry = [](Job& self) {
+                Callable* callable = std::launder(reinterpret_cast<Callable*>(self.payload));
+                (*callable)();
+                callable->~Callable();
+            };
+            new (job->payload) Callable(std::forward<F>(function));
+            return job;
+        }
+
+        Job* allocate();
+        void submit(Job* job);
+        void lockCounter(JobCounter& counter);
+        void chain(JobCounter& dependency, Job* job);
+        void finish(Job* job);
+        void execute(Job* job);
+        Job* findJob(unsigned self);
+        void wakeOne();
+        void workerLoop(unsigned index);
+        int currentWorker() const;
+    };
+}
+
+#endif
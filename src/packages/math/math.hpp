@@ -1,7 +1,8 @@
 #ifndef YUME_MATH
 #define YUME_MATH
 
-#include "../../config.hpp"
+#include <cmath>
+#include <iostream>
 
 namespace yume {
 
@@ -0,0 +1,305 @@
+#include "rollback_session.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace yume {
+
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+
+        // magic, player, input count, first input tick, ack, sender tick, sender advantage, sender confirmed ticks,
+        // the checksum after the last of them, then one byte per input
+        constexpr std::uint8_t packet_magic[2] = { 'Y', 'R' };
+        constexpr int header_size = 29;
+        constexpr int max_inputs_per_packet = 64;
+        constexpr std::uint32_t no_rollback = 0xFFFFFFFFu;
+        constexpr int sync_wait_interval = 8;  // at most one tick in this many is skipped to let the peer catch up
+
+        void writeU32(std::uint8_t* out, std::uint32_t value) {
+            out[0] = static_cast<std::uint8_t>(value);
+            out[1] = static_cast<std::uint8_t>(value >> 8);
+            out[2] = static_cast<std::uint8_t>(value >> 16);
+            out[3] = static_cast<std::uint8_t>(value >> 24);
+        }
+
+        std::uint32_t readU32(const std::uint8_t* in) {
+            return static_cast<std::uint32_t>(in[0]) | static_cast<std::uint32_t>(in[1]) << 8
+                | static_cast<std::uint32_t>(in[2]) << 16 | static_cast<std::uint32_t>(in[3]) << 24;
+        }
+
+        void writeU64(std::uint8_t* out, std::uint64_t value) {
+            writeU32(out, static_cast<std::uint32_t>(value));
+            writeU32(out + 4, static_cast<std::uint32_t>(value >> 32));
+        }
+
+        std::uint64_t readU64(const std::uint8_t* in) {
+            return static_cast<std::uint64_t>(readU32(in)) | static_cast<std::uint64_t>(readU32(in + 4)) << 32;
+        }
+    }
+
+    RollbackSession::RollbackSession(UdpSocket& socket_v, int local_player, const VersusState& start, const VersusShapes* shapes_v,
+        RollbackSettings settings_v)
+        : socket(&socket_v), local(local_player), shapes(shapes_v), settings(settings_v), current(start), states{}, localInputs{},
+        remoteInputs{}, usedRemote{}, checksums{} {
+        settings.maxRollback = std::clamp(settings.maxRollback, 1, RollbackStats::depth_buckets - 1);
+        settings.inputDelay = std::clamp(settings.inputDelay, 0, 16);
+
+        // both sides press nothing during the delay at the start
+        std::uint32_t first = current.tick;
+        for (std::uint32_t tick = first; tick < first + static_cast<std::uint32_t>(settings.inputDelay); tick++) {
+            localInputs[slot(tick)] = InputSlot{ tick, 0, true };
+            remoteInputs[slot(tick)] = InputSlot{ tick, 0, true };
+        }
+        localNext = first + settings.inputDelay;
+        remoteNext = first + settings.inputDelay;
+        peerAck = localNext;
+        checksummed = first;
+        peerConfirmed = first;
+        compared = first;
+        rollbackFrom = no_rollback;
+    }
+
+    bool RollbackSession::advance(VersusInput input, double nowMs) {
+        poll(nowMs);
+
+        // past maxRollback a misprediction could no longer be repaired, and the peer has to have seen old inputs
+        // before the history wraps over them
+        bool tooFarAhead = current.tick >= remoteNext + static_cast<std::uint32_t>(settings.maxRollback)
+            || localNext - peerAck >= history_size / 2;
+        bool letPeerCatchUp = !tooFarAhead && tickAdvantage() > 1.0f && ticksSinceWait >= sync_wait_interval;
+        if (tooFarAhead || letPeerCatchUp) {
+            if (tooFarAhead) {
+                statistics.stalls += 1;
+            }
+            else {
+                statistics.syncWaits += 1;
+                ticksSinceWait = 0;
+            }
+            sendInputs(nowMs);
+            return false;
+        }
+
+        localInputs[slot(localNext)] = InputSlot{ localNext, input, true };
+        localNext += 1;
+
+        simulate();
+        statistics.ticks += 1;
+        ticksSinceWait += 1;
+        recordChecksums();
+
+        sendInputs(nowMs);
+        return true;
+    }
+
+    void RollbackSession::poll(double nowMs) {
+        socket->flush(nowMs);
+        receive();
+        rollBack();
+        recordChecksums();
+        compareChecksums();
+    }
+
+    const VersusState& RollbackSession::state() const {
+        return current;
+    }
+
+    const RollbackStats& RollbackSession::stats() const {
+        return statistics;
+    }
+
+    int RollbackSession::localPlayer() const {
+        return local;
+    }
+
+    int RollbackSession::remotePlayer() const {
+        return 1 - local;
+    }
+
+    std::uint32_t RollbackSession::currentTick() const {
+        return current.tick;
+    }
+
+    std::uint32_t RollbackSession::confirmedTicks() const {
+        return checksummed;
+    }
+
+    float RollbackSession::tickAdvantage() const {
+        if (statistics.packetsReceived == 0) {
+            return 0.0f;
+        }
+        // both views include the one way latency, it cancels out in the difference
+        int localAdvantage = static_cast<int>(current.tick - remoteTick);
+        return (localAdvantage - remoteAdvantage) / 2.0f;
+    }
+
+    bool RollbackSession::confirmedChecksum(std::uint32_t tick, std::uint64_t& checksum) const {
+        const ChecksumSlot& entry = checksums[slot(tick)];
+        if (!entry.known || entry.tick != tick || tick >= checksummed) {
+            return false;
+        }
+        checksum = entry.value;
+        return true;
+    }
+
+    VersusInput RollbackSession::remoteInput(std::uint32_t tick) const {
+        // a tick past what arrived is predicted to repeat the last input that did
+        std::uint32_t known = tick < remoteNext ? tick : remoteNext - 1;
+        const InputSlot& entry = remoteInputs[slot(known)];
+        return entry.known && entry.tick == known ? entry.input : 0;
+    }
+
+    void RollbackSession::simulate() {
+        std::uint32_t tick = current.tick;
+        states[slot(tick)] = current;
+
+        VersusInput inputs[versus_max_pilots] = {};
+        const InputSlot& own = localInputs[slot(tick)];
+        inputs[local] = own.known && own.tick == tick ? own.input : 0;
+        inputs[remotePlayer()] = remoteInput(tick);
+        usedRemote[slot(tick)] = inputs[remotePlayer()];
+
+        stepVersus(current, inputs, settings.tickTime, shapes);
+    }
+
+    void RollbackSession::receive() {
+        std::array<std::uint8_t, UdpSocket::max_packet_size> packet;
+        for (;;) {
+            int size = socket->receive(packet.data(), static_cast<int>(packet.size()));
+            if (size < 0) {
+                return;
+            }
+            if (size < header_size || packet[0] != packet_magic[0] || packet[1] != packet_magic[1] || packet[2] != remotePlayer()
+                || size != header_size + packet[3]) {
+                continue;
+            }
+            statistics.packetsReceived += 1;
+
+            int count = packet[3];
+            std::uint32_t firstTick = readU32(packet.data() + 4);
+            std::uint32_t ack = readU32(packet.data() + 8);
+            std::uint32_t senderTick = readU32(packet.data() + 12);
+
+            // packets can arrive out of order, only newer information counts
+            peerAck = std::max(peerAck, std::min(ack, localNext));
+            if (senderTick >= remoteTick) {
+                remoteTick = senderTick;
+                remoteAdvantage = static_cast<std::int8_t>(packet[16]);
+            }
+
+            // one checksum waits for this side to confirm its tick at a time, newer ones are sent again anyway
+            std::uint32_t senderConfirmed = readU32(packet.data() + 17);
+            if (peerConfirmed <= compared && senderConfirmed > peerConfirmed) {
+                peerConfirmed = senderConfirmed;
+                peerChecksum = readU64(packet.data() + 21);
+            }
+
+            for (int i = 0; i < count; i++) {
+                std::uint32_t tick = firstTick + static_cast<std::uint32_t>(i);
+                if (tick < remoteNext || tick >= remoteNext + history_size / 2) {
+                    continue;
+                }
+                remoteInputs[slot(tick)] = InputSlot{ tick, packet[header_size + i], true };
+            }
+
+            // everything that is now contiguous is confirmed, a tick already stepped with a different guess rolls back
+            while (remoteInputs[slot(remoteNext)].known && remoteInputs[slot(remoteNext)].tick == remoteNext) {
+                if (remoteNext < current.tick && usedRemote[slot(remoteNext)] != remoteInputs[slot(remoteNext)].input) {
+                    rollbackFrom = std::min(rollbackFrom, remoteNext);
+                }
+                remoteNext += 1;
+            }
+        }
+    }
+
+    void RollbackSession::sendInputs(double nowMs) {
+        std::array<std::uint8_t, header_size + max_inputs_per_packet> packet;
+        std::uint32_t first = peerAck;
+        int count = static_cast<int>(std::min<std::uint32_t>(localNext - first, max_inputs_per_packet));
+
+        packet[0] = packet_magic[0];
+        packet[1] = packet_magic[1];
+        packet[2] = static_cast<std::uint8_t>(local);
+        packet[3] = static_cast<std::uint8_t>(count);
+        writeU32(packet.data() + 4, first);
+        writeU32(packet.data() + 8, remoteNext);
+        writeU32(packet.data() + 12, current.tick);
+        int advantage = statistics.packetsReceived == 0 ? 0 : std::clamp(static_cast<int>(current.tick - remoteTick), -127, 127);
+        packet[16] = static_cast<std::uint8_t>(static_cast<std::int8_t>(advantage));
+        std::uint64_t checksum = 0;
+        confirmedChecksum(checksummed - 1, checksum);
+        writeU32(packet.data() + 17, checksummed);
+        writeU64(packet.data() + 21, checksum);
+        for (int i = 0; i < count; i++) {
+            packet[header_size + i] = localInputs[slot(first + static_cast<std::uint32_t>(i))].input;
+        }
+
+        socket->send(packet.data(), header_size + count, nowMs);
+        statistics.packetsSent += 1;
+        statistics.bytesSent += static_cast<std::uint64_t>(header_size + count);
+    }
+
+    void RollbackSession::rollBack() {
+        if (rollbackFrom == no_rollback) {
+            return;
+        }
+        std::uint32_t from = rollbackFrom;
+        rollbackFrom = no_rollback;
+        if (from >= current.tick) {
+            return;
+        }
+
+        clock_type::time_point start = clock_type::now();
+        std::uint32_t target = current.tick;
+        current = states[slot(from)];
+        while (current.tick < target) {
+            simulate();
+        }
+        float elapsed = std::chrono::duration<float, std::milli>(clock_type::now() - start).count();
+
+        int depth = static_cast<int>(target - from);
+        statistics.rollbacks += 1;
+        statistics.resimulatedTicks += static_cast<std::uint64_t>(depth);
+        statistics.maxDepth = std::max(statistics.maxDepth, depth);
+        statistics.depthHistogram[std::min(depth, RollbackStats::depth_buckets - 1)] += 1;
+        statistics.lastResimMs = elapsed;
+        statistics.maxResimMs = std::max(statistics.maxResimMs, elapsed);
+        statistics.totalResimMs += elapsed;
+        if (elapsed > settings.frameBudgetMs) {
+            statistics.overBudget += 1;
+        }
+    }
+
+    void RollbackSession::recordChecksums() {
+        // once every input up to a tick is known the state after it cannot change any more
+        std::uint32_t limit = std::min(remoteNext, current.tick);
+        for (std::uint32_t tick = checksummed; tick < limit; tick++) {
+            const VersusState& after = tick + 1 == current.tick ? current : states[slot(tick + 1)];
+            checksums[slot(tick)] = ChecksumSlot{ tick, versusChecksum(after), true };
+        }
+        checksummed = std::max(checksummed, limit);
+    }
+
+    void RollbackSession::compareChecksums() {
+        if (peerConfirmed <= compared) {
+            return;
+        }
+
+        std::uint32_t tick = peerConfirmed - 1;
+        std::uint64_t own = 0;
+        if (tick >= checksummed) {
+            // the peer confirmed it first, this side still waits for some of its inputs
+            return;
+        }
+        if (confirmedChecksum(tick, own)) {
+            statistics.checksumsCompared += 1;
+            if (own != peerChecksum) {
+                if (statistics.desyncs == 0) {
+                    statistics.firstDesyncTick = tick;
+                }
+                statistics.desyncs += 1;
+            }
+        }
+        compared = peerConfirmed;
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef YUME_ROLLBACK_SESSION
+#define YUME_ROLLBACK_SESSION
+
+#include "udp_socket.hpp"
+#include "../simulation/versus.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace yume {
+
+    struct RollbackSettings {
+        int maxRollback{ 8 };  // ticks the simulation may run past the last confirmed remote input
+        int inputDelay{ 2 };   // ticks local input is held back, hides that much latency without rolling back
+        float tickTime{ 1.0f / 60.0f };
+        float frameBudgetMs{ 2.0f };  // re-simulation slower than this in one advance() counts as over budget
+    };
+
+    struct RollbackStats {
+        static constexpr int depth_buckets = 33;
+
+        std::uint64_t ticks{ 0 };
+        std::uint64_t rollbacks{ 0 };
+        std::uint64_t resimulatedTicks{ 0 };
+        std::uint64_t stalls{ 0 };     // advance() calls that could not step, too far ahead of the remote side
+        std::uint64_t syncWaits{ 0 };  // ticks skipped to let a remote side that runs behind catch up
+        std::uint64_t overBudget{ 0 };
+        std::uint64_t packetsSent{ 0 };
+        std::uint64_t packetsReceived{ 0 };
+        std::uint64_t bytesSent{ 0 };
+        std::uint64_t checksumsCompared{ 0 };  // confirmed ticks whose checksum the peer sent and this side checked
+        std::uint64_t desyncs{ 0 };            // of those, the ones where the two machines disagree
+        std::uint32_t firstDesyncTick{ 0 };    // only meaningful once desyncs is not 0
+        int maxDepth{ 0 };
+        float lastResimMs{ 0.0f };
+        float maxResimMs{ 0.0f };
+        double totalResimMs{ 0.0 };
+        std::array<std::uint64_t, depth_buckets> depthHistogram{};  // rollbacks by how many ticks they re-simulated
+    };
+
+    // Peer to peer rollback for two pilots. Every tick the local input goes out in a small packet together with every
+    // input the peer has not acknowledged yet, so a lost packet is covered by the next one. The remote pilot is
+    // predicted to keep pressing what they pressed last, and when their real input for a tick that was already
+    // simulated turns out different, the state saved before that tick is restored and the ticks since are simulated
+    // again in the same advance() call. The simulation never runs more than maxRollback ticks past what is confirmed,
+    // so a rollback costs at most that many steps.
+    // Every packet also carries the checksum of the newest confirmed state, the receiver checks it against its own
+    // once it has confirmed that tick too and counts a mismatch as a desync.
+    // Both sides have to start from the same state with the same settings.
+    class RollbackSession {
+    public:
+        static constexpr int history_size = 128;  // ticks of states and inputs kept, a power of two
+
+        RollbackSession(UdpSocket& socket_v, int local_player, const VersusState& start, const VersusShapes* shapes_v = nullptr,
+            RollbackSettings settings_v = {});
+
+        // polls the socket, corrects mispredictions and steps one tick with local as this side's input,
+        // false when it had to wait for the remote side and nothing was stepped
+        bool advance(VersusInput local, double nowMs);
+        // only receives and repairs mispredictions, for the frames where the caller does not step
+        void poll(double nowMs);
+
+        const VersusState& state() const;
+        const RollbackStats& stats() const;
+        int localPlayer() const;
+        int remotePlayer() const;
+        // the tick the next advance() steps
+        std::uint32_t currentTick() const;
+        // every input up to here is known on this side, the states after these ticks are final
+        std::uint32_t confirmedTicks() const;
+        // ticks this side is ahead of the remote one, averaged over both sides' view of it, 0 until the peer is heard
+        float tickAdvantage() const;
+        // the checksum of the state after tick once it is confirmed, false before that or once it left the history
+        bool confirmedChecksum(std::uint32_t tick, std::uint64_t& checksum) const;
+
+    private:
+        struct InputSlot {
+            std::uint32_t tick;
+            VersusInput input;
+            bool known;
+        };
+
+        struct ChecksumSlot {
+            std::uint32_t tick;
+            std::uint64_t value;
+            bool known;
+        };
+
+        UdpSocket* socket;
+        int local;
+        const VersusShapes* shapes;
+        RollbackSettings settings;
+        RollbackStats statistics;
+
+        VersusState current;
+        std::array<VersusState, history_size> states;  // the state before each tick
+        std::array<InputSlot, history_size> localInputs;
+        std::array<InputSlot, history_size> remoteInputs;
+        std::array<VersusInput, history_size> usedRemote;  // predicted or confirmed, what each tick was stepped with
+        std::array<ChecksumSlot, history_size> checksums;
+
+        std::uint32_t localNext;   // the first local tick without input yet, currentTick() + inputDelay
+        std::uint32_t remoteNext;  // the first remote tick not received yet, everything before it is confirmed
+        std::uint32_t peerAck;     // the first local tick the peer has not received yet
+        std::uint32_t checksummed; // ticks before this have a confirmed checksum
+        std::uint32_t rollbackFrom;
+        std::uint32_t remoteTick{ 0 };  // the tick the peer was at when it sent its newest packet
+        std::uint32_t peerConfirmed;    // the peer's confirmedTicks() with the checksum below, for the tick before it
+        std::uint64_t peerChecksum{ 0 };
+        std::uint32_t compared;         // checksums of ticks before this were checked or have left the history
+        int remoteAdvantage{ 0 };
+        int ticksSinceWait{ 0 };
+
+        static int slot(std::uint32_t tick) { return static_cast<int>(tick & (history_size - 1)); }
+
+        VersusInput remoteInput(std::uint32_t tick) const;
+        void simulate();
+        void receive();
+        void sendInputs(double nowMs);
+        void rollBack();
+        void recordChecksums();
+        void compareChecksums();
+    };
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include "udp_socket.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace yume {
+
+    namespace {
+        constexpr std::intptr_t no_socket = -1;
+        constexpr std::size_t delayed_capacity = 1024;
+
+#if defined(_WIN32)
+        using NativeSocket = SOCKET;
+#else
+        using NativeSocket = int;
+#endif
+
+        NativeSocket native(std::intptr_t handle) {
+            return static_cast<NativeSocket>(handle);
+        }
+
+#if defined(_WIN32)
+        // Winsock is counted, every socket starts it and the last one closed stops it
+        bool startNetworking() {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }
+
+        void stopNetworking() {
+            WSACleanup();
+        }
+
+        void closeSocket(std::intptr_t handle) {
+            closesocket(native(handle));
+        }
+
+        bool makeNonBlocking(std::intptr_t handle) {
+            u_long enabled = 1;
+            return ioctlsocket(native(handle), FIONBIO, &enabled) == 0;
+        }
+#else
+        bool startNetworking() {
+            return true;
+        }
+
+        void stopNetworking() {
+        }
+
+        void closeSocket(std::intptr_t handle) {
+            close(native(handle));
+        }
+
+        bool makeNonBlocking(std::intptr_t handle) {
+            int flags = fcntl(native(handle), F_GETFL, 0);
+            return flags >= 0 && fcntl(native(handle), F_SETFL, flags | O_NONBLOCK) == 0;
+        }
+#endif
+    }
+
+    UdpSocket::UdpSocket()
+        : handle(no_socket), random(1) {
+    }
+
+    bool UdpSocket::open(std::uint16_t port) {
+        if (handle != no_socket || !startNetworking()) {
+            return false;
+        }
+
+        std::intptr_t created = static_cast<std::intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (created < 0) {
+            std::printf("Could not create a UDP socket\n");
+            stopNetworking();
+            return false;
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(native(created), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || !makeNonBlocking(created)) {
+            std::printf("Could not bind UDP port %u\n", static_cast<unsigned>(port));
+            closeSocket(created);
+            stopNetworking();
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        getsockname(native(created), reinterpret_cast<sockaddr*>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+        handle = created;
+        delayed.reserve(delayed_capacity);
+        return true;
+    }
+
+    bool UdpSocket::setPeer(const char* host, std::uint16_t port) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+            std::printf("Could not resolve %s\n", host);
+            return false;
+        }
+
+        peerAddress = reinterpret_cast<const sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+        peerPort = htons(port);
+        freeaddrinfo(result);
+        return true;
+    }
+
+    void UdpSocket::setConditions(const NetConditions& conditions_v) {
+        conditions = conditions_v;
+        impaired = conditions.latencyMs > 0.0f || conditions.jitterMs > 0.0f || conditions.loss > 0.0f;
+        random.seed(conditions.seed);
+    }
+
+    bool UdpSocket::isOpen() const {
+        return handle != no_socket;
+    }
+
+    std::uint16_t UdpSocket::localPort() const {
+        return boundPort;
+    }
+
+    void UdpSocket::send(const std::uint8_t* data, int size, double nowMs) {
+        if (handle == no_socket || size <= 0 || size > max_packet_size) {
+            return;
+        }
+        if (!impaired) {
+            transmit(data, size);
+            return;
+        }
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        if (unit(random) < conditions.loss) {
+            return;
+        }
+        // a full queue drops like a full router buffer would
+        if (delayed.size() >= delayed_capacity) {
+            return;
+        }
+
+        float jitter = conditions.jitterMs * (unit(random) * 2.0f - 1.0f);
+        Delayed packet;
+        packet.dueMs = nowMs + std::max(0.0f, conditions.latencyMs + jitter);
+        packet.size = size;
+        std::memcpy(packet.bytes.data(), data, static_cast<std::size_t>(size));
+        delayed.push_back(packet);
+    }
+
+    void UdpSocket::flush(double nowMs) {
+        // few packets are in flight, a linear pass in due order is cheaper than keeping a heap
+        while (!delayed.empty()) {
+            std::size_t next = 0;
+            for (std::size_t i = 1; i < delayed.size(); i++) {
+                if (delayed[i].dueMs < delayed[next].dueMs) {
+                    next = i;
+                }
+            }
+            if (delayed[next].dueMs > nowMs) {
+                return;
+            }
+
+            transmit(delayed[next].bytes.data(), delayed[next].size);
+            delayed[next] = delayed.back();
+            delayed.pop_back();
+        }
+    }
+
+    int UdpSocket::receive(std::uint8_t* buffer, int capacity) {
+        if (handle == no_socket) {
+            return -1;
+        }
+
+        // anything not from the peer is skipped, a stray packet on the port must not become remote input
+        for (;;) {
+            sockaddr_in from{};
+            socklen_t length = sizeof(from);
+            auto received = recvfrom(native(handle), reinterpret_cast<char*>(buffer), capacity, 0, reinterpret_cast<sockaddr*>(&from), &length);
+            if (received < 0) {
+                return -1;
+            }
+            if (from.sin_addr.s_addr == peerAddress && from.sin_port == peerPort) {
+                return static_cast<int>(received);
+            }
+        }
+    }
+
+    void UdpSocket::transmit(const std::uint8_t* data, int size) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = peerAddress;
+        address.sin_port = peerPort;
+        sendto(native(handle), reinterpret_cast<const char*>(data), size, 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+
+    UdpSocket::~UdpSocket() {
+        if (handle != no_socket) {
+            closeSocket(handle);
+            stopNetworking();
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef YUME_UDP_SOCKET
+#define YUME_UDP_SOCKET
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace yume {
+
+    // What the outgoing side of a socket does to packets before they reach the wire. Each packet is held for
+    // latency plus a uniform -jitter..+jitter, so jitter also reorders them, and dropped with probability loss.
+    struct NetConditions {
+        float latencyMs{ 0.0f };
+        float jitterMs{ 0.0f };
+        float loss{ 0.0f };
+        std::uint32_t seed{ 1 };
+    };
+
+    // A non-blocking IPv4 UDP socket talking to one peer. Without conditions a send goes straight out,
+    // with them it waits in a queue until flush() is called at or after its due time.
+    class UdpSocket {
+    public:
+        static constexpr int max_packet_size = 512;
+
+        UdpSocket();
+        UdpSocket(const UdpSocket&) = delete;
+        UdpSocket& operator=(const UdpSocket&) = delete;
+
+        // binds every interface, port 0 lets the system pick one
+        bool open(std::uint16_t port);
+        // host is a dotted IPv4 address or a name the resolver knows
+        bool setPeer(const char* host, std::uint16_t port);
+        void setConditions(const NetConditions& conditions);
+
+        bool isOpen() const;
+        std::uint16_t localPort() const;
+
+        void send(const std::uint8_t* data, int size, double nowMs);
+        // puts the delayed packets that are due by nowMs on the wire
+        void flush(double nowMs);
+        // the size of the next waiting packet from the peer, -1 when there is none
+        int receive(std::uint8_t* buffer, int capacity);
+
+        ~UdpSocket();
+
+    private:
+        struct Delayed {
+            double dueMs;
+            int size;
+            std::array<std::uint8_t, max_packet_size> bytes;
+        };
+
+        std::intptr_t handle;
+        std::uint32_t peerAddress{ 0 };  // network byte order
+        std::uint16_t peerPort{ 0 };     // network byte order
+        std::uint16_t boundPort{ 0 };
+
+        NetConditions conditions;
+        bool impaired{ false };
+        std::mt19937 random;
+        std::vector<Delayed> delayed;  // reserved once, a steady session does not allocate
+
+        void transmit(const std::uint8_t* data, int size);
+    };
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "asset_cache.hpp"
+#include "../../config.hpp"
+#include "../core/startup_trace.hpp"
+
+#include <deque>
+#include <fstream>
+#include <iterator>
+
+namespace yume {
+
+    namespace {
+        // each entry has its own counter, a scene waits for the assets it asks for and not for the rest
+        struct ImageEntry {
+            std::string fileName;
+            SDL_Surface* surface{ nullptr };
+            JobCounter decoded;
+        };
+
+        struct FontFile {
+            std::string fileName;
+            std::vector<char> data; // TTF_OpenFontRW reads the glyphs from here for as long as the fonts are open
+        };
+
+        struct FontEntry {
+            std::string fileName;
+            int size{ 0 };
+            TTF_Font* font{ nullptr };
+            JobCounter opened;
+        };
+
+        // the slots are laid out before the jobs start, each job only writes its own. Deques since a counter
+        // cannot move and a font loaded later is added behind the preloaded ones
+        JobSystem* imageJobs{ nullptr };
+        std::deque<ImageEntry> images;
+
+        JobSystem* fontJobs{ nullptr };
+        std::vector<FontFile> fontFiles;
+        std::deque<FontEntry> fonts;
+
+        void waitFor(JobSystem* jobs, JobCounter& counter) {
+            if (jobs != nullptr && !counter.done()) {
+                jobs->wait(counter);
+            }
+        }
+
+        void waitForFonts() {
+            for (FontEntry& entry : fonts) {
+                waitFor(fontJobs, entry.opened);
+            }
+        }
+
+        // the file is read once, every size opens from the same bytes
+        const FontFile* fontFile(const char* fileName) {
+            for (const FontFile& file : fontFiles) {
+                if (file.fileName == fileName) {
+                    return &file;
+                }
+            }
+
+            std::ifstream stream(fileName, std::ios::binary);
+            if (!stream) {
+                std::cout << "Could not open the font " << fileName << '\n';
+                return nullptr;
+            }
+            fontFiles.push_back(FontFile{ fileName, std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()) });
+            return &fontFiles.back();
+        }
+
+        TTF_Font* openFont(const char* fileName, int size) {
+            const FontFile* file = fontFile(fileName);
+            if (file == nullptr) {
+                return nullptr;
+            }
+
+            TTF_Font* font = TTF_OpenFontRW(SDL_RWFromConstMem(file->data.data(), static_cast<int>(file->data.size())), 1, size);
+            if (font == nullptr) {
+                std::cout << "TTF_OpenFont Error: " << TTF_GetError() << '\n';
+            }
+            return font;
+        }
+    }
+
+    void AssetCache::preloadImages(JobSystem& jobs, const std::vector<std::string>& fileNames) {
+        if (imageJobs != nullptr) {
+            return;
+        }
+
+        imageJobs = &jobs;
+        for (const std::string& fileName : fileNames) {
+            images.emplace_back();
+            images.back().fileName = fileName;
+        }
+
+        for (ImageEntry& slot : images) {
+            ImageEntry* entry = &slot;
+            jobs.run([entry]() {
+                StartupPhase phase(entry->fileName.c_str());
+                entry->surface = IMG_Load(entry->fileName.c_str());
+                if (entry->surface == nullptr) {
+                    std::cout << "IMG_Load Error: " << IMG_GetError() << '\n';
+                }
+            }, &entry->decoded);
+        }
+    }
+
+    void AssetCache::preloadFonts(JobSystem& jobs, const char* fileName, const std::vector<int>& sizes) {
+        if (fontJobs != nullptr) {
+            return;
+        }
+
+        fontJobs = &jobs;
+        for (int size : sizes) {
+            fonts.emplace_back();
+            fonts.back().fileName = fileName;
+            fonts.back().size = size;
+        }
+
+        // one job per size, each queued after the one before since FreeType is shared
+        FontEntry* previous = nullptr;
+        for (FontEntry& slot : fonts) {
+            FontEntry* entry = &slot;
+            auto open = [entry]() {
+                StartupPhase phase("open font");
+                entry->font = openFont(entry->fileName.c_str(), entry->size);
+            };
+            if (previous == nullptr) {
+                jobs.run(open, &entry->opened);
+            }
+            else {
+                jobs.runAfter(previous->opened, open, &entry->opened);
+            }
+            previous = entry;
+        }
+    }
+
+    SDL_Surface* AssetCache::image(const char* fileName) {
+        for (ImageEntry& entry : images) {
+            if (entry.fileName == fileName) {
+                waitFor(imageJobs, entry.decoded);
+                return entry.surface;
+            }
+        }
+        return nullptr;
+    }
+
+    TTF_Font* AssetCache::font(const char* fileName, int size) {
+        for (FontEntry& entry : fonts) {
+            if (entry.size == size && entry.fileName == fileName) {
+                waitFor(fontJobs, entry.opened);
+                return entry.font;
+            }
+        }
+
+        // opened here, after the preloads since they share the font files and FreeType
+        waitForFonts();
+        fonts.emplace_back();
+        FontEntry& entry = fonts.back();
+        entry.fileName = fileName;
+        entry.size = size;
+        entry.font = openFont(fileName, size);
+        return entry.font;
+    }
+
+    void AssetCache::wait() {
+        for (ImageEntry& entry : images) {
+            waitFor(imageJobs, entry.decoded);
+        }
+        waitForFonts();
+    }
+
+    void AssetCache::releaseImages() {
+        // the names stay, the startup trace points at them
+        for (ImageEntry& entry : images) {
+            waitFor(imageJobs, entry.decoded);
+            if (entry.surface != nullptr) {
+                SDL_FreeSurface(entry.surface);
+                entry.surface = nullptr;
+            }
+        }
+    }
+
+    void AssetCache::clear() {
+        releaseImages();
+
+        waitForFonts();
+        for (FontEntry& entry : fonts) {
+            if (entry.font != nullptr) {
+                TTF_CloseFont(entry.font);
+            }
+        }
+        fonts.clear();
+        fontFiles.clear();
+    }
+}
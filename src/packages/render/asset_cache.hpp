@@ -0,0 +1,39 @@
+#ifndef YUME_ASSET_CACHE
+#define YUME_ASSET_CACHE
+
+// Not config.hpp, which reaches this header through render.hpp before it gets to SDL_ttf's types
+#include <SDL2/SDL.h>
+#include "../jobs/job_system.hpp"
+
+#include <string>
+#include <vector>
+
+typedef struct _TTF_Font TTF_Font;
+
+namespace yume {
+
+    // Decoded images and opened fonts for everything the scenes build at startup. preloadImages() and preloadFonts()
+    // are called once and fan the decoding out on the jobs while the main thread opens the window, image() and font()
+    // wait for the one asset asked for.
+    // Images decode in parallel, the fonts open one after another in jobs chained on each other since SDL_ttf shares
+    // one FreeType library. Anything that was not preloaded is loaded on first use, on the calling thread.
+    class AssetCache {
+    public:
+        static void preloadImages(JobSystem& jobs, const std::vector<std::string>& file_names);
+        static void preloadFonts(JobSystem& jobs, const char* file_name, const std::vector<int>& sizes);
+
+        // the decoded surface if it was preloaded, null otherwise. Owned by the cache until releaseImages()
+        static SDL_Surface* image(const char* file_name);
+        // shared by every Text of that size, owned by the cache until clear()
+        static TTF_Font* font(const char* file_name, int size);
+        // until every preloaded asset is ready
+        static void wait();
+
+        // frees the decoded images once the textures have been created from them
+        static void releaseImages();
+        // closes the fonts as well, before TTF_Quit()
+        static void clear();
+    };
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include "compositor.hpp"
+
+namespace yume {
+
+    Compositor::Compositor(int width_v, int height_v, SDL_Renderer* renderer)
+        : width(width_v), height(height_v), targetsSupported(SDL_RenderTargetSupported(renderer) == SDL_TRUE) {
+        if (!targetsSupported) {
+            std::cout << "Render targets are not supported, the compositor will draw every layer each frame\n";
+        }
+    }
+
+    int Compositor::addLayer(LayerKind kind, std::function<void(SDL_Renderer*)> draw, SDL_Rect bounds, bool opaque) {
+        layers.push_back(Layer{ kind, std::move(draw), clampBounds(bounds), opaque, vec2<float>::ZERO(), -1 });
+        layoutDirty = true;
+        return static_cast<int>(layers.size()) - 1;
+    }
+
+    void Compositor::setKind(int layer, LayerKind kind) {
+        if (layers[layer].kind != kind) {
+            layers[layer].kind = kind;
+            layoutDirty = true;
+        }
+    }
+
+    void Compositor::setBounds(int layer, SDL_Rect bounds) {
+        SDL_Rect clamped = clampBounds(bounds);
+        const SDL_Rect& current = layers[layer].bounds;
+
+        if (clamped.x != current.x || clamped.y != current.y || clamped.w != current.w || clamped.h != current.h) {
+            layers[layer].bounds = clamped;
+            layoutDirty = true;
+        }
+    }
+
+    void Compositor::setScroll(int layer, vec2<float> offset) {
+        layers[layer].scroll = offset;
+    }
+
+    void Compositor::invalidate(int layer) {
+        int cache = layers[layer].cache;
+        if (cache >= 0 && !layoutDirty) {
+            caches[cache].dirty = true;
+        }
+    }
+
+    void Compositor::invalidateAll() {
+        for (Cache& cache : caches) {
+            cache.dirty = true;
+        }
+    }
+
+    void Compositor::render(SDL_Renderer* renderer) {
+        if (layoutDirty) {
+            rebuildLayout(renderer);
+        }
+
+        // an opaque full screen base layer overwrites every pixel, so the clear is wasted fill
+        bool covered = !caches.empty() && caches[0].first == 0 && caches[0].opaque
+            && caches[0].bounds.w == width && caches[0].bounds.h == height;
+        if (!covered) {
+            SDL_RenderClear(renderer);
+        }
+
+        for (int i = 0; i < static_cast<int>(layers.size()); i++) {
+            const Layer& layer = layers[i];
+
+            if (layer.cache < 0) {
+                layer.draw(renderer);
+                continue;
+            }
+
+            Cache& cache = caches[layer.cache];
+            if (cache.first != i) {
+                continue;
+            }
+
+            if (cache.dirty) {
+                redrawCache(cache, renderer);
+            }
+
+            if (layer.kind == LayerKind::Scrolling) {
+                renderScrolling(layer, cache, renderer);
+            }
+            else {
+                SDL_RenderCopy(renderer, cache.texture, &cache.bounds, &cache.bounds);
+            }
+        }
+    }
+
+    SDL_Rect Compositor::clampBounds(SDL_Rect bounds) const {
+        if (bounds.w <= 0 || bounds.h <= 0) {
+            return SDL_Rect{ 0, 0, width, height };
+        }
+
+        int left = std::max(bounds.x, 0);
+        int top = std::max(bounds.y, 0);
+        int right = std::min(bounds.x + bounds.w, width);
+        int bottom = std::min(bounds.y + bounds.h, height);
+
+        return SDL_Rect{ left, top, std::max(right - left, 0), std::max(bottom - top, 0) };
+    }
+
+    void Compositor::rebuildLayout(SDL_Renderer* renderer) {
+        releaseCaches();
+
+        for (Layer& layer : layers) {
+            layer.cache = -1;
+        }
+
+        if (targetsSupported) {
+            for (int i = 0; i < static_cast<int>(layers.size()); i++) {
+                Layer& layer = layers[i];
+                if (layer.kind == LayerKind::Dynamic) {
+                    continue;
+                }
+
+                bool extendsRun = layer.kind == LayerKind::Static && i > 0
+                    && layers[i - 1].kind == LayerKind::Static && layers[i - 1].cache >= 0;
+
+                if (extendsRun) {
+                    Cache& run = caches[layers[i - 1].cache];
+                    int left = std::min(run.bounds.x, layer.bounds.x);
+                    int top = std::min(run.bounds.y, layer.bounds.y);
+                    int right = std::max(run.bounds.x + run.bounds.w, layer.bounds.x + layer.bounds.w);
+                    int bottom = std::max(run.bounds.y + run.bounds.h, layer.bounds.y + layer.bounds.h);
+
+                    run.bounds = SDL_Rect{ left, top, right - left, bottom - top };
+                    run.opaque = run.opaque && layers[run.first].bounds.w == run.bounds.w && layers[run.first].bounds.h == run.bounds.h;
+                    run.last = i;
+                }
+                else {
+                    caches.push_back(Cache{ i, i, nullptr, layer.bounds, layer.opaque, true });
+                }
+                layer.cache = static_cast<int>(caches.size()) - 1;
+            }
+        }
+
+        // the caches are screen sized so layers keep drawing in screen coordinates,
+        // only the bounds of a run are ever cleared and copied
+        for (Cache& cache : caches) {
+            cache.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+            if (cache.texture == nullptr) {
+                std::cout << "SDL_CreateTexture Error: " << SDL_GetError() << '\n';
+                targetsSupported = false;
+                releaseCaches();
+                for (Layer& layer : layers) {
+                    layer.cache = -1;
+                }
+                break;
+            }
+            SDL_SetTextureBlendMode(cache.texture, cache.opaque ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+        }
+
+        layoutDirty = false;
+    }
+
+    void Compositor::redrawCache(Cache& cache, SDL_Renderer* renderer) {
+        // switching targets resets the render scale, viewport and clip, the resolution scaler's scale and a split
+        // screen pane's viewport have to survive a cache redraw
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        float scaleX, scaleY;
+        SDL_RenderGetScale(renderer, &scaleX, &scaleY);
+        SDL_Rect viewport, clip;
+        SDL_RenderGetViewport(renderer, &viewport);
+        SDL_RenderGetClipRect(renderer, &clip);
+        bool clipped = SDL_RenderIsClipEnabled(renderer) == SDL_TRUE;
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+        SDL_SetRenderTarget(renderer, cache.texture);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+
+        for (int i = cache.first; i <= cache.last; i++) {
+            layers[i].draw(renderer);
+        }
+
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_RenderSetScale(renderer, scaleX, scaleY);
+        SDL_RenderSetViewport(renderer, &viewport);
+        SDL_RenderSetClipRect(renderer, clipped ? &clip : nullptr);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        cache.dirty = false;
+    }
+
+    void Compositor::renderScrolling(const Layer& layer, const Cache& cache, SDL_Renderer* renderer) {
+        const SDL_Rect& bounds = cache.bounds;
+        if (bounds.w == 0 || bounds.h == 0) {
+            return;
+        }
+
+        int offsetX = static_cast<int>(std::fmod(layer.scroll.x, static_cast<float>(bounds.w)));
+        int offsetY = static_cast<int>(std::fmod(layer.scroll.y, static_cast<float>(bounds.h)));
+        if (offsetX < 0) offsetX += bounds.w;
+        if (offsetY < 0) offsetY += bounds.h;
+
+        SDL_RenderSetClipRect(renderer, &bounds);
+        for (int tileY : { offsetY - bounds.h, offsetY }) {
+            for (int tileX : { offsetX - bounds.w, offsetX }) {
+                SDL_Rect dst = { bounds.x + tileX, bounds.y + tileY, bounds.w, bounds.h };
+                SDL_RenderCopy(renderer, cache.texture, &bounds, &dst);
+            }
+        }
+        SDL_RenderSetClipRect(renderer, nullptr);
+    }
+
+    void Compositor::releaseCaches() {
+        for (Cache& cache : caches) {
+            if (cache.texture != nullptr) {
+                SDL_DestroyTexture(cache.texture);
+            }
+        }
+        caches.clear();
+    }
+
+    Compositor::~Compositor() {
+        releaseCaches();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef YUME_COMPOSITOR
+#define YUME_COMPOSITOR
+
+#include "../../config.hpp"
+
+namespace yume {
+
+    // Static layers are flattened into a cached render target and only redrawn after invalidate(),
+    // scrolling layers are cached once and blitted with a wrapping offset,
+    // dynamic layers are drawn every frame.
+    enum class LayerKind { Static, Scrolling, Dynamic };
+
+    class Compositor {
+    public:
+        Compositor(int width_v, int height_v, SDL_Renderer* renderer);
+
+        // bounds {0, 0, 0, 0} means the whole screen, opaque layers fully cover their bounds
+        int addLayer(LayerKind kind, std::function<void(SDL_Renderer*)> draw, SDL_Rect bounds = { 0, 0, 0, 0 }, bool opaque = false);
+
+        void setKind(int layer, LayerKind kind);
+        void setBounds(int layer, SDL_Rect bounds);
+        void setScroll(int layer, vec2<float> offset);
+        void invalidate(int layer);
+        void invalidateAll();
+
+        void render(SDL_Renderer* renderer);
+
+        ~Compositor();
+
+    private:
+        struct Layer {
+            LayerKind kind;
+            std::function<void(SDL_Renderer*)> draw;
+            SDL_Rect bounds;
+            bool opaque;
+            vec2<float> scroll;
+            int cache;
+        };
+
+        // one cached target per run of consecutive static layers or per scrolling layer
+        struct Cache {
+            int first;
+            int last;
+            SDL_Texture* texture;
+            SDL_Rect bounds;
+            bool opaque;
+            bool dirty;
+        };
+
+        int width;
+        int height;
+        bool targetsSupported;
+        bool layoutDirty{ true };
+        std::vector<Layer> layers;
+        std::vector<Cache> caches;
+
+        SDL_Rect clampBounds(SDL_Rect bounds) const;
+        void rebuildLayout(SDL_Renderer* renderer);
+        void redrawCache(Cache& cache, SDL_Renderer* renderer);
+        void renderScrolling(const Layer& layer, const Cache& cache, SDL_Renderer* renderer);
+        void releaseCaches();
+    };
+}
+
+#endif
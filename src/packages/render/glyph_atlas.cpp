@@ -0,0 +1,125 @@
+#include "glyph_atlas.hpp"
+
+namespace yume {
+
+    namespace {
+        constexpr int atlas_width = 512;
+    }
+
+    GlyphAtlas::GlyphAtlas(TTF_Font* font, SDL_Renderer* renderer) {
+        if (font == nullptr) {
+            return;
+        }
+
+        // every glyph surface is the font's line height tall, they are packed in rows of atlas_width
+        std::array<SDL_Surface*, last_glyph - first_glyph + 1> rendered{};
+        int x = 0;
+        int y = 0;
+        for (int c = first_glyph; c <= last_glyph; c++) {
+            SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), SDL_Color{ 255, 255, 255, 255 });
+            if (surface == nullptr) {
+                continue;
+            }
+            if (x + surface->w > atlas_width) {
+                x = 0;
+                y += line;
+            }
+            line = std::max(line, surface->h);
+            glyphs[c - first_glyph] = SDL_Rect{ x, y, surface->w, surface->h };
+            rendered[c - first_glyph] = surface;
+            x += surface->w;
+        }
+        width = atlas_width;
+        height = y + line;
+
+        SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (sheet != nullptr) {
+            for (int i = 0; i < static_cast<int>(rendered.size()); i++) {
+                if (rendered[i] != nullptr) {
+                    // copied as is, blending onto the transparent sheet would darken the antialiased edges
+                    SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+                    SDL_Rect destination = glyphs[i];
+                    SDL_BlitSurface(rendered[i], nullptr, sheet, &destination);
+                }
+            }
+            atlas = SDL_CreateTextureFromSurface(renderer, sheet);
+            SDL_FreeSurface(sheet);
+        }
+        if (atlas == nullptr) {
+            std::cout << "Could not build the glyph atlas: " << SDL_GetError() << '\n';
+        }
+        else {
+            SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+        }
+
+        for (SDL_Surface* surface : rendered) {
+            if (surface != nullptr) {
+                SDL_FreeSurface(surface);
+            }
+        }
+    }
+
+    void GlyphAtlas::appendText(std::vector<SDL_Vertex>& vertices, std::vector<int>& indices, std::string_view text, vec2<int> position, SDL_Color color) const {
+        if (atlas == nullptr) {
+            return;
+        }
+
+        float inverseWidth = 1.0f / width;
+        float inverseHeight = 1.0f / height;
+        float penX = static_cast<float>(position.x);
+        float top = static_cast<float>(position.y);
+
+        for (char c : text) {
+            const SDL_Rect& source = glyph(c);
+            if (c != ' ') {
+                int first = static_cast<int>(vertices.size());
+                float left = penX;
+                float right = penX + source.w;
+                float bottom = top + source.h;
+                float u0 = source.x * inverseWidth;
+                float u1 = (source.x + source.w) * inverseWidth;
+                float v0 = source.y * inverseHeight;
+                float v1 = (source.y + source.h) * inverseHeight;
+
+                vertices.push_back(SDL_Vertex{ { left, top }, color, { u0, v0 } });
+                vertices.push_back(SDL_Vertex{ { right, top }, color, { u1, v0 } });
+                vertices.push_back(SDL_Vertex{ { right, bottom }, color, { u1, v1 } });
+                vertices.push_back(SDL_Vertex{ { left, bottom }, color, { u0, v1 } });
+                for (int corner : { 0, 1, 2, 0, 2, 3 }) {
+                    indices.push_back(first + corner);
+                }
+            }
+            penX += source.w;
+        }
+    }
+
+    int GlyphAtlas::textWidth(std::string_view text) const {
+        int total = 0;
+        for (char c : text) {
+            total += glyph(c).w;
+        }
+        return total;
+    }
+
+    int GlyphAtlas::lineHeight() const {
+        return line;
+    }
+
+    SDL_Texture* GlyphAtlas::texture() const {
+        return atlas;
+    }
+
+    const SDL_Rect& GlyphAtlas::glyph(char c) const {
+        int code = static_cast<unsigned char>(c);
+        if (code < first_glyph || code > last_glyph) {
+            code = '?';
+        }
+        return glyphs[code - first_glyph];
+    }
+
+    GlyphAtlas::~GlyphAtlas() {
+        if (atlas != nullptr) {
+            SDL_DestroyTexture(atlas);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef YUME_GLYPH_ATLAS
+#define YUME_GLYPH_ATLAS
+
+#include "../../config.hpp"
+
+#include <array>
+
+namespace yume {
+
+    // Printable ASCII of one font rasterized once, white, into a single texture. Text is then a run of quads
+    // tinted by vertex color, so changing a number costs no TTF rendering and no texture upload, and every line
+    // drawn from the atlas can go out in one SDL_RenderGeometry call. No kerning, the HUD does not need it.
+    class GlyphAtlas {
+    public:
+        static constexpr int first_glyph = 32;
+        static constexpr int last_glyph = 126;
+
+        GlyphAtlas(TTF_Font* font, SDL_Renderer* renderer);
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        // appends two triangles per character, characters outside the atlas draw as '?'
+        void appendText(std::vector<SDL_Vertex>& vertices, std::vector<int>& indices, std::string_view text, vec2<int> position, SDL_Color color) const;
+        int textWidth(std::string_view text) const;
+        int lineHeight() const;
+
+        SDL_Texture* texture() const;
+
+        ~GlyphAtlas();
+
+    private:
+        // where each glyph sits in the atlas, its width is also how far the pen advances
+        std::array<SDL_Rect, last_glyph - first_glyph + 1> glyphs{};
+        SDL_Texture* atlas{ nullptr };
+        int width{ 0 };
+        int height{ 0 };
+        int line{ 0 };
+
+        const SDL_Rect& glyph(char c) const;
+    };
+}
+
+#endif
@@ -0,0 +1,325 @@
+#include "post_process.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define YUME_POST_SSE 1
+#endif
+
+namespace yume {
+
+    namespace {
+        constexpr Uint32 black = 0xff000000;
+        constexpr int max_haze_shift = 3;          // pixels a hazy row moves at full strength
+        constexpr float vignette_strength = 0.45f; // how much the corners lose along each axis
+        constexpr Uint16 scanline_factor = 185;    // odd rows of the CRT filter
+        constexpr Uint16 mask_dim = 205;           // the two channels an aperture column holds back
+
+        float millisecondsSince(Uint64 start) {
+            return static_cast<float>(SDL_GetPerformanceCounter() - start) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+        }
+
+        // dst[x] = src[x - dx], pixels shifted in from outside the row are black
+        void shiftRow(const Uint32* src, Uint32* dst, int width, int dx) {
+            if (dx >= width || dx <= -width) {
+                std::fill(dst, dst + width, black);
+            }
+            else if (dx >= 0) {
+                std::fill(dst, dst + dx, black);
+                std::memcpy(dst + dx, src, static_cast<std::size_t>(width - dx) * sizeof(Uint32));
+            }
+            else {
+                std::memcpy(dst, src - dx, static_cast<std::size_t>(width + dx) * sizeof(Uint32));
+                std::fill(dst + width + dx, dst + width, black);
+            }
+        }
+
+        // Multiplies every byte of the row by columns[byte] * rowFactor / 65536, 0..255 each so the
+        // products stay in 16 bits. src and dst may be the same row.
+        void scaleRow(const Uint32* src, Uint32* dst, int width, const Uint16* columns, Uint16 rowFactor) {
+            int x = 0;
+#if defined(YUME_POST_SSE)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i row = _mm_set1_epi16(static_cast<short>(rowFactor));
+            for (; x + 4 <= width; x += 4) {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+                __m128i low = _mm_unpacklo_epi8(pixels, zero);
+                __m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+                __m128i lowFactor = _mm_srli_epi16(_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(columns + x * 4)), row), 8);
+                __m128i highFactor = _mm_srli_epi16(_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(columns + x * 4 + 8)), row), 8);
+                low = _mm_srli_epi16(_mm_mullo_epi16(low, lowFactor), 8);
+                high = _mm_srli_epi16(_mm_mullo_epi16(high, highFactor), 8);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(low, high));
+            }
+#endif
+            for (; x < width; x++) {
+                Uint32 pixel = src[x];
+                Uint32 result = 0;
+                for (int c = 0; c < 4; c++) {
+                    Uint32 factor = (static_cast<Uint32>(columns[x * 4 + c]) * rowFactor) >> 8;
+                    Uint32 channel = (pixel >> (c * 8)) & 0xff;
+                    result |= ((channel * factor) >> 8) << (c * 8);
+                }
+                dst[x] = result;
+            }
+        }
+    }
+
+    float PostStats::totalMs() const {
+        float total = readbackMs + uploadMs;
+        for (float ms : effectMs) {
+            total += ms;
+        }
+        return total;
+    }
+
+    PostProcessor::PostProcessor(int width_v, int height_v, SDL_Renderer* renderer, JobSystem* jobs_v)
+        : width(width_v), height(height_v), jobs(jobs_v) {
+        frame.resize(static_cast<std::size_t>(width) * height);
+        work.resize(frame.size());
+
+        // The vignette is separable, a column factor times a row factor, so the tables stay one row long.
+        // Alpha keeps 255, the output is copied without blending.
+        vignetteColumns.resize(static_cast<std::size_t>(width) * 4);
+        crtColumns.resize(vignetteColumns.size());
+        for (int x = 0; x < width; x++) {
+            float nx = (x + 0.5f) / width * 2.0f - 1.0f;
+            Uint16 factor = static_cast<Uint16>(255.0f * (1.0f - vignette_strength * nx * nx));
+            for (int c = 0; c < 3; c++) {
+                vignetteColumns[x * 4 + c] = factor;
+                // ARGB8888 is blue, green, red, alpha in memory, the columns repeat red, green, blue
+                crtColumns[x * 4 + c] = (2 - c) == x % 3 ? 255 : mask_dim;
+            }
+            vignetteColumns[x * 4 + 3] = 255;
+            crtColumns[x * 4 + 3] = 255;
+        }
+        vignetteRows.resize(height);
+        for (int y = 0; y < height; y++) {
+            float ny = (y + 0.5f) / height * 2.0f - 1.0f;
+            vignetteRows[y] = static_cast<Uint16>(255.0f * (1.0f - vignette_strength * ny * ny));
+        }
+
+        if (SDL_RenderTargetSupported(renderer) != SDL_TRUE) {
+            std::cout << "Render targets are not supported, post processing is off\n";
+            return;
+        }
+
+        target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        output = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (target == nullptr || output == nullptr) {
+            std::cout << "SDL_CreateTexture Error: " << SDL_GetError() << '\n';
+            return;
+        }
+        SDL_SetTextureBlendMode(output, SDL_BLENDMODE_NONE);
+    }
+
+    void PostProcessor::enableFromList(std::string_view list) {
+        while (!list.empty()) {
+            std::size_t comma = list.find(',');
+            std::string_view name = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            bool known = false;
+            for (int i = 0; i < static_cast<int>(PostEffect::Count); i++) {
+                if (name == "all" || name == effectName(static_cast<PostEffect>(i))) {
+                    enabled[i] = true;
+                    known = true;
+                }
+            }
+            if (!known && !name.empty()) {
+                std::cout << "Unknown post effect \"" << name << "\", expected shake, haze, vignette, crt or all\n";
+            }
+        }
+    }
+
+    void PostProcessor::setEnabled(PostEffect effect, bool on) {
+        enabled[static_cast<int>(effect)] = on;
+    }
+
+    bool PostProcessor::isEnabled(PostEffect effect) const {
+        return enabled[static_cast<int>(effect)];
+    }
+
+    bool PostProcessor::active() const {
+        if (target == nullptr || output == nullptr) {
+            return false;
+        }
+        return std::find(enabled.begin(), enabled.end(), true) != enabled.end();
+    }
+
+    void PostProcessor::shake(float pixels, float seconds) {
+        shakePixels = pixels;
+        shakeDuration = std::max(seconds, 0.001f);
+        shakeTime = shakeDuration;
+    }
+
+    void PostProcessor::setHeatSource(const SDL_Rect& area, float strength) {
+        heatArea = area;
+        heatStrength = std::clamp(strength, 0.0f, 1.0f);
+    }
+
+    void PostProcessor::update(float deltaTime) {
+        time += deltaTime;
+        shakeTime = std::max(0.0f, shakeTime - deltaTime);
+    }
+
+    void PostProcessor::begin(SDL_Renderer* renderer) {
+        if (!active()) {
+            return;
+        }
+
+        previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, target);
+        drawing = true;
+    }
+
+    // two bands per worker so one that starts late does not hold up the whole pass
+    template <typename F>
+    float PostProcessor::forRows(F&& body) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (jobs != nullptr && jobs->threadCount() > 1) {
+            int band = height / static_cast<int>(jobs->threadCount() * 2) + 1;
+            auto* shared = &body;
+            for (int first = band; first < height; first += band) {
+                int last = std::min(first + band, height);
+                jobs->run([shared, first, last]() { (*shared)(first, last); }, &bandsPending);
+            }
+
+            // the first band is done here instead of queued, as parallelFor does
+            body(0, std::min(band, height));
+            jobs->wait(bandsPending);
+        }
+        else {
+            body(0, height);
+        }
+        return millisecondsSince(start);
+    }
+
+    void PostProcessor::end(SDL_Renderer* renderer) {
+        if (!drawing) {
+            return;
+        }
+        drawing = false;
+        frameStats = PostStats{};
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        int read = SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, frame.data(), width * static_cast<int>(sizeof(Uint32)));
+        SDL_SetRenderTarget(renderer, previousTarget);
+        frameStats.readbackMs = millisecondsSince(start);
+
+        void* pixels = nullptr;
+        int pitch = 0;
+        if (read != 0 || SDL_LockTexture(output, nullptr, &pixels, &pitch) != 0) {
+            // the frame is still worth showing without the effects
+            SDL_RenderCopy(renderer, target, nullptr, nullptr);
+            return;
+        }
+        Uint8* locked = static_cast<Uint8*>(pixels);
+        auto outputRow = [locked, pitch](int y) { return reinterpret_cast<Uint32*>(locked + static_cast<std::size_t>(y) * pitch); };
+
+        Uint32* current = frame.data();
+        auto currentRow = [&current, this](int y) { return current + static_cast<std::size_t>(y) * width; };
+
+        vec2<int> offset = shakeOffset();
+        if (enabled[static_cast<int>(PostEffect::Shake)] && (offset.x != 0 || offset.y != 0)) {
+            frameStats.effectMs[static_cast<int>(PostEffect::Shake)] = forRows([&](int first, int last) {
+                for (int y = first; y < last; y++) {
+                    Uint32* dst = work.data() + static_cast<std::size_t>(y) * width;
+                    int sourceY = y - offset.y;
+                    if (sourceY < 0 || sourceY >= height) {
+                        std::fill(dst, dst + width, black);
+                    }
+                    else {
+                        shiftRow(frame.data() + static_cast<std::size_t>(sourceY) * width, dst, width, offset.x);
+                    }
+                }
+            });
+            current = work.data();
+        }
+
+        // a few dozen short rows, not worth waking the workers for
+        if (enabled[static_cast<int>(PostEffect::Haze)] && heatStrength > 0.0f) {
+            Uint64 hazeStart = SDL_GetPerformanceCounter();
+            int left = std::max(heatArea.x, max_haze_shift);
+            int right = std::min(heatArea.x + heatArea.w, width - max_haze_shift);
+            int top = std::max(heatArea.y + offset.y, 0);
+            int bottom = std::min(heatArea.y + heatArea.h + offset.y, height);
+            for (int y = top; y < bottom && left < right; y++) {
+                // strongest in the middle of the plume, fading to nothing at its ends
+                float along = (y - top + 0.5f) / std::max(bottom - top, 1);
+                float fade = std::sin(along * static_cast<float>(M_PI));
+                int shift = static_cast<int>(std::lround(max_haze_shift * heatStrength * fade * std::sin(y * 0.45f + time * 14.0f)));
+                if (shift != 0) {
+                    Uint32* row = currentRow(y);
+                    std::memmove(row + left, row + left + shift, static_cast<std::size_t>(right - left) * sizeof(Uint32));
+                }
+            }
+            frameStats.effectMs[static_cast<int>(PostEffect::Haze)] = millisecondsSince(hazeStart);
+        }
+
+        bool vignette = enabled[static_cast<int>(PostEffect::Vignette)];
+        bool crt = enabled[static_cast<int>(PostEffect::Crt)];
+
+        if (vignette) {
+            frameStats.effectMs[static_cast<int>(PostEffect::Vignette)] = forRows([&](int first, int last) {
+                for (int y = first; y < last; y++) {
+                    scaleRow(currentRow(y), crt ? currentRow(y) : outputRow(y), width, vignetteColumns.data(), vignetteRows[y]);
+                }
+            });
+        }
+
+        if (crt) {
+            frameStats.effectMs[static_cast<int>(PostEffect::Crt)] = forRows([&](int first, int last) {
+                for (int y = first; y < last; y++) {
+                    scaleRow(currentRow(y), outputRow(y), width, crtColumns.data(), (y & 1) ? scanline_factor : 255);
+                }
+            });
+        }
+
+        start = SDL_GetPerformanceCounter();
+        if (!vignette && !crt) {
+            for (int y = 0; y < height; y++) {
+                std::memcpy(outputRow(y), currentRow(y), static_cast<std::size_t>(width) * sizeof(Uint32));
+            }
+        }
+        SDL_UnlockTexture(output);
+        SDL_RenderCopy(renderer, output, nullptr, nullptr);
+        frameStats.uploadMs = millisecondsSince(start);
+    }
+
+    const PostStats& PostProcessor::stats() const {
+        return frameStats;
+    }
+
+    const char* PostProcessor::effectName(PostEffect effect) {
+        switch (effect) {
+        case PostEffect::Shake: return "shake";
+        case PostEffect::Haze: return "haze";
+        case PostEffect::Vignette: return "vignette";
+        case PostEffect::Crt: return "crt";
+        default: return "";
+        }
+    }
+
+    vec2<int> PostProcessor::shakeOffset() const {
+        if (shakeTime <= 0.0f) {
+            return vec2<int>{ 0, 0 };
+        }
+
+        // two unrelated frequencies so the screen jitters instead of circling
+        float amount = shakePixels * shakeTime / shakeDuration;
+        return vec2<int>{ static_cast<int>(std::lround(amount * std::sin(time * 83.0f))), static_cast<int>(std::lround(amount * std::cos(time * 61.0f))) };
+    }
+
+    PostProcessor::~PostProcessor() {
+        if (target != nullptr) {
+            SDL_DestroyTexture(target);
+        }
+        if (output != nullptr) {
+            SDL_DestroyTexture(output);
+        }
+    }
+}
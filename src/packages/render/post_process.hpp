@@ -0,0 +1,94 @@
+#ifndef YUME_POST_PROCESS
+#define YUME_POST_PROCESS
+
+#include "../../config.hpp"
+#include "../jobs/job_system.hpp"
+
+#include <array>
+
+namespace yume {
+
+    enum class PostEffect {
+        Shake,
+        Haze,
+        Vignette,
+        Crt,
+        Count
+    };
+
+    // The time each pass took on the last frame, in milliseconds. readback and upload are the two copies
+    // between the renderer and the CPU, the effects run in between on scanline bands.
+    struct PostStats {
+        float readbackMs{ 0.0f };
+        std::array<float, static_cast<int>(PostEffect::Count)> effectMs{};
+        float uploadMs{ 0.0f };
+
+        float totalMs() const;
+    };
+
+    // Draws the frame into an offscreen target between begin() and end(), reads it back once, runs the enabled
+    // effects over the rows on the CPU and uploads the result once through a streaming texture.
+    // The passes work in place on CPU memory and only the last one writes the locked texture, which can be
+    // write combined memory that is slow to read.
+    class PostProcessor {
+    public:
+        PostProcessor(int width_v, int height_v, SDL_Renderer* renderer, JobSystem* jobs_v = nullptr);
+
+        // a comma separated list of effect names, "all" turns every effect on
+        void enableFromList(std::string_view list);
+        void setEnabled(PostEffect effect, bool enabled);
+        bool isEnabled(PostEffect effect) const;
+        // false when no effect is on or the textures could not be created, begin() and end() do nothing then
+        bool active() const;
+
+        // shakes by up to this many pixels, fading out over the given time
+        void shake(float pixels, float seconds);
+        // rows inside the area wobble sideways, strength 0 to 1, 0 turns the haze off
+        void setHeatSource(const SDL_Rect& area, float strength);
+        void update(float deltaTime);
+
+        void begin(SDL_Renderer* renderer);
+        void end(SDL_Renderer* renderer);
+
+        const PostStats& stats() const;
+        static const char* effectName(PostEffect effect);
+
+        ~PostProcessor();
+
+    private:
+        int width;
+        int height;
+        JobSystem* jobs;
+        JobCounter bandsPending;  // lives as long as the processor, a band never outlives what it counts
+        SDL_Texture* target{ nullptr };
+        SDL_Texture* output{ nullptr };
+        SDL_Texture* previousTarget{ nullptr };
+        bool drawing{ false };
+
+        std::array<bool, static_cast<int>(PostEffect::Count)> enabled{};
+        PostStats frameStats;
+
+        // the frame as read back, and the shaken copy of it since the shake moves rows across bands
+        std::vector<Uint32> frame;
+        std::vector<Uint32> work;
+
+        // factors 0..255 of the multiply passes, the columns have one per byte of a row, the rows one per row
+        std::vector<Uint16> vignetteColumns;
+        std::vector<Uint16> vignetteRows;
+        std::vector<Uint16> crtColumns;
+
+        float time{ 0.0f };
+        float shakeTime{ 0.0f };
+        float shakeDuration{ 0.0f };
+        float shakePixels{ 0.0f };
+        SDL_Rect heatArea{ 0, 0, 0, 0 };
+        float heatStrength{ 0.0f };
+
+        vec2<int> shakeOffset() const;
+        // runs body(first, last) over row bands on the jobs and returns the milliseconds it took
+        template <typename F>
+        float forRows(F&& body);
+    };
+}
+
+#endif
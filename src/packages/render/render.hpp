@@ -2,6 +2,8 @@
 #define YUME_REDNER_FUNCS
 
 #include "../../config.hpp"
+#include "../simulation/collision_mask.hpp"
+#include "asset_cache.hpp"
 
 namespace yume {
 
@@ -9,17 +11,56 @@ namespace yume {
     public:
 		RenderManager() = default;
 
+        // decoded by AssetCache::preloadImages() when main() started it early, on the spot otherwise
         SDL_Texture* loadTexture(const char* file, SDL_Renderer* ren) {
-            SDL_Surface* surface = IMG_Load(file);
+            SDL_Surface* preloaded = AssetCache::image(file);
+            SDL_Surface* surface = preloaded != nullptr ? preloaded : IMG_Load(file);
             if (surface == nullptr) {
                 printf("IMG_Load Error: %s\n", IMG_GetError());
                 return nullptr;
             }
             SDL_Texture* texture = SDL_CreateTextureFromSurface(ren, surface);
-            SDL_FreeSurface(surface);
+            if (preloaded == nullptr) {
+                SDL_FreeSurface(surface);
+            }
             return texture;
         }
 
+        // the alpha channel of an image for building collision masks, empty if it fails to load
+        AlphaImage loadAlpha(const char* file) {
+            AlphaImage image;
+            SDL_Surface* preloaded = AssetCache::image(file);
+            SDL_Surface* loaded = preloaded != nullptr ? preloaded : IMG_Load(file);
+            if (loaded == nullptr) {
+                printf("IMG_Load Error: %s\n", IMG_GetError());
+                return image;
+            }
+
+            SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+            if (preloaded == nullptr) {
+                SDL_FreeSurface(loaded);
+            }
+            if (surface == nullptr) {
+                printf("SDL_ConvertSurfaceFormat Error: %s\n", SDL_GetError());
+                return image;
+            }
+
+            image.width = surface->w;
+            image.height = surface->h;
+            image.alpha.resize(static_cast<size_t>(surface->w) * surface->h);
+
+            SDL_LockSurface(surface);
+            for (int y = 0; y < surface->h; y++) {
+                const Uint8* row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch;
+                for (int x = 0; x < surface->w; x++) {
+                    image.alpha[static_cast<size_t>(y) * surface->w + x] = row[x * 4 + 3];
+                }
+            }
+            SDL_UnlockSurface(surface);
+            SDL_FreeSurface(surface);
+            return image;
+        }
+
 		~RenderManager() = default;
 	};
 }
@@ -0,0 +1,114 @@
+#include "resolution_scaler.hpp"
+
+namespace yume {
+
+    ResolutionScaler::ResolutionScaler(int width_v, int height_v, float target_frame_ms, SDL_Renderer* renderer)
+        : width(width_v), height(height_v), targetMs(target_frame_ms) {
+        if (SDL_RenderTargetSupported(renderer) != SDL_TRUE) {
+            std::cout << "Render targets are not supported, the world is always drawn at full resolution\n";
+            return;
+        }
+
+        target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (target == nullptr) {
+            std::cout << "SDL_CreateTexture Error: " << SDL_GetError() << '\n';
+            return;
+        }
+        SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+    }
+
+    void ResolutionScaler::beginFrame() {
+        frameStart = SDL_GetPerformanceCounter();
+    }
+
+    void ResolutionScaler::endFrame(SDL_Renderer* renderer) {
+        SDL_RenderFlush(renderer);
+
+        float elapsed = static_cast<float>(SDL_GetPerformanceCounter() - frameStart) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+        samples[sampleIndex] = elapsed;
+        sampleIndex = (sampleIndex + 1) % window_frames;
+        if (sampleCount < window_frames) {
+            sampleCount += 1;
+        }
+
+        if (sampleCount == window_frames) {
+            adjust();
+        }
+    }
+
+    void ResolutionScaler::beginWorld(SDL_Renderer* renderer) {
+        if (target == nullptr || currentScale >= 1.0f) {
+            return;
+        }
+
+        // only the top left scaled rect of the target is drawn and copied, the rest is left stale
+        previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, target);
+        SDL_RenderSetScale(renderer, currentScale, currentScale);
+        drawingWorld = true;
+    }
+
+    void ResolutionScaler::endWorld(SDL_Renderer* renderer) {
+        if (!drawingWorld) {
+            return;
+        }
+
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_Rect source = scaledRect();
+        SDL_RenderCopy(renderer, target, &source, nullptr);
+        drawingWorld = false;
+    }
+
+    float ResolutionScaler::scale() const {
+        return currentScale;
+    }
+
+    float ResolutionScaler::averageFrameMs() const {
+        if (sampleCount == 0) {
+            return 0.0f;
+        }
+
+        float sum = 0.0f;
+        for (int i = 0; i < sampleCount; i++) {
+            sum += samples[i];
+        }
+        return sum / sampleCount;
+    }
+
+    SDL_Rect ResolutionScaler::scaledRect() const {
+        return SDL_Rect{ 0, 0, static_cast<int>(width * currentScale + 0.5f), static_cast<int>(height * currentScale + 0.5f) };
+    }
+
+    // Drops a step once the rolling average eats 90% of the budget and only climbs back below 60%,
+    // the gap keeps it from flipping between two scales. The window restarts after every change
+    // so the next decision only sees frames drawn at the new scale.
+    void ResolutionScaler::adjust() {
+        if (target == nullptr) {
+            return;
+        }
+
+        float average = averageFrameMs();
+        float next = currentScale;
+
+        if (average > targetMs * 0.9f && currentScale > min_scale) {
+            next = std::max(min_scale, currentScale - scale_step);
+        }
+        else if (average < targetMs * 0.6f && currentScale < 1.0f) {
+            next = std::min(1.0f, currentScale + scale_step);
+        }
+
+        if (next != currentScale) {
+            // steps are kept on a 0.1 grid so float drift never leaves the scale at 0.9999
+            currentScale = std::round(next * 10.0f) / 10.0f;
+            std::cout << "Render scale " << currentScale << " (" << average << " ms average, " << targetMs << " ms budget)\n";
+            sampleCount = 0;
+            sampleIndex = 0;
+        }
+    }
+
+    ResolutionScaler::~ResolutionScaler() {
+        if (target != nullptr) {
+            SDL_DestroyTexture(target);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef YUME_RESOLUTION_SCALER
+#define YUME_RESOLUTION_SCALER
+
+#include "../../config.hpp"
+
+#include <array>
+
+namespace yume {
+
+    // Draws the world into an offscreen target at a fraction of the window resolution and upscales it,
+    // the fraction follows the measured frame time. HUD drawn after endWorld() stays at native resolution.
+    // At full scale the world is drawn straight to the backbuffer and the offscreen target is never used.
+    class ResolutionScaler {
+    public:
+        static constexpr float min_scale = 0.5f;
+        static constexpr float scale_step = 0.1f;
+        static constexpr int window_frames = 30;
+
+        ResolutionScaler(int width_v, int height_v, float target_frame_ms, SDL_Renderer* renderer);
+
+        // frame time is measured from beginFrame() to endFrame(), which flushes the renderer
+        // so the measurement covers the drawing but not the vsync wait in SDL_RenderPresent
+        void beginFrame();
+        void endFrame(SDL_Renderer* renderer);
+
+        void beginWorld(SDL_Renderer* renderer);
+        void endWorld(SDL_Renderer* renderer);
+
+        float scale() const;
+        float averageFrameMs() const;
+
+        ~ResolutionScaler();
+
+    private:
+        int width;
+        int height;
+        float targetMs;
+        float currentScale{ 1.0f };
+        SDL_Texture* target{ nullptr };
+        // the backbuffer, or the post processor's target when it draws the frame offscreen
+        SDL_Texture* previousTarget{ nullptr };
+        bool drawingWorld{ false };
+
+        Uint64 frameStart{ 0 };
+        std::array<float, window_frames> samples{};
+        int sampleCount{ 0 };
+        int sampleIndex{ 0 };
+
+        SDL_Rect scaledRect() const;
+        void adjust();
+    };
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "sprite_batch.hpp"
+#include "sprite_cache.hpp"
+
+namespace yume {
+
+    SpriteBatch::SpriteBatch(const GlyphAtlas* atlas_v, SpriteCache* sprites_v)
+        : atlas{ atlas_v }, sprites{ sprites_v } {
+    }
+
+    void SpriteBatch::clear() {
+        queued.clear();
+        for (TextBuffer& buffer : text) {
+            buffer.vertices.clear();
+            buffer.indices.clear();
+        }
+    }
+
+    void SpriteBatch::addSprite(SDL_Texture* texture, const SDL_Rect& dst, double angle) {
+        // a rotated rectangle stays inside the circle through its corners
+        int radius = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(dst.w) * dst.w + static_cast<double>(dst.h) * dst.h) / 2.0));
+        int centerX = dst.x + dst.w / 2;
+        int centerY = dst.y + dst.h / 2;
+        SDL_Rect reach{ centerX - radius, centerY - radius, radius * 2, radius * 2 };
+        queued.push_back(Sprite{ texture, dst, angle == 0.0 ? dst : reach, angle });
+    }
+
+    void SpriteBatch::addText(int pane, std::string_view line, vec2<int> position, SDL_Color color) {
+        if (atlas == nullptr || pane < world_space || pane >= max_panes) {
+            return;
+        }
+        TextBuffer& buffer = text[pane + 1];
+        atlas->appendText(buffer.vertices, buffer.indices, line, position, color);
+    }
+
+    void SpriteBatch::drawWorld(SDL_Renderer* renderer, const SDL_Rect& view) const {
+        for (const Sprite& sprite : queued) {
+            if (!SDL_HasIntersection(&sprite.reach, &view)) {
+                continue;
+            }
+            if (sprites != nullptr) {
+                sprites->draw(renderer, sprite.texture, sprite.dst, sprite.angle);
+            }
+            else {
+                SDL_RenderCopyEx(renderer, sprite.texture, nullptr, &sprite.dst, sprite.angle, nullptr, SDL_FLIP_NONE);
+            }
+        }
+        // the clip rect drops what falls outside the view, culling each glyph would cost more than it saves
+        drawText(renderer, text[0]);
+    }
+
+    void SpriteBatch::drawPaneText(SDL_Renderer* renderer, int pane) const {
+        if (pane < 0 || pane >= max_panes) {
+            return;
+        }
+        drawText(renderer, text[pane + 1]);
+    }
+
+    int SpriteBatch::spriteCount() const {
+        return static_cast<int>(queued.size());
+    }
+
+    void SpriteBatch::drawText(SDL_Renderer* renderer, const TextBuffer& buffer) const {
+        if (buffer.indices.empty()) {
+            return;
+        }
+        SDL_RenderGeometry(renderer, atlas->texture(), buffer.vertices.data(), static_cast<int>(buffer.vertices.size()),
+            buffer.indices.data(), static_cast<int>(buffer.indices.size()));
+    }
+}
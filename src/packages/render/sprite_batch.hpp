@@ -0,0 +1,60 @@
+#ifndef YUME_SPRITE_BATCH
+#define YUME_SPRITE_BATCH
+
+#include "../../config.hpp"
+#include "glyph_atlas.hpp"
+
+#include <array>
+
+namespace yume {
+
+    class SpriteCache;
+
+    // Everything a frame draws on top of the cached layers, submitted once and replayed into every view.
+    // World sprites and world text are in world coordinates and drawn into each view they overlap, through the
+    // same sprite cache so a rotated variant built for one view is a plain copy in the next. Pane text is in the
+    // coordinates of one pane. All text comes from one glyph atlas and goes out as one geometry call per pass.
+    // The buffers keep their capacity, a steady frame does not allocate.
+    class SpriteBatch {
+    public:
+        static constexpr int max_panes = 4;
+        static constexpr int world_space = -1;
+
+        SpriteBatch(const GlyphAtlas* atlas_v, SpriteCache* sprites_v = nullptr);
+
+        void clear();
+
+        void addSprite(SDL_Texture* texture, const SDL_Rect& dst, double angle);
+        // pane is world_space or 0 to max_panes - 1
+        void addText(int pane, std::string_view text, vec2<int> position, SDL_Color color);
+
+        // the world sprites and world text overlapping view, with the renderer already mapping world coordinates
+        void drawWorld(SDL_Renderer* renderer, const SDL_Rect& view) const;
+        void drawPaneText(SDL_Renderer* renderer, int pane) const;
+
+        int spriteCount() const;
+
+    private:
+        struct Sprite {
+            SDL_Texture* texture;
+            SDL_Rect dst;
+            SDL_Rect reach; // dst grown to cover any rotation, for culling
+            double angle;
+        };
+
+        struct TextBuffer {
+            std::vector<SDL_Vertex> vertices;
+            std::vector<int> indices;
+        };
+
+        const GlyphAtlas* atlas;
+        SpriteCache* sprites;
+        std::vector<Sprite> queued;
+        // world_space text first, then one buffer per pane
+        std::array<TextBuffer, max_panes + 1> text;
+
+        void drawText(SDL_Renderer* renderer, const TextBuffer& buffer) const;
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "sprite_cache.hpp"
+
+namespace yume {
+
+    SpriteCache::SpriteCache(SDL_Renderer* renderer, float angle_step, int max_entries)
+        : angleStep(angle_step), maxEntries(std::max(max_entries, 1)) {
+        SDL_RendererInfo info;
+        bool software = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+        active = software && angleStep > 0.0f && SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+        buckets = angleStep > 0.0f ? std::max(1, static_cast<int>(std::lround(360.0f / angleStep))) : 1;
+
+        entries.reserve(maxEntries);
+        lookup.reserve(maxEntries);
+        spareNodes.reserve(maxEntries);
+        for (int i = 0; i < maxEntries; i++) {
+            lookup.emplace(Key{ nullptr, i, 0, 0 }, i);
+        }
+        while (!lookup.empty()) {
+            spareNodes.push_back(lookup.extract(lookup.begin()));
+        }
+    }
+
+    void SpriteCache::draw(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& dst, double angle) {
+        if (!active || texture == nullptr || dst.w <= 0 || dst.h <= 0) {
+            SDL_RenderCopyEx(renderer, texture, nullptr, &dst, angle, nullptr, SDL_FLIP_NONE);
+            return;
+        }
+
+        double wrapped = std::fmod(angle, 360.0);
+        if (wrapped < 0.0) wrapped += 360.0;
+        int bucket = static_cast<int>(std::lround(wrapped / angleStep)) % buckets;
+
+        int index = findOrBuild(renderer, Key{ texture, bucket, dst.w, dst.h });
+        if (index < 0) {
+            SDL_RenderCopyEx(renderer, texture, nullptr, &dst, angle, nullptr, SDL_FLIP_NONE);
+            return;
+        }
+
+        // the variant is the rotated bounding box around the same center
+        const Entry& entry = entries[index];
+        SDL_Rect out = { dst.x + (dst.w - entry.width) / 2, dst.y + (dst.h - entry.height) / 2, entry.width, entry.height };
+        SDL_RenderCopy(renderer, entry.variant, nullptr, &out);
+    }
+
+    bool SpriteCache::enabled() const {
+        return active;
+    }
+
+    int SpriteCache::size() const {
+        return static_cast<int>(entries.size());
+    }
+
+    void SpriteCache::clear() {
+        for (Entry& entry : entries) {
+            spareNodes.push_back(lookup.extract(entry.key));
+            SDL_DestroyTexture(entry.variant);
+        }
+        entries.clear();
+    }
+
+    int SpriteCache::findOrBuild(SDL_Renderer* renderer, const Key& key) {
+        tick += 1;
+
+        auto found = lookup.find(key);
+        if (found != lookup.end()) {
+            entries[found->second].lastUsed = tick;
+            return found->second;
+        }
+
+        int width, height;
+        SDL_Texture* variant = build(renderer, key, width, height);
+        if (variant == nullptr) {
+            return -1;
+        }
+
+        int index;
+        Lookup::node_type node;
+        if (static_cast<int>(entries.size()) < maxEntries) {
+            entries.push_back(Entry{ key, variant, width, height, tick });
+            index = static_cast<int>(entries.size()) - 1;
+            node = std::move(spareNodes.back());
+            spareNodes.pop_back();
+        }
+        else {
+            index = 0;
+            for (int i = 1; i < static_cast<int>(entries.size()); i++) {
+                if (entries[i].lastUsed < entries[index].lastUsed) {
+                    index = i;
+                }
+            }
+            SDL_DestroyTexture(entries[index].variant);
+            node = lookup.extract(entries[index].key);
+            entries[index] = Entry{ key, variant, width, height, tick };
+        }
+
+        node.key() = key;
+        node.mapped() = index;
+        lookup.insert(std::move(node));
+        return index;
+    }
+
+    SDL_Texture* SpriteCache::build(SDL_Renderer* renderer, const Key& key, int& width, int& height) {
+        double degrees = key.angle * static_cast<double>(angleStep);
+        double radians = degrees * M_PI / 180.0;
+        double c = std::abs(std::cos(radians));
+        double s = std::abs(std::sin(radians));
+
+        // keep the margin around the sprite even on both sides so the center does not shift by half a pixel
+        width = static_cast<int>(std::ceil(key.width * c + key.height * s - 0.001));
+        height = static_cast<int>(std::ceil(key.width * s + key.height * c - 0.001));
+        if ((width - key.width) % 2 != 0) width += 1;
+        if ((height - key.height) % 2 != 0) height += 1;
+
+        SDL_Texture* variant = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (variant == nullptr) {
+            std::cout << "SDL_CreateTexture Error: " << SDL_GetError() << '\n';
+            active = false;
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(variant, SDL_BLENDMODE_BLEND);
+
+        // switching targets resets the render scale, viewport and clip, the resolution scaler's scale and a split
+        // screen pane's viewport have to survive this
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        float scaleX, scaleY;
+        SDL_RenderGetScale(renderer, &scaleX, &scaleY);
+        SDL_Rect viewport, clip;
+        SDL_RenderGetViewport(renderer, &viewport);
+        SDL_RenderGetClipRect(renderer, &clip);
+        bool clipped = SDL_RenderIsClipEnabled(renderer) == SDL_TRUE;
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+        SDL_BlendMode sourceBlend;
+        SDL_GetTextureBlendMode(key.texture, &sourceBlend);
+
+        SDL_SetRenderTarget(renderer, variant);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+
+        // copied without blending, blending onto the transparent clear would multiply the edges by alpha twice
+        SDL_SetTextureBlendMode(key.texture, SDL_BLENDMODE_NONE);
+        SDL_Rect inner = { (width - key.width) / 2, (height - key.height) / 2, key.width, key.height };
+        SDL_RenderCopyEx(renderer, key.texture, nullptr, &inner, degrees, nullptr, SDL_FLIP_NONE);
+        SDL_SetTextureBlendMode(key.texture, sourceBlend);
+
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_RenderSetScale(renderer, scaleX, scaleY);
+        SDL_RenderSetViewport(renderer, &viewport);
+        SDL_RenderSetClipRect(renderer, clipped ? &clip : nullptr);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        return variant;
+    }
+
+    SpriteCache::~SpriteCache() {
+        clear();
+    }
+}
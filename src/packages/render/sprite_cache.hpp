@@ -0,0 +1,75 @@
+#ifndef YUME_SPRITE_CACHE
+#define YUME_SPRITE_CACHE
+
+#include "../../config.hpp"
+
+#include <unordered_map>
+
+namespace yume {
+
+    // Pre-renders rotated and scaled variants of a texture once and serves them as plain 1:1 copies.
+    // The software renderer transforms every pixel of an SDL_RenderCopyEx, a cached variant is a straight blit.
+    // Angles snap to angle_step degrees, the least recently drawn variant is dropped once max_entries are cached.
+    // On accelerated renderers the GPU rotates for free and draw() passes straight through to SDL_RenderCopyEx.
+    class SpriteCache {
+    public:
+        SpriteCache(SDL_Renderer* renderer, float angle_step = 2.0f, int max_entries = 512);
+        SpriteCache(const SpriteCache&) = delete;
+        SpriteCache& operator=(const SpriteCache&) = delete;
+
+        // same result as SDL_RenderCopyEx(renderer, texture, nullptr, &dst, angle, nullptr, SDL_FLIP_NONE)
+        void draw(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& dst, double angle);
+
+        bool enabled() const;
+        int size() const;
+
+        // variants live in render targets, they are gone after SDL_RENDER_TARGETS_RESET
+        void clear();
+
+        ~SpriteCache();
+
+    private:
+        struct Key {
+            SDL_Texture* texture;
+            int angle;
+            int width;
+            int height;
+
+            bool operator==(const Key& other) const {
+                return texture == other.texture && angle == other.angle && width == other.width && height == other.height;
+            }
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const {
+                std::size_t hash = std::hash<const void*>()(key.texture);
+                hash ^= (static_cast<std::size_t>(key.angle) * 0x9E3779B1u) + (static_cast<std::size_t>(key.width) << 16) + static_cast<std::size_t>(key.height);
+                return hash;
+            }
+        };
+
+        struct Entry {
+            Key key;
+            SDL_Texture* variant;
+            int width;
+            int height;
+            Uint64 lastUsed;
+        };
+
+        bool active;
+        float angleStep;
+        int buckets;
+        int maxEntries;
+        Uint64 tick{ 0 };
+        std::vector<Entry> entries;
+        using Lookup = std::unordered_map<Key, int, KeyHash>;
+        Lookup lookup;
+        // nodes for the lookup made up front, a miss moves one in instead of allocating
+        std::vector<Lookup::node_type> spareNodes;
+
+        int findOrBuild(SDL_Renderer* renderer, const Key& key);
+        SDL_Texture* build(SDL_Renderer* renderer, const Key& key, int& width, int& height);
+    };
+}
+
+#endif
@@ -0,0 +1,761 @@
+#include "game.hpp"
+#include "../core/allocation_tracker.hpp"
+
+#include <ctime>
+#include <filesystem>
+
+Game::Game(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr, yume::AudioEngine* aud, yume::TelemetryRecorder* tel, yume::JobSystem* jobs, float targetFrameMs, unsigned seed)
+    : Scene(rend, wind, mgr),
+    gen(seed),
+    rocket(new Rocket(yume::vec2<float>{ 575, 410 }, yume::vec2<float>{ 32, 64 }, renderer)),
+    rocketBoosterAnim(new Texture(yume::vec2<float>{ rocket->position.x, rocket->position.y }, yume::vec2<float>{ 32, 64 }, "res/textures/booster1.png", renderer)),
+    island(std::make_unique<Island>(yume::vec2<float>{ 200, 320 }, yume::vec2<float>{ 100, 66 }, renderer)),
+    airstrip(std::make_unique<Texture>(yume::vec2<float>{ 200, 320 }, yume::vec2<float>{ 100, 66 }, "res/textures/airstrip.png", renderer)),
+    background(std::make_unique<Texture>(yume::vec2<float>{ 0, 0 }, yume::vec2<float>{ 800, 600 }, "res/textures/background.png", renderer)),
+    compositor(std::make_unique<yume::Compositor>(800, 600, renderer)),
+    resolution(std::make_unique<yume::ResolutionScaler>(800, 600, targetFrameMs, renderer)),
+    sprites(std::make_unique<yume::SpriteCache>(renderer)),
+    thrustText(std::make_unique<Text>(yume::vec2<int>{ 5, 15 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Thrust: ", renderer)),
+    velocityText(std::make_unique<Text>(yume::vec2<int>{ 5, 40 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Velocity: ", renderer)),
+    engineText(std::make_unique<Text>(yume::vec2<int>{ 5, 65 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Engine: ", renderer)),
+    rotationText(std::make_unique<Text>(yume::vec2<int>{ 5, 90 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Rotation: ", renderer)),
+    heightText(std::make_unique<Text>(yume::vec2<int>{ 5, 115 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Height: ", renderer)),
+    winStreakText(std::make_unique<Text>(yume::vec2<int>{ 5, 140 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Win Streak: ", renderer)),
+    stageText(std::make_unique<Text>(yume::vec2<int>{ 5, 165 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Stage: ", renderer)),
+    turnOnEngineText(std::make_unique<Text>(yume::vec2<int>{ 260, 100 }, 32, SDL_Color{ 255, 0, 0, 255 }, "TURN ON THE ENGINE!", renderer)),
+    winCounterText(std::make_unique<Text>(yume::vec2<int>{ 350, 300 }, 32, SDL_Color{ 0, 0, 0, 255 }, "3.0", renderer)),
+    winText(std::make_unique<Text>(yume::vec2<int>{ 325, 300 }, 36, SDL_Color{ 0, 0, 0, 255 }, "YOU WON!", renderer)),
+    winText2(std::make_unique<Text>(yume::vec2<int>{ 335, 345 }, 16, SDL_Color{ 0, 0, 0, 255 }, "press R to continue!", renderer)),
+    winText3(std::make_unique<Text>(yume::vec2<int>{ 260, 360 }, 16, SDL_Color{ 0, 0, 0, 255 }, "Press R to continue and thanks for playing!", renderer)),
+    lossText(std::make_unique<Text>(yume::vec2<int>{ 326, 300 }, 36, SDL_Color{ 0, 0, 0, 255 }, "YOU LOST..", renderer)),
+    lossText2(std::make_unique<Text>(yume::vec2<int>{ 330, 335 }, 16, SDL_Color{ 0, 0, 0, 255 }, "press R to restart level..", renderer)),
+    audio(aud),
+    autopilot(std::make_unique<yume::Autopilot>(jobs, 256, 2.0f, seed)),
+    autopilotText(std::make_unique<Text>(yume::vec2<int>{ 5, 190 }, 24, SDL_Color{ 120, 255, 160, 255 }, "Autopilot: ", renderer)),
+    predictionText(std::make_unique<Text>(yume::vec2<int>{ 5, 215 }, 24, SDL_Color{ 255, 255, 255, 255 }, "Landing: ", renderer)),
+    rewindText(std::make_unique<Text>(yume::vec2<int>{ 5, 240 }, 24, SDL_Color{ 160, 200, 255, 255 }, "Rewind: ", renderer)),
+    telemetry(tel) {
+    rocket->setSpriteCache(sprites.get());
+    rocketBoosterAnim->setSpriteCache(sprites.get());
+    island->setSpriteCache(sprites.get());
+    airstrip->setSpriteCache(sprites.get());
+
+    compositor->addLayer(yume::LayerKind::Static, [this](SDL_Renderer* ren) {
+        background->render(ren);
+    }, SDL_Rect{ 0, 0, 800, 600 }, true);
+
+    compositor->addLayer(yume::LayerKind::Dynamic, [this](SDL_Renderer* ren) {
+        if (ghostVisible) {
+            renderGhost(ren);
+        }
+        if (!rocket->grounded && rocket->engine_enable && rocket->thrust >= 2.0f) {
+            rocketBoosterAnim->render(ren);
+        }
+        rocket->render(ren);
+    });
+
+    islandLayer = compositor->addLayer(yume::LayerKind::Static, [this](SDL_Renderer* ren) {
+        if (islandStage <= 9) {
+            island->render(ren);
+            airstrip->render(ren);
+        }
+    }, islandBounds());
+
+    rocketBoosterAnim->loadFrames(rocketBoosterAnimFiles, renderer);
+
+    wooshSound = audio->loadSound("res/audios/woosh.wav");
+    boosterSound = audio->loadSound("res/audios/booster.wav");
+    audio->setBoosterSound(boosterSound);
+
+    // optional, YUME_ATMOSPHERE=on, 1, true or yes turns it on. Serial because the rows are too short to pay for the jobs
+    const char* atmosphereEnv = SDL_getenv("YUME_ATMOSPHERE");
+    if (atmosphereEnv != nullptr && (std::string(atmosphereEnv) == "on" || std::string(atmosphereEnv) == "1"
+        || std::string(atmosphereEnv) == "true" || std::string(atmosphereEnv) == "yes")) {
+        atmosphere = std::make_unique<yume::WindField>(yume::wind_columns, yume::wind_rows, yume::wind_cell_size);
+    }
+
+    // a comma separated list of shake, haze, vignette and crt, or "all"
+    const char* postEnv = SDL_getenv("YUME_POSTFX");
+    if (postEnv != nullptr && std::string(postEnv) != "off") {
+        post = std::make_unique<yume::PostProcessor>(800, 600, renderer, jobs);
+        post->enableFromList(postEnv);
+        postText = std::make_unique<Text>(yume::vec2<int>{ 5, 265 }, 24, SDL_Color{ 255, 230, 160, 255 }, "Post: ", renderer);
+    }
+
+    const char* ghostEnv = SDL_getenv("YUME_GHOSTS");
+    ghostsEnabled = ghostEnv == nullptr || std::string(ghostEnv) != "off";
+    if (ghostsEnabled) {
+        std::error_code error;
+        std::filesystem::create_directories("ghosts", error);
+        // textures of their own, the alpha would otherwise fade the live rocket too
+        ghostTexture = renderManager.loadTexture("res/textures/rocket.png", renderer);
+        ghostFlameTexture = renderManager.loadTexture("res/textures/booster1.png", renderer);
+        for (SDL_Texture* texture : { ghostTexture, ghostFlameTexture }) {
+            if (texture != nullptr) {
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+                SDL_SetTextureAlphaMod(texture, 110);
+            }
+        }
+    }
+}
+
+SDL_Rect Game::islandBounds() const {
+    int left = (int)std::min(island->position.x, airstrip->position.x);
+    int top = (int)std::min(island->position.y, airstrip->position.y);
+    int right = (int)std::max(island->position.x + island->size.x, airstrip->position.x + airstrip->size.x);
+    int bottom = (int)std::max(island->position.y + island->size.y, airstrip->position.y + airstrip->size.y);
+    return SDL_Rect{ left, top, right - left, bottom - top };
+}
+
+yume::IslandState Game::islandState() const {
+    return yume::IslandState{ island->position, island->size, islandX2Left, islandX2Right, movingRight, islandStage, island->collisionShapes(rocket) };
+}
+
+void Game::refreshIslandLayer() {
+    if (islandStage >= 2 && islandStage <= 4) {
+        compositor->setKind(islandLayer, yume::LayerKind::Dynamic);
+    }
+    else {
+        compositor->setKind(islandLayer, yume::LayerKind::Static);
+    }
+    compositor->setBounds(islandLayer, islandBounds());
+    compositor->invalidate(islandLayer);
+}
+
+void Game::restartProgress() {
+    yume::GameSnapshot next = snapshot();
+
+    // upright and at rest over the launch spot, the engine ready
+    next.rocket = yume::RocketState{};
+    next.rocket.position = yume::vec2<float>{ 575, 410 };
+    next.rocket.size = rocket->size;
+    next.rocket.rotation = 90;
+    next.rocket.gravity = rocket->gravity;
+    next.rocket.is_stable = true;
+    next.rocket.engine_enable = true;
+
+    next.islandPosition = yume::vec2<float>{ static_cast<float>(dis_x(gen)), static_cast<float>(dis_y(gen)) };
+    next.airstripSize = island->size;
+    if (win) {
+        next.islandSize = yume::vec2<float>{ island->size.x - yume::island_shrink, island->size.y - yume::island_shrink };
+        next.winStreak += 1;
+        next.islandStage += 1;
+    }
+    if (lost) next.winStreak = 0;
+
+    next.islandLeftBound = next.islandPosition.x - 50.0f;
+    next.islandRightBound = next.islandPosition.x + 50.0f;
+
+    next.timer = 0.0f;
+    next.winTimer = 0.0f;
+    next.attractRestartTimer = 0.0f;
+    next.attempt += 1;
+    next.flags = 0;
+
+    // every attempt starts in still air
+    if (atmosphere) atmosphere->clear();
+    restoreSnapshot(next);
+    // a rewind stops at the start of the attempt, the per attempt state outside the snapshots stays valid
+    history.clear();
+    beginGhostRun();
+    statsRecorded = false;
+    statsStartTime = flightTime;
+    statsAutopilot = autopilotEnabled;
+}
+
+yume::GameSnapshot Game::snapshot() const {
+    std::uint32_t flags = 0;
+    if (movingRight) flags |= yume::snapshot_moving_right;
+    if (win) flags |= yume::snapshot_win;
+    if (winPredict) flags |= yume::snapshot_win_predict;
+    if (lost) flags |= yume::snapshot_lost;
+    if (engineNotification) flags |= yume::snapshot_engine_notification;
+
+    return yume::GameSnapshot{ rocket->state(), island->position, island->size, airstrip->size, islandX2Left, islandX2Right, islandStage,
+        timer, win_timer, restartTimer, attractRestartTimer, flightTime, winStreak, attempt, flags };
+}
+
+void Game::restoreSnapshot(const yume::GameSnapshot& snapshot) {
+    rocket->setState(snapshot.rocket);
+    rocketBoosterAnim->position = yume::vec2<float>{ rocket->position.x, rocket->position.y };
+
+    island->position = snapshot.islandPosition;
+    island->size = snapshot.islandSize;
+    airstrip->position = snapshot.islandPosition;
+    airstrip->size = snapshot.airstripSize;
+    islandX2Left = snapshot.islandLeftBound;
+    islandX2Right = snapshot.islandRightBound;
+    islandStage = snapshot.islandStage;
+
+    timer = snapshot.timer;
+    win_timer = snapshot.winTimer;
+    restartTimer = snapshot.restartTimer;
+    attractRestartTimer = snapshot.attractRestartTimer;
+    flightTime = snapshot.flightTime;
+    winStreak = snapshot.winStreak;
+    attempt = snapshot.attempt;
+
+    movingRight = (snapshot.flags & yume::snapshot_moving_right) != 0;
+    win = (snapshot.flags & yume::snapshot_win) != 0;
+    winPredict = (snapshot.flags & yume::snapshot_win_predict) != 0;
+    lost = (snapshot.flags & yume::snapshot_lost) != 0;
+    engineNotification = (snapshot.flags & yume::snapshot_engine_notification) != 0;
+
+    // both plan from the flight that just got replaced
+    autopilot->reset();
+    trajectory.reset();
+    refreshIslandLayer();
+}
+
+void Game::start() {
+    std::cout << "THE GAME SCENE HAS BEEN STARTED\n";
+    lastTime = manager->ticks();
+
+    if (manager->isAttractMode() && !attractFlying) {
+        attractSavedProgress = snapshot();
+        attractFlying = true;
+    }
+
+    autopilotEnabled = manager->isAttractMode();
+    autopilot->reset();
+    rewinding = false;
+}
+
+void Game::stop() {
+    audio->setThrust(0.0f);
+    audio->setEngine(false);
+
+    // the player comes back to a fresh attempt at their own stage and streak, a win they had not moved on from
+    // yet still counts
+    if (attractFlying) {
+        attractFlying = false;
+        restoreSnapshot(attractSavedProgress);
+        restartProgress();
+    }
+}
+
+void Game::handleEvents(SDL_Event& event) {
+    const Uint8* state = manager->keyboardState();
+    Uint32 mouse_state = SDL_GetMouseState(&mousePos.x, &mousePos.y);
+
+    if (event.type == SDL_QUIT) {
+        quitScene();
+    }
+
+    if (event.type == SDL_RENDER_TARGETS_RESET) {
+        compositor->invalidateAll();
+        sprites->clear();
+    }
+
+    if (manager->isAttractMode()) {
+        if (event.type == SDL_KEYDOWN) {
+            manager->setAttractMode(false);
+            manager->switchScene(0);
+        }
+        return;
+    }
+
+    if (state[SDL_SCANCODE_ESCAPE]) {
+        manager->switchScene(0);
+    }
+
+    rewinding = state[SDL_SCANCODE_BACKSPACE] != 0;
+
+    if (state[SDL_SCANCODE_R] && restartTimer == 1.0f) { // Restart scene
+        restartProgress();
+        restartTimer = 0.0f;
+    }
+
+    if (state[SDL_SCANCODE_W]) {
+        rocket->increaseThrust();
+    }
+    else if (state[SDL_SCANCODE_S]) {
+        rocket->decreaseThrust();
+    }
+    else if (state[SDL_SCANCODE_UP]) {
+        audio->play(wooshSound);
+        rocket->turnOnEngine();
+    }
+    else if (state[SDL_SCANCODE_DOWN]) {
+        audio->play(wooshSound);
+        rocket->turnOffEngine();
+    }
+
+    if (state[SDL_SCANCODE_A]) {
+        rocket->rotateLeft();
+    }
+    else if (state[SDL_SCANCODE_D]) {
+        rocket->rotateRight();
+    }
+
+    if (state[SDL_SCANCODE_W] && !rocket->engine_enable) {
+        engineNotification = true;
+    }
+    else {
+        engineNotification = false;
+    }
+
+    if (state[SDL_SCANCODE_U]) {
+        if (!keyPressedLastFrame) {
+            uiEnabled = !uiEnabled;
+        }
+        keyPressedLastFrame = true;
+    }
+    else {
+        keyPressedLastFrame = false;
+    }
+
+    if (state[SDL_SCANCODE_P]) {
+        if (!autopilotKeyLastFrame) {
+            autopilotEnabled = !autopilotEnabled;
+            autopilot->reset();
+        }
+        autopilotKeyLastFrame = true;
+    }
+    else {
+        autopilotKeyLastFrame = false;
+    }
+}
+
+void Game::flyAutopilot() {
+    if (!rocket->engine_enable) {
+        audio->play(wooshSound);
+        rocket->turnOnEngine();
+    }
+
+    yume::AutopilotInput input = autopilot->decide(rocket->state(), islandState());
+
+    if (input.thrust > 0) rocket->increaseThrust();
+    else if (input.thrust < 0) rocket->decreaseThrust();
+
+    if (input.rotate < 0) rocket->rotateLeft();
+    else if (input.rotate > 0) rocket->rotateRight();
+}
+
+void Game::update() {
+    resolution->beginFrame();
+
+    Uint32 currentTime = manager->ticks();
+    float deltaTime = (currentTime - lastTime) / 1000.0f;
+    lastTime = currentTime;
+
+    restartTimer += 1 * deltaTime;
+    if (restartTimer >= 1.0f) {
+        restartTimer = 1.0f;
+    }
+
+    if (rewinding) {
+        yume::GameSnapshot previous;
+        if (history.rewind(rewind_steps_per_frame, previous)) {
+            restoreSnapshot(previous);
+        }
+    }
+    else {
+        if (autopilotEnabled && !win && !lost) {
+            yume::AllocationScope scope(yume::AllocationSubsystem::Autopilot);
+            statsAutopilot = true;
+            flyAutopilot();
+        }
+
+        if (manager->isAttractMode() && (win || lost)) {
+            attractRestartTimer += deltaTime;
+            if (attractRestartTimer > 3.0f) {
+                restartProgress();
+            }
+        }
+
+        {
+            yume::AllocationScope scope(yume::AllocationSubsystem::Simulation);
+            updateAtmosphere(deltaTime);
+            rocket->update(deltaTime);
+            if (islandStage <= yume::final_stage) {
+                island->update(rocket);
+                airstrip->position = island->position;
+            }
+
+            yume::IslandState movedIsland = islandState();
+            yume::moveIsland(movedIsland, rocket->on_island, deltaTime);
+            island->position = movedIsland.position;
+            movingRight = movedIsland.movingRight;
+
+            trajectory.update(rocket->state(), islandState(), deltaTime);
+        }
+    }
+
+    yume::AllocationScope interfaceScope(yume::AllocationSubsystem::Interface);
+    yume::FrameArena& arena = manager->frameArena();
+
+    if (winPredict) {
+        if (!rewinding) {
+            win_timer += 1 * deltaTime;
+        }
+        winCounterText->updateText(yume::TextBuilder(arena, 32).append(4.0f - win_timer).view(), SDL_Color{ 0, 0, 0, 255 }, renderer);
+    }
+    else {
+        win_timer = 0.0f;
+    }
+
+    thrustText->updateText(yume::TextBuilder(arena, 48).append("Thrust: ").append(rocket->thrust).view(), SDL_Color{ 255, 255, 255, 255 }, renderer);
+    velocityText->updateText(yume::TextBuilder(arena, 48).append("Velocity: ").append(rocket->velocity.length()).view(), SDL_Color{ 255, 255, 255, 255 }, renderer);
+    if (rocket->getEngineState()) {
+        engineText->updateText("Engine: On", SDL_Color{ 255, 255, 255, 255 }, renderer);
+    }
+    else {
+        engineText->updateText("Engine: Off", SDL_Color{ 255, 0, 100, 255 }, renderer);
+    }
+    rotationText->updateText(yume::TextBuilder(arena, 48).append("Rotation: ").append(rocket->rotation).view(), SDL_Color{ 255, 255, 255, 255 }, renderer);
+    heightText->updateText(yume::TextBuilder(arena, 48).append("Height: ").append(std::abs(550 - rocket->position.y) - 14).view(), SDL_Color{ 255, 255, 255, 255 }, renderer);
+    winStreakText->updateText(yume::TextBuilder(arena, 32).append("Win Streak: ").append(winStreak).view(), SDL_Color{ 255, 200, 200, 255 }, renderer);
+    stageText->updateText(yume::TextBuilder(arena, 32).append("Stage: ").append(islandStage).view(), SDL_Color{ 255, 255, 255, 255 }, renderer);
+    updatePredictionText(arena);
+    if (rewinding) {
+        updateRewindText(arena);
+    }
+    if (autopilotEnabled) {
+        const yume::AutopilotStats& stats = autopilot->stats();
+        autopilotText->updateText(yume::TextBuilder(arena, 96).append("Autopilot: ").append(stats.rollouts).append(" rollouts, ").append(stats.decisionMs)
+            .append(" ms, ").append(static_cast<int>(stats.rolloutsPerSecond)).append("/s").view(), SDL_Color{ 120, 255, 160, 255 }, renderer);
+    }
+
+    float radianRotation = (rocket->rotation - 90) * (M_PI / 180.0f);
+
+    float boosterOffsetX = cos(radianRotation) * 0 - sin(radianRotation) * (rocket->size.y / 2.0f + rocketBoosterAnim->size.y / 2.0f - 42.0f);
+    float boosterOffsetY = sin(radianRotation) * 0 + cos(radianRotation) * (rocket->size.y / 2.0f + rocketBoosterAnim->size.y / 2.0f - 42.0f);
+
+    rocketBoosterAnim->position = yume::vec2<float>{ rocket->position.x + boosterOffsetX, rocket->position.y + boosterOffsetY };
+    rocketBoosterAnim->rotation = rocket->rotation;
+
+    rocketBoosterAnim->update(0.2f, deltaTime);
+
+    if (post) {
+        updatePostEffects(deltaTime, arena);
+    }
+
+    audio->setThrust(rocket->thrust);
+    audio->setEngine(rocket->getEngineState());
+
+    // a rewound frame is restored as it ended, the rules below already ran on it
+    if (rewinding) {
+        updateGhost();
+        return;
+    }
+
+    yume::RocketState rocketState = rocket->state();
+    yume::applyGroundHazards(rocketState);
+    rocket->is_stable = rocketState.is_stable;
+
+    if (win && !rocket->grounded) {
+        win = false;
+    }
+
+    if (rocket->grounded == true) {
+        if (yume::isSafeLanding(rocketState)) {
+            winPredict = true;
+
+            if (islandStage == 9) {
+                winText2->updateText("CONGRATULATIONS! You've completed the game! Now you can fly your rocket around without any target!", SDL_Color{ 0, 0, 0, 255 }, renderer);
+                winText2->position = yume::vec2<int>{ 10, 345 };
+            }
+        }
+        else {
+            winPredict = false;
+        }
+
+        if (yume::isSafeLanding(rocketState) && win_timer > yume::landing_hold_time) {
+            win = true;
+            lost = false;
+        }
+        else if (yume::isCrash(rocketState)) {
+            if (!lost && post) {
+                post->shake(8.0f, 0.6f);
+            }
+            lost = true;
+            win = false;
+        }
+    }
+    else {
+        winPredict = false;
+    }
+
+    if ((win || lost) && !statsRecorded) {
+        statsRecorded = true;
+        yume::AllocationScope scope(yume::AllocationSubsystem::Telemetry);
+        recordStats();
+    }
+
+    flightTime += deltaTime;
+    history.push(snapshot(), deltaTime);
+
+    {
+        yume::AllocationScope scope(yume::AllocationSubsystem::Telemetry);
+        updateGhost();
+    }
+
+    if (telemetry != nullptr) {
+        yume::AllocationScope scope(yume::AllocationSubsystem::Telemetry);
+        recordTelemetry(deltaTime);
+    }
+}
+
+void Game::updatePredictionText(yume::FrameArena& arena) {
+    yume::TextBuilder line(arena, 64);
+    line.append("Landing: ");
+
+    SDL_Color color{ 255, 255, 255, 255 };
+    switch (trajectory.verdict()) {
+    case yume::LandingVerdict::Safe:
+        line.append("safe at ").append(trajectory.impactSpeed(), 1);
+        color = SDL_Color{ 120, 255, 120, 255 };
+        break;
+    case yume::LandingVerdict::Crash:
+        line.append("crash at ").append(trajectory.impactSpeed(), 1);
+        color = SDL_Color{ 255, 90, 90, 255 };
+        break;
+    case yume::LandingVerdict::Missed:
+        line.append("misses the island");
+        color = SDL_Color{ 255, 220, 90, 255 };
+        break;
+    default:
+        line.append("-");
+        break;
+    }
+
+    predictionText->updateText(line.view(), color, renderer);
+}
+
+void Game::updateRewindText(yume::FrameArena& arena) {
+    rewindText->updateText(yume::TextBuilder(arena, 96).append("Rewind: ").append(history.seconds(), 1).append(" s left, ")
+        .append(history.bytesPerSecond() / 1024.0f, 2).append(" KB/s of ").append(static_cast<int>(history.memoryBytes() / 1024)).append(" KB").view(),
+        SDL_Color{ 160, 200, 255, 255 }, renderer);
+}
+
+void Game::updatePostEffects(float deltaTime, yume::FrameArena& arena) {
+    // the box around the flame sprite, the air above it shimmers as much as the plume below
+    yume::vec2<float> flame = rocketBoosterAnim->position + rocketBoosterAnim->size * 0.5f;
+    SDL_Rect heat{ (int)flame.x - 20, (int)flame.y - 16, 40, 72 };
+    bool boosterVisible = !rocket->grounded && rocket->engine_enable && rocket->thrust >= 2.0f;
+    post->setHeatSource(heat, boosterVisible ? rocket->thrust / yume::rocket_max_thrust : 0.0f);
+    post->update(deltaTime);
+
+    const yume::PostStats& stats = post->stats();
+    yume::TextBuilder line(arena, 128);
+    line.append("Post: ").append(stats.totalMs(), 2).append(" ms, read ").append(stats.readbackMs, 2);
+    for (int i = 0; i < static_cast<int>(yume::PostEffect::Count); i++) {
+        if (post->isEnabled(static_cast<yume::PostEffect>(i))) {
+            line.append(" ").append(yume::PostProcessor::effectName(static_cast<yume::PostEffect>(i))).append(" ").append(stats.effectMs[i], 2);
+        }
+    }
+    line.append(" upload ").append(stats.uploadMs, 2);
+    postText->updateText(line.view(), SDL_Color{ 255, 230, 160, 255 }, renderer);
+}
+
+void Game::renderTrajectory() {
+    int count = trajectory.size();
+    SDL_Point* points = manager->frameArena().allocateArray<SDL_Point>(count);
+    if (count < 2 || points == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const yume::TrajectorySample& sample = trajectory.sample(i);
+        points[i] = SDL_Point{ (int)(sample.position.x + rocket->size.x / 2.0f), (int)(sample.position.y + rocket->size.y / 2.0f) };
+    }
+
+    switch (trajectory.verdict()) {
+    case yume::LandingVerdict::Safe: SDL_SetRenderDrawColor(renderer, 120, 255, 120, 255); break;
+    case yume::LandingVerdict::Crash: SDL_SetRenderDrawColor(renderer, 255, 90, 90, 255); break;
+    case yume::LandingVerdict::Missed: SDL_SetRenderDrawColor(renderer, 255, 220, 90, 255); break;
+    default: SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); break;
+    }
+    SDL_RenderDrawLines(renderer, points, count);
+
+    if (trajectory.verdict() != yume::LandingVerdict::None) {
+        yume::vec2<float> impact = trajectory.impactPoint();
+        SDL_Rect marker = { (int)(impact.x + rocket->size.x / 2.0f) - 4, (int)(impact.y + rocket->size.y) - 4, 8, 8 };
+        SDL_RenderFillRect(renderer, &marker);
+    }
+}
+
+void Game::updateAtmosphere(float deltaTime) {
+    if (!atmosphere) {
+        return;
+    }
+
+    if (atmosphereStage != islandStage) {
+        atmosphere->setStage(islandStage);
+        atmosphereStage = islandStage;
+    }
+
+    yume::blowExhaust(*atmosphere, rocket->state(), deltaTime);
+    atmosphere->step(deltaTime);
+    rocket->wind = atmosphere->sample(rocket->position + rocket->size * 0.5f);
+}
+
+void Game::recordTelemetry(float deltaTime) {
+    Uint8 flags = 0;
+    if (rocket->grounded) flags |= yume::flight_grounded;
+    if (rocket->on_island) flags |= yume::flight_on_island;
+    if (rocket->is_stable) flags |= yume::flight_stable;
+    if (rocket->engine_enable) flags |= yume::flight_engine;
+
+    telemetry->record(yume::FlightSample{ telemetryStep++, attempt, flightTime, deltaTime,
+        rocket->position.x, rocket->position.y, rocket->velocity.x, rocket->velocity.y,
+        rocket->rotation, rocket->rotationalVelocity, rocket->thrust, flags, static_cast<Uint8>(islandStage) });
+}
+
+void Game::recordStats() {
+    yume::StatsStore* stats = manager->statsStore();
+    if (stats == nullptr || manager->isAttractMode()) {
+        return;
+    }
+
+    // previousVelocity is still the speed the rocket came down at, the ground zeroes velocity
+    yume::StatsRecord record{};
+    record.unixTime = static_cast<std::uint32_t>(std::time(nullptr));
+    record.attempt = attempt;
+    record.streak = static_cast<std::uint16_t>(win ? winStreak + 1 : 0);
+    record.kind = win ? yume::stats_landed : yume::stats_crashed;
+    record.stage = static_cast<std::uint8_t>(islandStage);
+    record.flags = statsAutopilot ? yume::stats_autopilot : 0;
+    record.flightSeconds = flightTime - statsStartTime;
+    record.landingSpeed = rocket->previousVelocity.length();
+    stats->append(record);
+}
+
+void Game::beginGhostRun() {
+    ghostRun.clear();
+    ghostStartTime = flightTime;
+    ghostRunCounts = !autopilotEnabled;
+    ghostRunSaved = false;
+}
+
+void Game::updateGhost() {
+    if (!ghostsEnabled) {
+        return;
+    }
+    float elapsed = flightTime - ghostStartTime;
+
+    if (rewinding) {
+        // restartProgress() clears the history so a rewind stops at the attempt's first frame, a snapshot from
+        // before it would leave a run shorter than the flight and it is never saved then
+        if (elapsed < 0.0f) {
+            ghostRunCounts = false;
+        }
+        ghostRun.truncate(elapsed);
+        ghostRunSaved = ghostRunSaved && win;
+    }
+    else {
+        if (autopilotEnabled) {
+            ghostRunCounts = false;
+        }
+        ghostRun.record(rocket->state(), elapsed);
+
+        // the time to a landing counts the hold on the pad too, the same for every run
+        if (win && !ghostRunSaved) {
+            ghostRunSaved = true;
+            bool faster = !ghost.isOpen() || ghostRun.duration() < ghost.duration();
+            if (ghostRunCounts && !ghostRun.full() && faster) {
+                char file[64];
+                std::snprintf(file, sizeof(file), "ghosts/stage_%d.ygh", islandStage);
+                std::size_t bytes = 0;
+                ghost.close();
+                if (ghostRun.save(file, islandStage, &bytes)) {
+                    std::cout << "NEW GHOST FOR STAGE " << islandStage << ": " << ghostRun.duration() << " s IN " << bytes << " BYTES\n";
+                }
+                ghostStage = -1;
+            }
+        }
+    }
+
+    // opened again when the stage changes or a new best replaced the file
+    if (ghostStage != islandStage) {
+        char file[64];
+        std::snprintf(file, sizeof(file), "ghosts/stage_%d.ygh", islandStage);
+        ghost.open(file);
+        ghostStage = islandStage;
+    }
+    ghostVisible = ghost.isOpen() && ghost.poseAt(elapsed, ghostPose);
+}
+
+void Game::renderGhost(SDL_Renderer* ren) {
+    // placed like the live rocket and its flame
+    if ((ghostPose.flags & yume::flight_engine) && !(ghostPose.flags & yume::flight_grounded) && ghostPose.thrust >= 2.0f) {
+        float radians = (ghostPose.rotation - 90) * (M_PI / 180.0f);
+        float offset = rocket->size.y / 2.0f + rocketBoosterAnim->size.y / 2.0f - 42.0f;
+        SDL_Rect flame = { (int)(ghostPose.position.x - std::sin(radians) * offset), (int)(ghostPose.position.y + std::cos(radians) * offset),
+            (int)rocketBoosterAnim->size.x, (int)rocketBoosterAnim->size.y };
+        SDL_RenderCopyEx(ren, ghostFlameTexture, nullptr, &flame, ghostPose.rotation - 90, nullptr, SDL_FLIP_NONE);
+    }
+
+    SDL_Rect body = { (int)ghostPose.position.x, (int)ghostPose.position.y, (int)rocket->size.x, (int)rocket->size.y };
+    SDL_RenderCopyEx(ren, ghostTexture, nullptr, &body, ghostPose.rotation - 90, nullptr, SDL_FLIP_NONE);
+}
+
+void Game::render() {
+    if (post) {
+        post->begin(renderer);
+    }
+
+    SDL_SetRenderDrawColor(renderer, 25, 10, 95, 255);
+    resolution->beginWorld(renderer);
+    compositor->render(renderer);
+    if (uiEnabled && !win && !lost) {
+        renderTrajectory();
+    }
+    resolution->endWorld(renderer);
+
+    if (uiEnabled) {
+        thrustText->render(renderer);
+        velocityText->render(renderer);
+        engineText->render(renderer);
+        rotationText->render(renderer);
+        heightText->render(renderer);
+        winStreakText->render(renderer);
+        stageText->render(renderer);
+        if (autopilotEnabled) {
+            autopilotText->render(renderer);
+        }
+        predictionText->render(renderer);
+        if (rewinding) {
+            rewindText->render(renderer);
+        }
+        if (post && post->active()) {
+            postText->render(renderer);
+        }
+    }
+
+    if (win && win_timer > 4.0f) {
+        winText->render(renderer);
+        winText2->render(renderer);
+        if (islandStage >= 9) {
+            winText3->render(renderer);
+        }
+    }
+
+    if (winPredict && win_timer < 4.0f) {
+        winCounterText->render(renderer);
+    }
+
+    if (lost) {
+        lossText->render(renderer);
+        lossText2->render(renderer);
+    }
+
+    if (engineNotification && !win && !lost) {
+        turnOnEngineText->render(renderer);
+    }
+
+    if (post) {
+        post->end(renderer);
+    }
+
+    resolution->endFrame(renderer);
+    SDL_RenderPresent(renderer);
+}
+
+Game::~Game() {
+    SDL_DestroyTexture(ghostTexture);
+    SDL_DestroyTexture(ghostFlameTexture);
+    delete rocket;
+    delete rocketBoosterAnim;
+}
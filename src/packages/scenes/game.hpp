@@ -0,0 +1,175 @@
+#ifndef YUME_GAME
+#define YUME_GAME
+
+#include "scene.hpp"
+#include "../render/compositor.hpp"
+#include "../render/resolution_scaler.hpp"
+#include "../render/post_process.hpp"
+#include "../render/sprite_cache.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../telemetry/ghost.hpp"
+#include "../jobs/job_system.hpp"
+#include "../simulation/autopilot.hpp"
+#include "../simulation/trajectory.hpp"
+#include "../simulation/snapshot.hpp"
+#include "../simulation/wind_field.hpp"
+
+class Game : public Scene {
+protected:
+    yume::vec2<int> mousePos{ yume::vec2<int>::ZERO() };
+    Uint32 lastTime{};
+
+    std::mt19937 gen;
+    std::uniform_int_distribution<> dis_x{ yume::island_spawn_left, yume::island_spawn_right };
+    std::uniform_int_distribution<> dis_y{ yume::island_spawn_top, yume::island_spawn_bottom };
+
+    // Game objects
+    Rocket* rocket;
+    Texture* rocketBoosterAnim;
+
+    const std::vector<std::string> rocketBoosterAnimFiles{ "res/textures/booster1.png", "res/textures/booster2.png", "res/textures/booster3.png" };
+    std::unique_ptr<Island> island;
+    std::unique_ptr<Texture> airstrip;
+    std::unique_ptr<Texture> background;
+
+    // Layers
+    std::unique_ptr<yume::Compositor> compositor;
+    std::unique_ptr<yume::ResolutionScaler> resolution;
+    std::unique_ptr<yume::SpriteCache> sprites;
+    int islandLayer{ -1 };
+
+    // CPU post effects, null unless YUME_POSTFX names some
+    std::unique_ptr<yume::PostProcessor> post;
+    std::unique_ptr<Text> postText;
+
+    // UI
+    std::unique_ptr<Text> thrustText;
+    std::unique_ptr<Text> velocityText;
+    std::unique_ptr<Text> engineText;
+    std::unique_ptr<Text> rotationText;
+    std::unique_ptr<Text> heightText;
+    std::unique_ptr<Text> winStreakText;
+    std::unique_ptr<Text> stageText;
+    std::unique_ptr<Text> turnOnEngineText;
+    std::unique_ptr<Text> winCounterText;
+    std::unique_ptr<Text> winText;
+    std::unique_ptr<Text> winText2;
+    std::unique_ptr<Text> winText3;
+    std::unique_ptr<Text> lossText;
+    std::unique_ptr<Text> lossText2;
+
+    // Audio
+    yume::AudioEngine* audio;
+    int wooshSound{ -1 };
+    int boosterSound{ -1 };
+
+    // Autopilot
+    std::unique_ptr<yume::Autopilot> autopilot;
+    std::unique_ptr<Text> autopilotText;
+    bool autopilotEnabled{ false };
+    bool autopilotKeyLastFrame{ false };
+    float attractRestartTimer{ 0.0f };
+    // attract mode flies this same game, the player's progress is put aside while it does and resumed after
+    bool attractFlying{ false };
+    yume::GameSnapshot attractSavedProgress{};
+
+    // Trajectory preview
+    yume::TrajectoryPredictor trajectory;
+    std::unique_ptr<Text> predictionText;
+
+    // Rewind, holding backspace steps back through the last 30 seconds of the current attempt
+    static constexpr int rewind_steps_per_frame = 2;
+    yume::SnapshotHistory history{ 30.0f, 1.0f / 240.0f };
+    std::unique_ptr<Text> rewindText;
+    bool rewinding{ false };
+
+    // Wind, null unless YUME_ATMOSPHERE is set to on, 1, true or yes. Not part of the snapshots, a rewound
+    // rocket keeps the wind it felt but the air carries on from where it is
+    std::unique_ptr<yume::WindField> atmosphere;
+    int atmosphereStage{ -1 };
+
+    // Ghost, the fastest landing on the current stage flies along translucently. Off when YUME_GHOSTS is "off"
+    bool ghostsEnabled{ true };
+    yume::GhostRecorder ghostRun;  // this attempt, kept in ghosts/ when it lands faster than the stage's ghost
+    float ghostStartTime{ 0.0f };   // flightTime when the attempt began
+    bool ghostRunCounts{ true };    // false once the autopilot flew any of it
+    bool ghostRunSaved{ false };
+    yume::GhostReader ghost;
+    int ghostStage{ -1 };
+    yume::GhostPose ghostPose{};
+    bool ghostVisible{ false };
+    yume::RenderManager renderManager;
+    SDL_Texture* ghostTexture{ nullptr };
+    SDL_Texture* ghostFlameTexture{ nullptr };
+
+    // Telemetry
+    yume::TelemetryRecorder* telemetry;
+    Uint32 telemetryStep{ 0 };
+    Uint32 attempt{ 0 };
+    float flightTime{ 0.0f };
+    // Session stats, the first landing or crash of an attempt is appended to the manager's store
+    bool statsRecorded{ false };
+    float statsStartTime{ 0.0f };  // flightTime when the attempt began
+    bool statsAutopilot{ false };  // the autopilot flew some of the attempt
+
+    // Other variables
+    int islandStage{ 0 };
+    float islandX2Right{};
+    float islandX2Left{};
+    bool movingRight{ false };
+    float timer{};
+    float win_timer{};
+    int winStreak{ 0 };
+    bool win{ false };
+    bool winPredict{ false };
+    bool lost{ false };
+    bool engineNotification{ false };
+    bool uiEnabled{ true };
+    bool keyPressedLastFrame{ false };
+    float restartTimer = 0.0f;
+
+public:
+    // the seed picks the island positions and the autopilot's candidates, the frame bench fixes it to replay a run
+    Game(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr, yume::AudioEngine* aud, yume::TelemetryRecorder* tel, yume::JobSystem* jobs, float targetFrameMs,
+        unsigned seed = std::random_device{}());
+
+    // airstrip->size is taken before the island shrinks on a win, so the layer has to cover both
+    SDL_Rect islandBounds() const;
+    yume::IslandState islandState() const;
+    // The island only needs redrawing when restartProgress() moves it, except for the stages where it oscillates every frame
+    void refreshIslandLayer();
+    // the next attempt is built as a whole snapshot, only the stage, streak and attempt count carry over
+    void restartProgress();
+
+    // every field update() carries from one frame to the next, restoring one puts the game exactly back there
+    yume::GameSnapshot snapshot() const;
+    void restoreSnapshot(const yume::GameSnapshot& snapshot);
+
+    virtual void start() override;
+    // the booster loop would keep playing in the menu
+    virtual void stop() override;
+    virtual void handleEvents(SDL_Event& event) override;
+    // The autopilot presses the same controls as the player, once per frame
+    void flyAutopilot();
+    virtual void update() override;
+    void updatePredictionText(yume::FrameArena& arena);
+    void updateRewindText(yume::FrameArena& arena);
+    // heat haze behind the booster and the cost of every pass on the last frame
+    void updatePostEffects(float deltaTime, yume::FrameArena& arena);
+    // The predicted arc from the rocket's center with a marker where it touches down
+    void renderTrajectory();
+    // steps the wind and hands the rocket the air speed at its center
+    void updateAtmosphere(float deltaTime);
+    void recordTelemetry(float deltaTime);
+    void recordStats();
+    // starts recording a new attempt, the stage's ghost starts over with it
+    void beginGhostRun();
+    // records this frame and keeps the attempt once it has landed faster than the stage's ghost
+    void updateGhost();
+    void renderGhost(SDL_Renderer* ren);
+    virtual void render() override;
+
+    ~Game();
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "menu.hpp"
+#include "split_screen.hpp"
+
+Menu::Menu(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr)
+    : Scene(rend, wind, mgr),
+    titleText(std::make_unique<Text>(yume::vec2<int>{ 150, 60 }, 50, SDL_Color{ 250, 250, 250, 255 }, "  The Rocket Program ", renderer)),
+    creatorText(std::make_unique<Text>(yume::vec2<int>{ 125, 545 }, 18, SDL_Color{ 255, 255, 255, 255 }, "The game is made by dazai. Credits: Background is made by Emilia", renderer)),
+    pressText(std::make_unique<Text>(yume::vec2<int>{ 125, 565 }, 18, SDL_Color{ 255, 255, 255, 255 }, "Select option by pressing space, switch options by pressing arrows.", renderer)),
+    startText(std::make_unique<Text>(yume::vec2<int>{ 360, 240 }, 32, SDL_Color{ 0, 0, 0, 255 }, "Start", renderer)),
+    quitText(std::make_unique<Text>(yume::vec2<int>{ 360, 300 }, 32, SDL_Color{ 0, 0, 0, 255 }, "Quit", renderer)),
+    htpText(std::make_unique<Text>(yume::vec2<int>{ 310, 360 }, 32, SDL_Color{ 0, 0, 0, 255 }, "How to play", renderer)),
+    splitText(std::make_unique<Text>(yume::vec2<int>{ 125, 525 }, 18, SDL_Color{ 255, 255, 255, 255 }, "Press 2, 3 or 4 for split screen with that many pilots.", renderer)),
+    statsText(std::make_unique<Text>(yume::vec2<int>{ 125, 505 }, 18, SDL_Color{ 255, 230, 150, 255 }, "Stats", renderer)),
+    background(std::make_unique<Texture>(yume::vec2<float>{ 0, 0 }, yume::vec2<float>{ 800, 600 }, "res/textures/background.png", renderer)),
+    howToPlay(std::make_unique<Texture>(yume::vec2<float>{ 0, 0 }, yume::vec2<float>{ 800, 600 }, "res/textures/howtoplay.png", renderer)),
+    compositor(std::make_unique<yume::Compositor>(800, 600, renderer)) {
+    compositor->addLayer(yume::LayerKind::Static, [this](SDL_Renderer* ren) { background->render(ren); }, SDL_Rect{ 0, 0, 800, 600 }, true);
+}
+
+void Menu::start() {
+    std::cout << "THE MENU SCENE HAS BEEN STARTED\n";
+    selectedOptionIndex = 0;
+    lastInputTime = manager->ticks();
+    updateStatsText();
+}
+
+void Menu::updateStatsText() {
+    yume::StatsStore* stats = manager->statsStore();
+    statsVisible = stats != nullptr && stats->summary().records > 0;
+    if (!statsVisible) {
+        return;
+    }
+
+    const yume::StatsSummary& summary = stats->summary();
+    const yume::StatsSummary::Stage& stage = summary.stage(summary.lastStage);
+    yume::TextBuilder line(manager->frameArena(), 128);
+    line.append("Best streak ").append(static_cast<int>(summary.bestStreak)).append(", stage ").append(summary.lastStage).append(": ")
+        .append(static_cast<int>(stage.landings)).append(" of ").append(static_cast<int>(stage.attempts)).append(" landed");
+    if (stage.landings > 0) {
+        line.append(" at ").append(stage.averageLandingSpeed(), 1).append(" on average");
+    }
+    statsText->updateText(line.view(), SDL_Color{ 255, 230, 150, 255 }, renderer);
+}
+
+void Menu::handleEvents(SDL_Event& event) {
+    const Uint8* state = manager->keyboardState();
+
+    if (event.type == SDL_QUIT || state[SDL_SCANCODE_ESCAPE]) {
+        quitScene();
+    }
+
+    if (event.type == SDL_RENDER_TARGETS_RESET) {
+        compositor->invalidateAll();
+    }
+
+    if (event.type == SDL_KEYDOWN) {
+        lastInputTime = manager->ticks();
+    }
+
+    if (state[SDL_SCANCODE_RETURN] && howToPlayVisible) {
+        howToPlayVisible = false;
+    }
+
+    if (state[SDL_SCANCODE_SPACE]) {
+        if (selectedOptionIndex == 0) {
+            manager->setAttractMode(false);
+            manager->switchScene(1);
+        }
+        else if (selectedOptionIndex == 1) {
+            manager->quitProgram();
+        }
+        else if (selectedOptionIndex == 2) {
+            howToPlayVisible = true;
+        }
+    }
+
+    // the split screen scene is built after the first frame, it is not there for the first few keys
+    SplitScreen* splitScreen = dynamic_cast<SplitScreen*>(manager->getScene(2));
+    for (int pilots : { 2, 3, 4 }) {
+        if (state[SDL_SCANCODE_1 + pilots - 1] && splitScreen != nullptr && !howToPlayVisible) {
+            splitScreen->setPilotCount(pilots);
+            manager->setAttractMode(false);
+            manager->switchScene(2);
+            return;
+        }
+    }
+
+    if (state[SDL_SCANCODE_UP] && selectedOptionIndex == 1) {
+        selectedOptionIndex = 0;
+    }
+    else if (state[SDL_SCANCODE_DOWN] && selectedOptionIndex == 0) {
+        selectedOptionIndex = 1;
+    }
+    else if (state[SDL_SCANCODE_DOWN] && selectedOptionIndex == 1) {
+        selectedOptionIndex = 2;
+    }
+    if (state[SDL_SCANCODE_UP] && selectedOptionIndex == 2) {
+        selectedOptionIndex = 1;
+    }
+}
+
+void Menu::update() {
+    if (!howToPlayVisible && manager->ticks() - lastInputTime > 20000) {
+        manager->setAttractMode(true);
+        manager->switchScene(1);
+        return;
+    }
+
+    if (selectedOptionIndex == 0) {
+        startText->updateText("> Start", { 0, 0, 0, 255 }, renderer);
+        quitText->updateText("Quit", { 0, 0, 0, 255 }, renderer);
+        htpText->updateText("How to play", { 0, 0, 0, 255 }, renderer);
+    }
+    else if (selectedOptionIndex == 1) {
+        quitText->updateText("> Quit", { 0, 0, 0, 255 }, renderer);
+        startText->updateText("Start", { 0, 0, 0, 255 }, renderer);
+        htpText->updateText("How to play", { 0, 0, 0, 255 }, renderer);
+    }
+    else if (selectedOptionIndex == 2) {
+        quitText->updateText("Quit", { 0, 0, 0, 255 }, renderer);
+        startText->updateText("Start", { 0, 0, 0, 255 }, renderer);
+        htpText->updateText("> How to play", { 0, 0, 0, 255 }, renderer);
+    }
+}
+
+void Menu::render() {
+    SDL_SetRenderDrawColor(renderer, 15, 90, 45, 255);
+    compositor->render(renderer);
+
+    pressText->render(renderer);
+    startText->render(renderer);
+    quitText->render(renderer);
+    htpText->render(renderer);
+    creatorText->render(renderer);
+    splitText->render(renderer);
+    if (statsVisible) statsText->render(renderer);
+    titleText->render(renderer);
+
+    if (howToPlayVisible == true) howToPlay->render(renderer);
+
+    SDL_RenderPresent(renderer);
+}
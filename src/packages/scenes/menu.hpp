@@ -0,0 +1,41 @@
+#ifndef YUME_MENU
+#define YUME_MENU
+
+#include "scene.hpp"
+#include "../render/compositor.hpp"
+
+class Menu : public Scene {
+protected:
+    // UI Elements
+    std::unique_ptr<Text> titleText;
+    std::unique_ptr<Text> creatorText;
+    std::unique_ptr<Text> pressText;
+    std::unique_ptr<Text> startText;
+    std::unique_ptr<Text> quitText;
+    std::unique_ptr<Text> htpText;
+    std::unique_ptr<Text> splitText;
+    std::unique_ptr<Text> statsText;
+    std::unique_ptr<Texture> background;
+    std::unique_ptr<Texture> howToPlay;
+    std::unique_ptr<yume::Compositor> compositor;
+
+    // State Management
+    int selectedOptionIndex{ 0 };
+    bool howToPlayVisible{ false };
+    bool statsVisible{ false };  // once the stats store has a record
+    Uint32 lastInputTime{};
+
+public:
+    Menu(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr);
+
+    virtual void start() override;
+    // the totals of every session so far, refreshed whenever the menu comes back
+    void updateStatsText();
+    virtual void handleEvents(SDL_Event& event) override;
+    virtual void update() override;
+    virtual void render() override;
+
+    ~Menu() = default;
+};
+
+#endif
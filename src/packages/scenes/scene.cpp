@@ -0,0 +1,155 @@
+#include "scene.hpp"
+#include "../core/allocation_tracker.hpp"
+#include "../core/startup_trace.hpp"
+
+#include <cassert>
+#include <chrono>
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    float millisecondsSince(clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(clock::now() - start).count();
+    }
+}
+
+SceneManager::SceneManager(SDL_Renderer* rend, SDL_Window* win, yume::AudioEngine* aud)
+    : renderer(rend), window(win), currentSceneIndex(0), quit(false), audio(aud),
+    assertNoAllocations(SDL_getenv("YUME_ASSERT_NO_ALLOC") != nullptr) {}
+
+void SceneManager::switchScene(int index) {
+    if (index >= 0 && index < scenes.size()) {
+        scenes[currentSceneIndex]->stop();
+        currentSceneIndex = index;
+        scenes[currentSceneIndex]->start();
+        allocationWarmupEnd = yume::AllocationTracker::frames() + allocation_warmup_frames;
+    }
+}
+
+void SceneManager::setStartupDone(std::function<void()> callback) {
+    startupDone = std::move(callback);
+}
+
+void SceneManager::run() {
+    if (!scenes.empty()) {
+        yume::AllocationTracker::trackThisThread();
+        scenes[currentSceneIndex]->start();
+
+        if (isRunning()) {
+            step();
+            yume::StartupTrace::mark("first scene frame");
+        }
+
+        if (!pendingScenes.empty()) {
+            yume::StartupPhase phase("deferred scenes");
+            for (std::function<void()>& build : pendingScenes) {
+                build();
+            }
+            pendingScenes.clear();
+        }
+        if (startupDone) {
+            startupDone();
+        }
+
+        while (isRunning()) {
+            step();
+        }
+    }
+}
+
+void SceneManager::step() {
+    clock::time_point start = clock::now();
+    {
+        yume::AllocationScope scope(yume::AllocationSubsystem::Events);
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                quitProgram();
+            }
+            scenes[currentSceneIndex]->handleEvents(event);
+        }
+    }
+    timings.eventsMs = millisecondsSince(start);
+
+    start = clock::now();
+    {
+        yume::AllocationScope scope(yume::AllocationSubsystem::Audio);
+        audio->update();
+    }
+    timings.audioMs = millisecondsSince(start);
+
+    start = clock::now();
+    scenes[currentSceneIndex]->update();
+    timings.updateMs = millisecondsSince(start);
+
+    start = clock::now();
+    {
+        yume::AllocationScope scope(yume::AllocationSubsystem::Render);
+        scenes[currentSceneIndex]->render();
+    }
+    timings.renderMs = millisecondsSince(start);
+
+    endFrame();
+}
+
+void SceneManager::endFrame() {
+    arena.reset();
+    yume::AllocationTracker::endFrame();
+
+    if (yume::AllocationTracker::enabled() && !yume::AllocationTracker::checkSteadyState(allocationWarmupEnd)) {
+        assert(!assertNoAllocations && "heap allocation in a steady state frame");
+    }
+}
+
+bool SceneManager::isRunning() const {
+    return !quit && !scenes.empty() && !scenes[currentSceneIndex]->isQuit();
+}
+
+const FrameTimings& SceneManager::lastTimings() const {
+    return timings;
+}
+
+void SceneManager::setInputOverride(const Uint8* keyboard, const Uint32* ticks) {
+    keyboardOverride = keyboard;
+    ticksOverride = ticks;
+}
+
+const Uint8* SceneManager::keyboardState() const {
+    return keyboardOverride != nullptr ? keyboardOverride : SDL_GetKeyboardState(NULL);
+}
+
+Uint32 SceneManager::ticks() const {
+    return ticksOverride != nullptr ? *ticksOverride : SDL_GetTicks();
+}
+
+yume::FrameArena& SceneManager::frameArena() {
+    return arena;
+}
+
+void SceneManager::quitProgram() {
+    quit = true;
+}
+
+int SceneManager::getCurrentSceneIndex() {
+    return currentSceneIndex;
+}
+
+Scene* SceneManager::getScene(int index) {
+    return index >= 0 && index < scenes.size() ? scenes[index].get() : nullptr;
+}
+
+void SceneManager::setAttractMode(bool enabled) {
+    attractMode = enabled;
+}
+
+bool SceneManager::isAttractMode() const {
+    return attractMode;
+}
+
+void SceneManager::setStatsStore(yume::StatsStore* store) {
+    stats = store;
+}
+
+yume::StatsStore* SceneManager::statsStore() const {
+    return stats;
+}
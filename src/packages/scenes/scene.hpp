@@ -0,0 +1,126 @@
+#ifndef YUME_SCENE
+#define YUME_SCENE
+
+#include "../../config.hpp"
+#include "../audio/audio_engine.hpp"
+#include "../core/frame_arena.hpp"
+#include "../telemetry/stats_store.hpp"
+
+class SceneManager;
+
+class Scene {
+protected:
+    SDL_Renderer* renderer;
+    SDL_Window* window;
+    bool quit;
+    SceneManager* manager;
+
+public:
+    Scene(SDL_Renderer* rend, SDL_Window* win, SceneManager* mgr)
+        : renderer(rend), window(win), quit(false), manager(mgr) {}
+
+    virtual void start() {}
+    // called when the manager switches to another scene, after the last update() and render() of this one
+    virtual void stop() {}
+    virtual void handleEvents(SDL_Event& event) {}
+    virtual void update() {}
+    virtual void render() {}
+
+    virtual bool isQuit() const {
+        return quit;
+    }
+
+    void quitScene() {
+        quit = true;
+    }
+
+    virtual ~Scene() {
+
+    }
+};
+
+// wall time of each part of the last frame
+struct FrameTimings {
+    float eventsMs{ 0.0f };
+    float audioMs{ 0.0f };
+    float updateMs{ 0.0f };
+    float renderMs{ 0.0f };
+};
+
+class SceneManager {
+private:
+    SDL_Renderer* renderer;
+    SDL_Window* window;
+    std::vector<std::unique_ptr<Scene>> scenes;
+    // built by run() after the first frame, in the order they were added
+    std::vector<std::function<void()>> pendingScenes;
+    std::function<void()> startupDone;
+    int currentSceneIndex;
+    bool quit;
+    bool attractMode{ false };
+    yume::AudioEngine* audio;
+    yume::StatsStore* stats{ nullptr };
+
+    // per-frame scratch memory, reset after every present
+    yume::FrameArena arena{ 64 * 1024 };
+    // frames allowed to allocate after a scene switch before the steady state check kicks in
+    static constexpr std::uint64_t allocation_warmup_frames = 120;
+    std::uint64_t allocationWarmupEnd{ allocation_warmup_frames };
+    bool assertNoAllocations{ false };
+
+    FrameTimings timings;
+
+    // scripted input, null reads the real keyboard and clock
+    const Uint8* keyboardOverride{ nullptr };
+    const Uint32* ticksOverride{ nullptr };
+
+public:
+    SceneManager(SDL_Renderer* rend, SDL_Window* win, yume::AudioEngine* aud);
+
+    template<typename T, typename... Args>
+    void addScene(Args&&... args) {
+        scenes.push_back(std::make_unique<T>(renderer, window, this, std::forward<Args>(args)...));
+    }
+
+    // Constructed by run() once the first frame of the first scene is on screen, so a window shows up before
+    // the heavy scenes load. They keep the index they would have had with addScene().
+    template<typename T, typename... Args>
+    void addSceneAfterFirstFrame(Args... args) {
+        pendingScenes.push_back([this, args...]() {
+            scenes.push_back(std::make_unique<T>(renderer, window, this, args...));
+        });
+    }
+
+    // called by run() after the deferred scenes are built
+    void setStartupDone(std::function<void()> callback);
+
+    void switchScene(int index);
+    void run();
+
+    // one frame: events, audio, update and render of the current scene, run() loops this until quit
+    void step();
+    void endFrame();
+    bool isRunning() const;
+    const FrameTimings& lastTimings() const;
+
+    // the frame bench replaces the keyboard state and SDL_GetTicks() with its own, both have to outlive the override
+    void setInputOverride(const Uint8* keyboard, const Uint32* ticks);
+    const Uint8* keyboardState() const;
+    Uint32 ticks() const;
+
+    yume::FrameArena& frameArena();
+
+    void quitProgram();
+    int getCurrentSceneIndex();
+    Scene* getScene(int index);
+
+    // the menu starts the game in attract mode after idling, the autopilot flies until a key is pressed
+    void setAttractMode(bool enabled);
+    bool isAttractMode() const;
+
+    // the session statistics, null when they are off. The game appends every attempt, the menu shows the totals
+    void setStatsStore(yume::StatsStore* store);
+    yume::StatsStore* statsStore() const;
+};
+
+#endif
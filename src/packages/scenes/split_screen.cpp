@@ -0,0 +1,486 @@
+#include "split_screen.hpp"
+
+namespace {
+    constexpr int world_width = 800;
+    constexpr int world_height = 600;
+    constexpr float camera_follow = 6.0f;  // share of the way to the rocket the camera covers per second
+    constexpr Sint16 stick_dead_zone = 8000;
+    constexpr Sint16 trigger_threshold = 8000;
+    constexpr int max_catch_up_ticks = 4;  // after a hitch netplay steps at most this many ticks in one frame
+
+    const char* const pilot_labels[SplitScreen::max_pilots] = { "P1", "P2", "P3", "P4" };
+    const SDL_Color pilot_colors[SplitScreen::max_pilots] = {
+        { 255, 120, 120, 255 }, { 120, 200, 255, 255 }, { 140, 255, 140, 255 }, { 255, 220, 100, 255 },
+    };
+
+    // player,localport,host,peerport[,seed] with player 1 or 2
+    bool parseNetplay(const char* env, std::string& host, int& player, int& localPort, int& peerPort, std::uint32_t& seed) {
+        std::vector<std::string> fields;
+        std::string text(env);
+        std::size_t begin = 0;
+        for (;;) {
+            std::size_t comma = text.find(',', begin);
+            fields.push_back(text.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin));
+            if (comma == std::string::npos) {
+                break;
+            }
+            begin = comma + 1;
+        }
+        if (fields.size() < 4) {
+            return false;
+        }
+
+        player = std::atoi(fields[0].c_str());
+        localPort = std::atoi(fields[1].c_str());
+        host = fields[2];
+        peerPort = std::atoi(fields[3].c_str());
+        if (fields.size() > 4) {
+            seed = static_cast<std::uint32_t>(std::strtoul(fields[4].c_str(), nullptr, 10));
+        }
+        return (player == 1 || player == 2) && localPort > 0 && localPort < 65536 && peerPort > 0 && peerPort < 65536 && !host.empty();
+    }
+}
+
+SplitScreen::SplitScreen(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr, yume::AudioEngine* aud, unsigned seed)
+    : Scene(rend, wind, mgr),
+    gen(seed),
+    island(std::make_unique<Island>(yume::vec2<float>{ 200, 320 }, yume::islandSizeAtStage(0), renderer)),
+    airstrip(std::make_unique<Texture>(yume::vec2<float>{ 200, 320 }, yume::islandSizeAtStage(0), "res/textures/airstrip.png", renderer)),
+    background(std::make_unique<Texture>(yume::vec2<float>{ 0, 0 }, yume::vec2<float>{ 800, 600 }, "res/textures/background.png", renderer)),
+    compositor(std::make_unique<yume::Compositor>(world_width, world_height, renderer)),
+    sprites(std::make_unique<yume::SpriteCache>(renderer)),
+    glyphs(std::make_unique<yume::GlyphAtlas>(yume::AssetCache::font("res/fonts/IBMPlexSans-Medium.ttf", 18), renderer)),
+    batch(glyphs.get(), sprites.get()),
+    audio(aud) {
+    rocketTexture = renderManager.loadTexture("res/textures/rocket.png", renderer);
+    rocketMasks = yume::RotatedMaskSet(renderManager.loadAlpha("res/textures/rocket.png"), 32, 64, 2.0f);
+    for (const char* file : { "res/textures/booster1.png", "res/textures/booster2.png", "res/textures/booster3.png" }) {
+        boosterFrames.push_back(renderManager.loadTexture(file, renderer));
+    }
+    island->setSpriteCache(sprites.get());
+    airstrip->setSpriteCache(sprites.get());
+
+    // the island's size only follows the stage, one mask per stage covers every state the race can be in
+    yume::AlphaImage islandAlpha = renderManager.loadAlpha("res/textures/island.png");
+    if (!islandAlpha.alpha.empty()) {
+        shapes.rocket = &rocketMasks;
+        for (int stage = 0; stage <= yume::final_stage; stage++) {
+            yume::vec2<float> size = yume::islandSizeAtStage(stage);
+            shapes.island[stage] = yume::CollisionMask::fromAlpha(islandAlpha, (int)size.x, (int)size.y);
+        }
+    }
+
+    compositor->addLayer(yume::LayerKind::Static, [this](SDL_Renderer* ren) {
+        background->render(ren);
+    }, SDL_Rect{ 0, 0, world_width, world_height }, true);
+
+    islandLayer = compositor->addLayer(yume::LayerKind::Static, [this](SDL_Renderer* ren) {
+        island->render(ren);
+        airstrip->render(ren);
+    }, islandBounds());
+
+    for (int i = 0; i < max_pilots; i++) {
+        pilots[i].color = pilot_colors[i];
+    }
+
+    controllersReady = SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) == 0;
+    if (!controllersReady) {
+        std::cout << "SDL_InitSubSystem Error: " << SDL_GetError() << ", split screen is keyboard only\n";
+    }
+
+    if (const char* env = SDL_getenv("YUME_NETPLAY")) {
+        int player = 0;
+        int localPort = 0;
+        int peerPort = 0;
+        if (parseNetplay(env, netplay.host, player, localPort, peerPort, netplay.seed)) {
+            netplay.enabled = true;
+            netplay.player = player - 1;
+            netplay.localPort = static_cast<Uint16>(localPort);
+            netplay.peerPort = static_cast<Uint16>(peerPort);
+        }
+        else {
+            std::cout << "YUME_NETPLAY should be player,localport,host,peerport[,seed] with player 1 or 2, split screen stays local\n";
+        }
+    }
+}
+
+void SplitScreen::setPilotCount(int count) {
+    pilotCount = std::clamp(count, 2, max_pilots);
+}
+
+int SplitScreen::getPilotCount() const {
+    return pilotCount;
+}
+
+SDL_Rect SplitScreen::islandBounds() const {
+    int left = (int)std::min(island->position.x, airstrip->position.x);
+    int top = (int)std::min(island->position.y, airstrip->position.y);
+    int right = (int)std::max(island->position.x + island->size.x, airstrip->position.x + airstrip->size.x);
+    int bottom = (int)std::max(island->position.y + island->size.y, airstrip->position.y + airstrip->size.y);
+    return SDL_Rect{ left, top, right - left, bottom - top };
+}
+
+void SplitScreen::refreshIslandLayer() {
+    if (yume::islandOscillates(shownRace().islandStage)) {
+        compositor->setKind(islandLayer, yume::LayerKind::Dynamic);
+    }
+    else {
+        compositor->setKind(islandLayer, yume::LayerKind::Static);
+    }
+    compositor->setBounds(islandLayer, islandBounds());
+    compositor->invalidate(islandLayer);
+}
+
+void SplitScreen::syncIsland() {
+    const yume::VersusState& shown = shownRace();
+    island->position = shown.islandPosition;
+    island->size = shown.islandSize;
+    airstrip->position = island->position;
+    airstrip->size = island->size;
+
+    // a rollback can also take a placement back, either way the layer shows the wrong spot
+    if (shown.placements != shownPlacements || shown.islandStage != shownStage) {
+        shownPlacements = shown.placements;
+        shownStage = shown.islandStage;
+        refreshIslandLayer();
+    }
+}
+
+const yume::VersusState& SplitScreen::shownRace() const {
+    return session != nullptr ? session->state() : race;
+}
+
+SDL_Rect SplitScreen::paneRect(int pilot) const {
+    if (pilotCount == 2) {
+        return SDL_Rect{ pilot * world_width / 2, 0, world_width / 2, world_height };
+    }
+    return SDL_Rect{ (pilot % 2) * world_width / 2, (pilot / 2) * world_height / 2, world_width / 2, world_height / 2 };
+}
+
+SDL_Rect SplitScreen::paneView(int pilot) const {
+    SDL_Rect pane = paneRect(pilot);
+    const yume::vec2<float>& camera = pilots[pilot].camera;
+    int x = std::clamp(static_cast<int>(camera.x) - pane.w / 2, 0, world_width - pane.w);
+    int y = std::clamp(static_cast<int>(camera.y) - pane.h / 2, 0, world_height - pane.h);
+    return SDL_Rect{ x, y, pane.w, pane.h };
+}
+
+void SplitScreen::start() {
+    lastTime = manager->ticks();
+    tickAccumulator = 0.0f;
+    session.reset();
+    socket.reset();
+
+    if (!netplay.enabled || !startNetplay()) {
+        race = yume::startVersus(pilotCount, static_cast<std::uint32_t>(gen()));
+    }
+    std::cout << "THE SPLIT SCREEN SCENE HAS BEEN STARTED WITH " << pilotCount << " PILOTS\n";
+
+    syncIsland();
+    refreshIslandLayer();
+
+    const yume::VersusState& shown = shownRace();
+    for (int i = 0; i < max_pilots; i++) {
+        const yume::RocketState& rocket = shown.pilots[i].rocket;
+        pilots[i].camera = rocket.position + rocket.size * 0.5f;
+    }
+
+    openControllers();
+}
+
+bool SplitScreen::startNetplay() {
+    socket = std::make_unique<yume::UdpSocket>();
+    if (!socket->open(netplay.localPort) || !socket->setPeer(netplay.host.c_str(), netplay.peerPort)) {
+        std::cout << "Netplay could not start, split screen stays local\n";
+        socket.reset();
+        return false;
+    }
+
+    // both sides start from the same seed and only exchange inputs from here on
+    pilotCount = 2;
+    session = std::make_unique<yume::RollbackSession>(*socket, netplay.player, yume::startVersus(2, netplay.seed), &shapes);
+    std::cout << "NETPLAY AS " << pilot_labels[netplay.player] << " ON PORT " << socket->localPort() << " WITH "
+        << netplay.host << ":" << netplay.peerPort << '\n';
+    return true;
+}
+
+void SplitScreen::stop() {
+    audio->setThrust(0.0f);
+    audio->setEngine(false);
+}
+
+void SplitScreen::handleEvents(SDL_Event& event) {
+    const Uint8* state = manager->keyboardState();
+
+    if (event.type == SDL_QUIT) {
+        quitScene();
+    }
+
+    if (event.type == SDL_RENDER_TARGETS_RESET) {
+        compositor->invalidateAll();
+        sprites->clear();
+    }
+
+    if (event.type == SDL_CONTROLLERDEVICEADDED) {
+        openControllers();
+    }
+    else if (event.type == SDL_CONTROLLERDEVICEREMOVED) {
+        for (auto it = controllers.begin(); it != controllers.end(); ++it) {
+            if (SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(*it)) == event.cdevice.which) {
+                SDL_GameControllerClose(*it);
+                controllers.erase(it);
+                break;
+            }
+        }
+        assignControllers();
+    }
+
+    if (state[SDL_SCANCODE_ESCAPE]) {
+        manager->switchScene(0);
+    }
+}
+
+void SplitScreen::openControllers() {
+    if (!controllersReady) {
+        return;
+    }
+    for (int device = 0; device < SDL_NumJoysticks(); device++) {
+        if (!SDL_IsGameController(device)) {
+            continue;
+        }
+
+        SDL_JoystickID id = SDL_JoystickGetDeviceInstanceID(device);
+        bool open = std::any_of(controllers.begin(), controllers.end(), [id](SDL_GameController* controller) {
+            return SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller)) == id;
+        });
+        if (open) {
+            continue;
+        }
+
+        SDL_GameController* controller = SDL_GameControllerOpen(device);
+        if (controller == nullptr) {
+            std::cout << "SDL_GameControllerOpen Error: " << SDL_GetError() << '\n';
+            continue;
+        }
+        controllers.push_back(controller);
+    }
+    assignControllers();
+}
+
+void SplitScreen::assignControllers() {
+    for (int i = 0; i < max_pilots; i++) {
+        pilots[i].controller = i < static_cast<int>(controllers.size()) ? controllers[i] : nullptr;
+    }
+}
+
+yume::VersusInput SplitScreen::readInput(int pilot, const Uint8* state) const {
+    const KeySet& keys = key_sets[pilot];
+    bool thrustUp = state[keys.thrustUp] != 0;
+    bool thrustDown = state[keys.thrustDown] != 0;
+    bool left = state[keys.rotateLeft] != 0;
+    bool right = state[keys.rotateRight] != 0;
+
+    SDL_GameController* controller = pilots[pilot].controller;
+    if (controller != nullptr) {
+        Sint16 stick = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_LEFTX);
+        thrustUp = thrustUp || SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_TRIGGERRIGHT) > trigger_threshold
+            || SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_A);
+        thrustDown = thrustDown || SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_TRIGGERLEFT) > trigger_threshold
+            || SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_B);
+        left = left || stick < -stick_dead_zone || SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_DPAD_LEFT);
+        right = right || stick > stick_dead_zone || SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_DPAD_RIGHT);
+    }
+
+    yume::VersusInput input = 0;
+    if (thrustUp) {
+        input |= yume::versus_thrust_up;
+    }
+    if (thrustDown) {
+        input |= yume::versus_thrust_down;
+    }
+    if (left) {
+        input |= yume::versus_rotate_left;
+    }
+    if (right) {
+        input |= yume::versus_rotate_right;
+    }
+    return input;
+}
+
+void SplitScreen::updateNetplay(float deltaTime) {
+    // the session steps in fixed ticks so both machines run the same steps whatever their frame rates
+    const float tickTime = yume::RollbackSettings{}.tickTime;
+    double nowMs = manager->ticks();
+    tickAccumulator = std::min(tickAccumulator + deltaTime, tickTime * max_catch_up_ticks);
+
+    // the local pilot flies with the first key set and the first controller, whichever side of the race they are
+    yume::VersusInput input = readInput(0, manager->keyboardState());
+    bool stepped = false;
+    while (tickAccumulator >= tickTime) {
+        tickAccumulator -= tickTime;
+        session->advance(input, nowMs);
+        stepped = true;
+    }
+    if (!stepped) {
+        session->poll(nowMs);
+    }
+}
+
+void SplitScreen::update() {
+    Uint32 currentTime = manager->ticks();
+    float deltaTime = (currentTime - lastTime) / 1000.0f;
+    lastTime = currentTime;
+
+    if (session != nullptr) {
+        updateNetplay(deltaTime);
+    }
+    else {
+        const Uint8* state = manager->keyboardState();
+        yume::VersusInput inputs[max_pilots] = {};
+        for (int i = 0; i < pilotCount; i++) {
+            inputs[i] = readInput(i, state);
+        }
+        yume::stepVersus(race, inputs, deltaTime, &shapes);
+    }
+    syncIsland();
+
+    const yume::VersusState& shown = shownRace();
+    float loudest = 0.0f;
+    for (int i = 0; i < pilotCount; i++) {
+        const yume::RocketState& rocket = shown.pilots[i].rocket;
+        yume::vec2<float> target = rocket.position + rocket.size * 0.5f;
+        pilots[i].camera = pilots[i].camera + (target - pilots[i].camera) * std::min(1.0f, camera_follow * deltaTime);
+        if (shown.pilots[i].respawnTimer <= 0.0f) {
+            loudest = std::max(loudest, rocket.thrust);
+        }
+    }
+
+    boosterTimer += deltaTime;
+    if (boosterTimer >= 0.2f && !boosterFrames.empty()) {
+        boosterFrame = (boosterFrame + 1) % static_cast<int>(boosterFrames.size());
+        boosterTimer = 0.0f;
+    }
+
+    audio->setThrust(loudest);
+    audio->setEngine(true);
+}
+
+void SplitScreen::submit(yume::FrameArena& arena) {
+    batch.clear();
+    int line = glyphs->lineHeight();
+    const yume::VersusState& shown = shownRace();
+
+    for (int i = 0; i < pilotCount; i++) {
+        const yume::VersusPilot& pilot = shown.pilots[i];
+        const yume::RocketState& rocket = pilot.rocket;
+        const SDL_Color& color = pilots[i].color;
+        bool crashed = pilot.respawnTimer > 0.0f;
+
+        // the flame hangs below the rocket's base, turned with it, as in the single player game
+        if (!crashed && !rocket.grounded && rocket.engine_enable && rocket.thrust >= 2.0f && !boosterFrames.empty()) {
+            float radians = (rocket.rotation - 90) * (M_PI / 180.0f);
+            float offset = rocket.size.y / 2.0f + 64 / 2.0f - 42.0f;
+            SDL_Rect flame = { (int)(rocket.position.x - std::sin(radians) * offset), (int)(rocket.position.y + std::cos(radians) * offset), 32, 64 };
+            batch.addSprite(boosterFrames[boosterFrame], flame, rocket.rotation - 90);
+        }
+
+        SDL_Rect body = { (int)rocket.position.x, (int)rocket.position.y, (int)rocket.size.x, (int)rocket.size.y };
+        batch.addSprite(rocketTexture, body, rocket.rotation - 90);
+        // drawn into every pane that sees the rocket, so each pilot can tell who is who
+        batch.addText(yume::SpriteBatch::world_space, pilot_labels[i], { body.x + 8, body.y - line }, color);
+
+        batch.addText(i, yume::TextBuilder(arena, 48).append(pilot_labels[i]).append("  Score ").append(pilot.score).append("  Stage ").append(shown.islandStage).view(),
+            { 6, 4 }, color);
+        batch.addText(i, yume::TextBuilder(arena, 48).append("Thrust ").append(rocket.thrust, 1).append("  Speed ").append(rocket.velocity.length(), 1).view(),
+            { 6, 4 + line }, SDL_Color{ 255, 255, 255, 255 });
+        if (crashed) {
+            batch.addText(i, "Crashed", { 6, 4 + line * 2 }, SDL_Color{ 255, 90, 90, 255 });
+        }
+        else if (pilot.landedTime > 0.0f) {
+            batch.addText(i, yume::TextBuilder(arena, 32).append("Hold ").append(yume::landing_hold_time - pilot.landedTime, 1).view(),
+                { 6, 4 + line * 2 }, SDL_Color{ 120, 255, 120, 255 });
+        }
+    }
+
+    // the local pane shows how hard the session is working to hide the latency
+    if (session != nullptr) {
+        const yume::RollbackStats& stats = session->stats();
+        int pane = session->localPlayer();
+        batch.addText(pane, yume::TextBuilder(arena, 64).append("Rollbacks ").append(static_cast<int>(stats.rollbacks)).append("  Max ").append(stats.maxDepth)
+            .append("  Ahead ").append(session->tickAdvantage(), 1).view(), { 6, 4 + line * 3 }, SDL_Color{ 200, 200, 255, 255 });
+        batch.addText(pane, yume::TextBuilder(arena, 64).append("Stalls ").append(static_cast<int>(stats.stalls)).append("  Resim ").append(stats.lastResimMs, 2)
+            .append(" ms").view(), { 6, 4 + line * 4 }, SDL_Color{ 200, 200, 255, 255 });
+        if (stats.desyncs > 0) {
+            batch.addText(pane, yume::TextBuilder(arena, 64).append("Desynced at tick ").append(static_cast<int>(stats.firstDesyncTick))
+                .append(", ").append(static_cast<int>(stats.desyncs)).append(" checks off").view(), { 6, 4 + line * 5 }, SDL_Color{ 255, 90, 90, 255 });
+        }
+        else {
+            batch.addText(pane, yume::TextBuilder(arena, 64).append("In sync, ").append(static_cast<int>(stats.checksumsCompared)).append(" checks").view(),
+                { 6, 4 + line * 5 }, SDL_Color{ 200, 200, 255, 255 });
+        }
+        batch.addText(session->remotePlayer(), "Remote", { 6, 4 + line * 3 }, SDL_Color{ 200, 200, 255, 255 });
+    }
+
+    if (pilotCount == 3) {
+        batch.addText(3, "Overview", { 6, 4 }, SDL_Color{ 255, 255, 255, 255 });
+    }
+}
+
+void SplitScreen::render() {
+    submit(manager->frameArena());
+    SDL_SetRenderDrawColor(renderer, 25, 10, 95, 255);
+
+    // The viewport is shifted so the pane shows its view of the world while every layer keeps drawing in world
+    // coordinates, the clip rect (relative to the viewport) keeps it inside the pane. Everything only fills the
+    // pane's pixels, so the fill cost of the frame does not grow with the number of pilots.
+    for (int i = 0; i < pilotCount; i++) {
+        SDL_Rect pane = paneRect(i);
+        SDL_Rect view = paneView(i);
+        SDL_Rect viewport = { pane.x - view.x, pane.y - view.y, world_width, world_height };
+        SDL_RenderSetViewport(renderer, &viewport);
+        SDL_RenderSetClipRect(renderer, &view);
+        compositor->render(renderer);
+        batch.drawWorld(renderer, view);
+    }
+    SDL_RenderSetClipRect(renderer, nullptr);
+
+    // three pilots leave a quarter over, it shows the whole world at half size
+    if (pilotCount == 3) {
+        SDL_Rect world = { 0, 0, world_width, world_height };
+        SDL_Rect viewport = { world_width, world_height, world_width, world_height };
+        SDL_RenderSetScale(renderer, 0.5f, 0.5f);
+        SDL_RenderSetViewport(renderer, &viewport);
+        compositor->render(renderer);
+        batch.drawWorld(renderer, world);
+        SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    }
+
+    for (int i = 0; i < (pilotCount == 3 ? 4 : pilotCount); i++) {
+        SDL_Rect pane = paneRect(i);
+        SDL_RenderSetViewport(renderer, &pane);
+        batch.drawPaneText(renderer, i);
+    }
+    SDL_RenderSetViewport(renderer, nullptr);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDrawLine(renderer, world_width / 2, 0, world_width / 2, world_height);
+    if (pilotCount > 2) {
+        SDL_RenderDrawLine(renderer, 0, world_height / 2, world_width, world_height / 2);
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
+SplitScreen::~SplitScreen() {
+    for (SDL_GameController* controller : controllers) {
+        SDL_GameControllerClose(controller);
+    }
+    if (controllersReady) {
+        SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+    }
+
+    SDL_DestroyTexture(rocketTexture);
+    for (SDL_Texture* frame : boosterFrames) {
+        SDL_DestroyTexture(frame);
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef YUME_SPLIT_SCREEN
+#define YUME_SPLIT_SCREEN
+
+#include "scene.hpp"
+#include "../render/compositor.hpp"
+#include "../render/sprite_cache.hpp"
+#include "../render/glyph_atlas.hpp"
+#include "../render/sprite_batch.hpp"
+#include "../simulation/versus.hpp"
+#include "../net/udp_socket.hpp"
+#include "../net/rollback_session.hpp"
+
+// Two to four pilots race for the same island, each on their own keys or gamepad and in their own pane.
+// A landing held for landing_hold_time scores and moves the island on for everyone, a crash sits the pilot out
+// for a moment. The world is submitted once per frame and every pane replays it through its own viewport, the
+// background and island caches, rotated sprites and the glyph atlas are shared by all of them.
+// The race itself is yume::stepVersus. With YUME_NETPLAY=player,localport,host,peerport[,seed] set, two machines
+// race each other instead, one pilot each, stepped at a fixed 60 Hz through a rollback session.
+class SplitScreen : public Scene {
+public:
+    static constexpr int max_pilots = yume::SpriteBatch::max_panes;
+
+protected:
+    struct KeySet {
+        SDL_Scancode thrustUp;
+        SDL_Scancode thrustDown;
+        SDL_Scancode rotateLeft;
+        SDL_Scancode rotateRight;
+    };
+
+    // only what the screen needs, the flight state lives in race
+    struct Pilot {
+        yume::vec2<float> camera;  // center of the pane's view
+        SDL_Color color;
+        SDL_GameController* controller{ nullptr };
+    };
+
+    struct NetplayConfig {
+        bool enabled{ false };
+        int player{ 0 };
+        Uint16 localPort{ 0 };
+        std::string host;
+        Uint16 peerPort{ 0 };
+        std::uint32_t seed{ 1 };  // both sides need the same one, it places the islands
+    };
+
+    static constexpr KeySet key_sets[max_pilots] = {
+        { SDL_SCANCODE_W, SDL_SCANCODE_S, SDL_SCANCODE_A, SDL_SCANCODE_D },
+        { SDL_SCANCODE_UP, SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT },
+        { SDL_SCANCODE_I, SDL_SCANCODE_K, SDL_SCANCODE_J, SDL_SCANCODE_L },
+        { SDL_SCANCODE_KP_8, SDL_SCANCODE_KP_5, SDL_SCANCODE_KP_4, SDL_SCANCODE_KP_6 },
+    };
+
+    Uint32 lastTime{};
+    std::mt19937 gen;  // seeds each local race
+
+    yume::VersusState race{};
+    yume::VersusShapes shapes;
+    std::array<Pilot, max_pilots> pilots{};
+    int pilotCount{ 2 };
+    // in the order they were plugged in, pilot i flies the i-th one as well as their keys
+    std::vector<SDL_GameController*> controllers;
+    bool controllersReady{ false };  // the controller subsystem came up, only then is it quit again
+
+    // Game objects, the rockets are only flight state drawn from one texture
+    yume::RenderManager renderManager;
+    SDL_Texture* rocketTexture{ nullptr };
+    std::vector<SDL_Texture*> boosterFrames;
+    int boosterFrame{ 0 };
+    float boosterTimer{ 0.0f };
+    yume::RotatedMaskSet rocketMasks;
+    std::unique_ptr<Island> island;
+    std::unique_ptr<Texture> airstrip;
+    std::unique_ptr<Texture> background;
+
+    // what the island layer was last drawn for
+    std::uint32_t shownPlacements{ 0 };
+    int shownStage{ 0 };
+
+    NetplayConfig netplay;
+    std::unique_ptr<yume::UdpSocket> socket;
+    std::unique_ptr<yume::RollbackSession> session;
+    float tickAccumulator{ 0.0f };
+
+    // Layers
+    std::unique_ptr<yume::Compositor> compositor;
+    std::unique_ptr<yume::SpriteCache> sprites;
+    std::unique_ptr<yume::GlyphAtlas> glyphs;
+    yume::SpriteBatch batch;
+    int islandLayer{ -1 };
+
+    yume::AudioEngine* audio;
+
+public:
+    SplitScreen(SDL_Renderer* rend, SDL_Window* wind, SceneManager* mgr, yume::AudioEngine* aud, unsigned seed = std::random_device{}());
+
+    // 2 to 4, takes effect on the next start()
+    void setPilotCount(int count);
+    int getPilotCount() const;
+
+    SDL_Rect islandBounds() const;
+    void refreshIslandLayer();
+    // moves the island and airstrip objects to where the race has the island, redraws its layer when it was replaced
+    void syncIsland();
+    // the race as it is on screen, the rollback session's when playing over the network
+    const yume::VersusState& shownRace() const;
+
+    // where pilot's pane sits on screen, 2 pilots split it in halves, 3 and 4 in quarters
+    SDL_Rect paneRect(int pilot) const;
+    // the world rectangle a pane shows, centered on its camera and kept inside the world
+    SDL_Rect paneView(int pilot) const;
+
+    virtual void start() override;
+    virtual void stop() override;
+    virtual void handleEvents(SDL_Event& event) override;
+    // pilot's keys and controller as one step's input
+    yume::VersusInput readInput(int pilot, const Uint8* state) const;
+    virtual void update() override;
+    // everything the panes draw over the cached layers, once per frame
+    void submit(yume::FrameArena& arena);
+    virtual void render() override;
+
+    ~SplitScreen();
+
+private:
+    void openControllers();
+    void assignControllers();
+    // false when the socket could not be set up, the race is local then
+    bool startNetplay();
+    void updateNetplay(float deltaTime);
+};
+
+#endif
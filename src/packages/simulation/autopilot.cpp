@@ -0,0 +1,191 @@
+#include "autopilot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace yume {
+
+    namespace {
+        // distance of the rocket from resting upright in the middle of the island, plus how fast it is still moving
+        float approachCost(const RocketState& rocket, const IslandState& island) {
+            float deck = island.position.y - rocket.size.y;
+            float targetX = island.position.x + island.size.x / 2.0f - rocket.size.x / 2.0f;
+            float dx = std::abs(rocket.position.x - targetX);
+            float motion = rocket.velocity.length() * 0.3f + std::abs(rocket.rotation - 90.0f) * 2.0f;
+
+            if (rocket.position.y <= deck + 2.0f) {
+                return dx + (deck - rocket.position.y) * 0.5f + motion;
+            }
+
+            // below deck level the rocket first has to get clear of the island's sides and climb past it
+            float left = island.position.x - rocket.size.x - 10.0f;
+            float right = island.position.x + island.size.x + 10.0f;
+            float underneath = 0.0f;
+            if (rocket.position.x > left && rocket.position.x < right) {
+                underneath = std::min(rocket.position.x - left, right - rocket.position.x);
+            }
+
+            return 300.0f + underneath * 2.0f + (rocket.position.y - deck) + dx * 0.2f + motion;
+        }
+    }
+
+    Autopilot::Autopilot(JobSystem* jobs_v, int candidate_count, float budget_ms, unsigned seed)
+        : jobs(jobs_v), candidateCount(std::max(candidate_count, 2)), budgetMs(budget_ms),
+        plans(candidateCount), costs(candidateCount), gen(seed) {
+        currentStats.candidates = candidateCount;
+    }
+
+    void Autopilot::reset() {
+        hasBest = false;
+    }
+
+    const AutopilotStats& Autopilot::stats() const {
+        return currentStats;
+    }
+
+    AutopilotInput Autopilot::track(const RocketState& rocket, const Segment& target) {
+        AutopilotInput input{ 0, 0 };
+
+        if (rocket.thrust < target.thrust - rocket_thrust_up / 2.0f) input.thrust = 1;
+        else if (rocket.thrust > target.thrust + rocket_thrust_down / 2.0f) input.thrust = -1;
+
+        // steer the rotational velocity towards a rate proportional to the heading error
+        float wanted = (target.heading - rocket.rotation) * 2.0f;
+        if (rocket.rotationalVelocity < wanted - rocket_rotate_step / 2.0f) input.rotate = 1;
+        else if (rocket.rotationalVelocity > wanted + rocket_rotate_step / 2.0f) input.rotate = -1;
+
+        return input;
+    }
+
+    void Autopilot::apply(RocketState& rocket, AutopilotInput input) {
+        if (input.thrust > 0) increaseThrust(rocket);
+        else if (input.thrust < 0) decreaseThrust(rocket);
+
+        if (input.rotate < 0) rotateLeft(rocket);
+        else if (input.rotate > 0) rotateRight(rocket);
+    }
+
+    void Autopilot::samplePlan(Plan& plan) {
+        std::uniform_real_distribution<float> thrust(4.0f, rocket_max_thrust);
+        std::uniform_real_distribution<float> heading(60.0f, 120.0f);
+        std::uniform_int_distribution<> split(30, 180);
+
+        int remaining = horizon;
+        for (int i = 0; i < segments; i++) {
+            int steps = i == segments - 1 ? remaining : std::min(remaining, split(gen));
+            plan[i] = Segment{ thrust(gen), heading(gen), steps };
+            remaining -= steps;
+        }
+    }
+
+    void Autopilot::mutatePlan(Plan& plan) {
+        std::normal_distribution<float> thrust(0.0f, 1.0f);
+        std::normal_distribution<float> heading(0.0f, 5.0f);
+        std::uniform_int_distribution<> pick(0, segments - 1);
+
+        Segment& segment = plan[pick(gen)];
+        segment.thrust = std::clamp(segment.thrust + thrust(gen), 0.0f, rocket_max_thrust);
+        segment.heading = std::clamp(segment.heading + heading(gen), 45.0f, 135.0f);
+    }
+
+    float Autopilot::rollout(const Plan& plan, RocketState rocket, IslandState island) {
+        int step = 0;
+
+        for (const Segment& segment : plan) {
+            for (int k = 0; k < segment.steps; k++, step++) {
+                apply(rocket, track(rocket, segment));
+                stepFlight(rocket, island, step_time);
+
+                if (isSafeLanding(rocket)) {
+                    // a touchdown at the edge of the stable range can still tip over, fly the settling out
+                    // the way decide() does once landed before counting it
+                    for (int settle = 0; settle < settle_steps; settle++) {
+                        decreaseThrust(rocket);
+                        stepFlight(rocket, island, step_time);
+                        if (isCrash(rocket) || !rocket.grounded) {
+                            return 1000.0f + approachCost(rocket, island);
+                        }
+                    }
+                    return -1000.0f + step * 0.1f + rocket.previousVelocity.length();
+                }
+                if (isCrash(rocket)) {
+                    return 1000.0f + approachCost(rocket, island);
+                }
+                if (rocket.grounded && !rocket.on_island) {
+                    return 500.0f + approachCost(rocket, island);
+                }
+                if (rocket.position.x < -rocket.size.x || rocket.position.x > 800.0f || rocket.position.y < -200.0f) {
+                    return 800.0f + approachCost(rocket, island);
+                }
+            }
+        }
+
+        return approachCost(rocket, island);
+    }
+
+    AutopilotInput Autopilot::decide(const RocketState& rocket, const IslandState& island) {
+        using clock = std::chrono::steady_clock;
+        clock::time_point start = clock::now();
+        clock::time_point deadline = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float, std::milli>(budgetMs));
+
+        // once down safely only the thrust has to go, any plan would just lift the rocket off again
+        if (isSafeLanding(rocket)) {
+            hasBest = false;
+            currentStats.rollouts = 0;
+            currentStats.decisionMs = 0.0f;
+            return AutopilotInput{ rocket.thrust > 0.0f ? -1 : 0, 0 };
+        }
+
+        // candidate 0 is last tick's winner, the first quarter mutates it and the rest explores
+        for (int i = 0; i < candidateCount; i++) {
+            Plan& plan = plans[i];
+            if (hasBest && i < candidateCount / 4) {
+                plan = best;
+                if (i > 0) {
+                    mutatePlan(plan);
+                }
+            }
+            else {
+                samplePlan(plan);
+            }
+        }
+
+        std::atomic<int> evaluated{ 0 };
+        jobs->parallelFor(candidateCount, 8, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                if (i > 0 && clock::now() >= deadline) {
+                    costs[i] = std::numeric_limits<float>::max();
+                    continue;
+                }
+                costs[i] = rollout(plans[i], rocket, island);
+                evaluated.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        int winner = static_cast<int>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+        best = plans[winner];
+        AutopilotInput input = track(rocket, best[0]);
+
+        // advance the winner by one tick so it lines up with the next decision, the horizon keeps its length
+        best[0].steps -= 1;
+        if (best[0].steps == 0) {
+            std::rotate(best.begin(), best.begin() + 1, best.end());
+            best[segments - 1] = best[segments - 2];
+            best[segments - 1].steps = 0;
+        }
+        best[segments - 1].steps += 1;
+        hasBest = true;
+
+        float elapsed = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+        float throughput = elapsed > 0.0f ? evaluated.load() * 1000.0f / elapsed : 0.0f;
+
+        currentStats.rollouts = evaluated.load();
+        currentStats.decisionMs = elapsed;
+        currentStats.rolloutsPerSecond = currentStats.rolloutsPerSecond == 0.0f ? throughput : currentStats.rolloutsPerSecond * 0.9f + throughput * 0.1f;
+        currentStats.bestCost = costs[winner];
+
+        return input;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef YUME_AUTOPILOT
+#define YUME_AUTOPILOT
+
+#include "flight_model.hpp"
+#include "../jobs/job_system.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace yume {
+
+    // -1 / 0 / 1 per axis: decrease, keep or increase thrust, rotate left, none or right
+    struct AutopilotInput {
+        int thrust;
+        int rotate;
+    };
+
+    struct AutopilotStats {
+        int candidates;
+        int rollouts;             // rollouts finished inside the budget on the last decision
+        float decisionMs;         // wall time of the last decide()
+        float rolloutsPerSecond;  // smoothed rollout throughput while deciding
+        float bestCost;
+    };
+
+    // Model predictive controller: every tick it samples plans, rolls each one forward with stepFlight()
+    // across the job system until the time budget runs out and returns the first input of the cheapest plan.
+    // A plan is a few segments of target thrust and heading, a tracking rule turns them into the same
+    // increaseThrust / rotateLeft presses the player makes, one press per axis per frame.
+    class Autopilot {
+    public:
+        static constexpr int segments = 4;
+        static constexpr int horizon = 480;
+        static constexpr float step_time = 1.0f / 60.0f;
+        static constexpr int settle_steps = 60;
+
+        Autopilot(JobSystem* jobs_v, int candidate_count, float budget_ms, unsigned seed = std::random_device{}());
+
+        AutopilotInput decide(const RocketState& rocket, const IslandState& island);
+        void reset();
+        const AutopilotStats& stats() const;
+
+    private:
+        struct Segment {
+            float thrust;
+            float heading;
+            int steps;
+        };
+        using Plan = std::array<Segment, segments>;
+
+        JobSystem* jobs;
+        int candidateCount;
+        float budgetMs;
+        std::vector<Plan> plans;
+        std::vector<float> costs;
+        Plan best{};
+        bool hasBest{ false };
+        std::mt19937 gen;
+        AutopilotStats currentStats{};
+
+        void samplePlan(Plan& plan);
+        void mutatePlan(Plan& plan);
+        static AutopilotInput track(const RocketState& rocket, const Segment& target);
+        static void apply(RocketState& rocket, AutopilotInput input);
+        static float rollout(const Plan& plan, RocketState rocket, IslandState island);
+    };
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "collision_mask.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace yume {
+
+    CollisionMask CollisionMask::fromAlpha(const AlphaImage& image, int width, int height, float degrees, std::uint8_t threshold) {
+        double radians = degrees * 3.14159265358979323846 / 180.0;
+        double c = std::cos(radians);
+        double s = std::sin(radians);
+
+        // same bounding box and even margins as the sprite cache, so the mask sits on the drawn pixels
+        int outWidth = width;
+        int outHeight = height;
+        if (degrees != 0.0f) {
+            outWidth = static_cast<int>(std::ceil(width * std::abs(c) + height * std::abs(s) - 0.001));
+            outHeight = static_cast<int>(std::ceil(width * std::abs(s) + height * std::abs(c) - 0.001));
+            if ((outWidth - width) % 2 != 0) outWidth += 1;
+            if ((outHeight - height) % 2 != 0) outHeight += 1;
+        }
+
+        CollisionMask mask;
+        mask.w = outWidth;
+        mask.h = outHeight;
+        mask.words = (outWidth + 63) / 64;
+        mask.bits.assign(static_cast<std::size_t>(mask.words) * outHeight, 0);
+
+        if (image.width <= 0 || image.height <= 0 || width <= 0 || height <= 0) {
+            return mask;
+        }
+
+        double scaleX = static_cast<double>(image.width) / width;
+        double scaleY = static_cast<double>(image.height) / height;
+
+        for (int y = 0; y < outHeight; y++) {
+            for (int x = 0; x < outWidth; x++) {
+                // back from the output pixel center into the unrotated width x height sprite
+                double u = x + 0.5 - outWidth / 2.0;
+                double v = y + 0.5 - outHeight / 2.0;
+                double spriteX = u * c + v * s + width / 2.0;
+                double spriteY = -u * s + v * c + height / 2.0;
+
+                if (spriteX < 0.0 || spriteY < 0.0 || spriteX >= width || spriteY >= height) {
+                    continue;
+                }
+
+                int sourceX = std::min(static_cast<int>(spriteX * scaleX), image.width - 1);
+                int sourceY = std::min(static_cast<int>(spriteY * scaleY), image.height - 1);
+                if (image.alpha[static_cast<std::size_t>(sourceY) * image.width + sourceX] >= threshold) {
+                    mask.bits[static_cast<std::size_t>(y) * mask.words + (x >> 6)] |= std::uint64_t{ 1 } << (x & 63);
+                }
+            }
+        }
+
+        return mask;
+    }
+
+    RotatedMaskSet::RotatedMaskSet(const AlphaImage& image, int width, int height, float angle_step)
+        : step(angle_step > 0.0f ? angle_step : 1.0f) {
+        int count = std::max(1, static_cast<int>(std::lround(360.0f / step)));
+        masks.reserve(count);
+        for (int i = 0; i < count; i++) {
+            masks.push_back(CollisionMask::fromAlpha(image, width, height, i * step));
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef YUME_COLLISION_MASK
+#define YUME_COLLISION_MASK
+
+#include <cstdint>
+#include <vector>
+
+namespace yume {
+
+    // The alpha channel of a texture, row major, one byte per pixel.
+    struct AlphaImage {
+        int width{ 0 };
+        int height{ 0 };
+        std::vector<std::uint8_t> alpha;
+    };
+
+    // Opaque pixels packed one bit per pixel, bit i of word k covers column k * 64 + i.
+    // Testing two masks ANDs 64 pixels of a row at once, a rocket row is a single word. The overlap test is inline
+    // so the flight model stays header only, building masks from images lives in collision_mask.cpp.
+    class CollisionMask {
+    public:
+        CollisionMask() = default;
+
+        // nearest samples the image onto a width x height grid rotated clockwise by degrees about its center
+        // (the same direction as SDL_RenderCopyEx), a rotated mask grows to the rotated bounding box
+        static CollisionMask fromAlpha(const AlphaImage& image, int width, int height, float degrees = 0.0f, std::uint8_t threshold = 128);
+
+        int width() const { return w; }
+        int height() const { return h; }
+
+        bool test(int x, int y) const {
+            if (x < 0 || y < 0 || x >= w || y >= h) {
+                return false;
+            }
+            return (bits[static_cast<std::size_t>(y) * words + (x >> 6)] >> (x & 63)) & 1u;
+        }
+
+        // the first set row of a column from the top, -1 when the column is empty or outside the mask
+        int surface(int column) const {
+            if (column < 0 || column >= w) {
+                return -1;
+            }
+            for (int row = 0; row < h; row++) {
+                if ((bits[static_cast<std::size_t>(row) * words + (column >> 6)] >> (column & 63)) & 1u) {
+                    return row;
+                }
+            }
+            return -1;
+        }
+
+        // true when a set pixel of this mask placed at (x, y) covers a set pixel of other placed at (other_x, other_y)
+        bool overlaps(int x, int y, const CollisionMask& other, int other_x, int other_y) const {
+            int left = x > other_x ? x : other_x;
+            int top = y > other_y ? y : other_y;
+            int right = x + w < other_x + other.w ? x + w : other_x + other.w;
+            int bottom = y + h < other_y + other.h ? y + h : other_y + other.h;
+
+            if (left >= right || top >= bottom) {
+                return false;
+            }
+
+            for (int row = top; row < bottom; row++) {
+                for (int column = left; column < right; column += 64) {
+                    std::uint64_t a = rowBits(row - y, column - x);
+                    std::uint64_t b = other.rowBits(row - other_y, column - other_x);
+                    int span = right - column;
+                    if (span < 64) {
+                        std::uint64_t keep = (std::uint64_t{ 1 } << span) - 1;
+                        a &= keep;
+                    }
+                    if (a & b) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+    private:
+        int w{ 0 };
+        int h{ 0 };
+        int words{ 0 };
+        std::vector<std::uint64_t> bits;
+
+        // 64 pixels of a row starting at column, the columns past the end read as empty
+        std::uint64_t rowBits(int row, int column) const {
+            const std::uint64_t* line = bits.data() + static_cast<std::size_t>(row) * words;
+            int word = column >> 6;
+            int shift = column & 63;
+
+            std::uint64_t value = line[word] >> shift;
+            if (shift != 0 && word + 1 < words) {
+                value |= line[word + 1] << (64 - shift);
+            }
+            return value;
+        }
+    };
+
+    // One mask per angle step for a sprite that rotates, built once at load time.
+    class RotatedMaskSet {
+    public:
+        RotatedMaskSet() = default;
+        RotatedMaskSet(const AlphaImage& image, int width, int height, float angle_step);
+
+        bool empty() const { return masks.empty(); }
+
+        const CollisionMask& at(float degrees) const {
+            float wrapped = degrees - 360.0f * static_cast<float>(static_cast<int>(degrees / 360.0f));
+            if (wrapped < 0.0f) wrapped += 360.0f;
+            int index = static_cast<int>(wrapped / step + 0.5f) % static_cast<int>(masks.size());
+            return masks[index];
+        }
+
+    private:
+        float step{ 1.0f };
+        std::vector<CollisionMask> masks;
+    };
+
+    // What the flight model tests after the rectangles touch. The rocket set is indexed by the sprite angle
+    // (rotation - 90), the island mask is built for the island's current size.
+    struct CollisionShapes {
+        const RotatedMaskSet* rocket;
+        const CollisionMask* island;
+    };
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef YUME_FLIGHT_MODEL
+#define YUME_FLIGHT_MODEL
+
+// The rocket and island rules as plain data and inline functions. Rocket, Island and Game delegate to these,
+// so the autopilot rollouts and the SDL free tools simulate exactly what the player flies.
+#include "../math/math.hpp"
+#include "collision_mask.hpp"
+
+namespace yume {
+
+    constexpr double flight_pi = 3.14159265358979323846;
+
+    constexpr float rocket_max_thrust = 16.0f;
+    constexpr float rocket_air_resistance = 0.98f;
+    constexpr float rocket_thrust_up = 0.4f;
+    constexpr float rocket_thrust_down = 0.5f;
+    constexpr float rocket_rotate_step = 3.6f;
+    constexpr float ground_level = 495.0f;
+    constexpr float landing_max_speed = 40.0f;
+    constexpr int final_stage = 9;
+    constexpr float landing_hold_time = 3.9f;  // a safe landing wins once held this long
+    constexpr float island_shrink = 6.5f;      // taken off the island's width and height on every win
+    // restartProgress() puts the island's top left corner anywhere in this range
+    constexpr int island_spawn_left = 100;
+    constexpr int island_spawn_right = 400;
+    constexpr int island_spawn_top = 100;
+    constexpr int island_spawn_bottom = 350;
+    constexpr float wind_coupling = 0.05f;  // share of the wind speed the rocket picks up per second
+
+    struct RocketState {
+        vec2<float> position;
+        vec2<float> size;
+        vec2<float> velocity;
+        vec2<float> previousVelocity;
+        float rotation;
+        float thrust;
+        float gravity;
+        float rotationalVelocity;
+        bool grounded;
+        bool on_island;
+        bool is_stable;
+        bool engine_enable;
+        vec2<float> wind{};  // air speed at the rocket, held constant over a step
+    };
+
+    struct IslandState {
+        vec2<float> position;
+        vec2<float> size;
+        float leftBound;
+        float rightBound;
+        bool movingRight;
+        int stage;
+        const CollisionShapes* shapes{ nullptr };  // null keeps the plain rectangle test
+    };
+
+    // the island starts at 100x66 and shrinks on every win
+    inline vec2<float> islandSizeAtStage(int stage) {
+        return vec2<float>(100.0f - island_shrink * stage, 66.0f - island_shrink * stage);
+    }
+
+    inline void levelOut(RocketState& rocket) {
+        if (rocket.rotation > 105 && rocket.rotation < 180) {
+            rocket.rotationalVelocity += 0.6f;
+        }
+        else if (rocket.rotation < 75 && rocket.rotation > 0) {
+            rocket.rotationalVelocity -= 0.6f;
+        }
+        else if (rocket.rotation >= 75 && rocket.rotation <= 105) {
+            if (rocket.rotation > 90) {
+                rocket.rotationalVelocity -= 0.2f;
+            }
+            else if (rocket.rotation < 90) {
+                rocket.rotationalVelocity += 0.2f;
+            }
+        }
+    }
+
+    inline void increaseThrust(RocketState& rocket) {
+        if (rocket.thrust < rocket_max_thrust) {
+            rocket.thrust += rocket_thrust_up;
+        }
+    }
+
+    inline void decreaseThrust(RocketState& rocket) {
+        if (rocket.thrust > 0) {
+            rocket.thrust -= rocket_thrust_down;
+        }
+    }
+
+    inline void rotateLeft(RocketState& rocket) {
+        if (!rocket.grounded) {
+            rocket.rotationalVelocity -= rocket_rotate_step;
+        }
+    }
+
+    inline void rotateRight(RocketState& rocket) {
+        if (!rocket.grounded) {
+            rocket.rotationalVelocity += rocket_rotate_step;
+        }
+    }
+
+    inline void stepRocket(RocketState& rocket, float deltaTime) {
+        float radians = static_cast<float>(rocket.rotation * flight_pi / 180.0);
+        vec2<float> thrustForce(std::cos(radians) * rocket.thrust, std::sin(radians) * rocket.thrust);
+
+        if (rocket.engine_enable) {
+            rocket.velocity = rocket.velocity - thrustForce * deltaTime;
+        }
+        rocket.velocity.y = rocket.velocity.y + rocket.gravity * deltaTime;
+        rocket.velocity = rocket.velocity + rocket.wind * (wind_coupling * deltaTime);
+
+        rocket.position = rocket.position + rocket.velocity * deltaTime;
+
+        rocket.rotationalVelocity = rocket.rotationalVelocity * rocket_air_resistance;
+        rocket.rotation = rocket.rotation + rocket.rotationalVelocity * deltaTime;
+
+        rocket.grounded = rocket.position.y > ground_level - rocket.size.y;
+
+        if (rocket.grounded) {
+            rocket.position.y = ground_level - rocket.size.y;
+            rocket.velocity = vec2<float>::ZERO();
+            rocket.on_island = false;
+
+            levelOut(rocket);
+        }
+
+        if (rocket.rotation > 360.0f) {
+            rocket.rotation = 0.0f;
+        }
+        else if (rocket.rotation < 0.0f) {
+            rocket.rotation = 360.0f;
+        }
+
+        rocket.is_stable = rocket.rotation <= 105.0f && rocket.rotation >= 75.0f;
+
+        if (rocket.velocity.x != 0 && rocket.velocity.y != 0) {
+            rocket.previousVelocity = rocket.velocity;
+        }
+    }
+
+    inline void landOnIsland(RocketState& rocket, float surfaceY) {
+        rocket.position.y = surfaceY - rocket.size.y;
+        rocket.velocity.y = 0;
+        rocket.velocity.x = 0;
+
+        rocket.grounded = true;
+        rocket.on_island = true;
+
+        levelOut(rocket);
+    }
+
+    // Narrow phase behind the rectangle test: the rocket's rotated mask is centered on its rectangle,
+    // the island mask sits on the island's top left corner.
+    inline bool shapesTouch(const RocketState& rocket, const IslandState& island) {
+        const CollisionMask& rocketMask = island.shapes->rocket->at(rocket.rotation - 90.0f);
+        int rocketX = static_cast<int>(std::lround(rocket.position.x + (rocket.size.x - rocketMask.width()) / 2.0f));
+        int rocketY = static_cast<int>(std::lround(rocket.position.y + (rocket.size.y - rocketMask.height()) / 2.0f));
+
+        return rocketMask.overlaps(rocketX, rocketY, *island.shapes->island,
+            static_cast<int>(std::lround(island.position.x)), static_cast<int>(std::lround(island.position.y)));
+    }
+
+    // Resolves the rocket against the island rectangle, a hit from the top lands the rocket on it.
+    // With collision shapes the top is the island's opaque outline and the rest only counts once the pixels overlap.
+    inline void collideIsland(RocketState& rocket, const IslandState& island) {
+        const vec2<float>& position = island.position;
+        const vec2<float>& size = island.size;
+
+        bool rectanglesTouch = rocket.position.x < position.x + size.x && rocket.position.x + rocket.size.x > position.x
+            && rocket.position.y < position.y + size.y && rocket.position.y + rocket.size.y > position.y;
+        if (!rectanglesTouch) {
+            return;
+        }
+
+        bool shaped = island.shapes != nullptr && island.shapes->rocket != nullptr && !island.shapes->rocket->empty()
+            && island.shapes->island != nullptr;
+
+        if (shaped) {
+            // the rocket stands on the island surface under the middle of its base, so the seat does not move
+            // while levelOut() turns it upright
+            int column = static_cast<int>(std::lround(rocket.position.x + rocket.size.x / 2.0f - position.x));
+            int surface = island.shapes->island->surface(column);
+            if (surface >= 0 && rocket.velocity.y > 0) {
+                float top = position.y + surface;
+                if (rocket.position.y + rocket.size.y > top && rocket.position.y < top) {
+                    landOnIsland(rocket, top);
+                    return;
+                }
+            }
+
+            // anything else only counts once opaque pixels overlap, and is pushed out like the rectangle
+            if (!shapesTouch(rocket, island)) {
+                return;
+            }
+        }
+        else {
+            bool collides_from_top = rocket.position.y + rocket.size.y > position.y
+                && rocket.position.y < position.y
+                && rocket.position.x < position.x + size.x
+                && rocket.position.x + rocket.size.x > position.x;
+
+            if (collides_from_top && rocket.velocity.y > 0) {
+                landOnIsland(rocket, position.y);
+                return;
+            }
+        }
+
+        bool collides_from_bottom = rocket.position.y < position.y + size.y
+            && rocket.position.y + rocket.size.y > position.y + size.y
+            && rocket.position.x < position.x + size.x
+            && rocket.position.x + rocket.size.x > position.x;
+
+        if (collides_from_bottom && rocket.velocity.y < 0) {
+            rocket.position.y = position.y + size.y;
+            rocket.velocity.y = 0;
+            return;
+        }
+
+        bool collides_from_left = rocket.position.x + rocket.size.x > position.x
+            && rocket.position.x < position.x
+            && rocket.position.y < position.y + size.y
+            && rocket.position.y + rocket.size.y > position.y;
+
+        if (collides_from_left && rocket.velocity.x > 0) {
+            rocket.position.x = position.x - rocket.size.x;
+            rocket.velocity.x = 0;
+            return;
+        }
+
+        bool collides_from_right = rocket.position.x < position.x + size.x
+            && rocket.position.x + rocket.size.x > position.x + size.x
+            && rocket.position.y < position.y + size.y
+            && rocket.position.y + rocket.size.y > position.y;
+
+        if (collides_from_right && rocket.velocity.x < 0) {
+            rocket.position.x = position.x + size.x;
+            rocket.velocity.x = 0;
+        }
+    }
+
+    inline bool islandOscillates(int stage) {
+        return stage >= 2 && stage <= 4;
+    }
+
+    // Stages 2-4 move the island back and forth between its bounds while the rocket is not standing on it.
+    inline void moveIsland(IslandState& island, bool rocketOnIsland, float deltaTime) {
+        if (!islandOscillates(island.stage) || rocketOnIsland) {
+            return;
+        }
+
+        if (island.position.x >= island.rightBound) {
+            island.movingRight = false;
+        }
+        else if (island.position.x <= island.leftBound) {
+            island.movingRight = true;
+        }
+
+        if (island.movingRight) {
+            island.position.x += deltaTime * island.stage * 5.0f;
+        }
+        else {
+            island.position.x -= deltaTime * island.stage * 5.0f;
+        }
+    }
+
+    // The two spots on the ground where the scenery tips the rocket over.
+    inline void applyGroundHazards(RocketState& rocket) {
+        if (rocket.position.x > 230.0f && rocket.position.x < 320.0f && rocket.position.y > 425.0f) {
+            rocket.is_stable = false;
+        }
+        else if (rocket.position.x > 620.0f && rocket.position.x < 680.0f && rocket.position.y > 425.0f) {
+            rocket.is_stable = false;
+        }
+    }
+
+    inline bool isSafeLanding(const RocketState& rocket) {
+        return rocket.grounded && rocket.is_stable && rocket.on_island && rocket.previousVelocity.length() <= landing_max_speed;
+    }
+
+    inline bool isCrash(const RocketState& rocket) {
+        return rocket.grounded && (!rocket.is_stable || rocket.previousVelocity.length() > landing_max_speed);
+    }
+
+    // One frame of Game::update physics in the same order the game runs it.
+    inline void stepFlight(RocketState& rocket, IslandState& island, float deltaTime) {
+        stepRocket(rocket, deltaTime);
+        if (island.stage <= final_stage) {
+            collideIsland(rocket, island);
+        }
+        moveIsland(island, rocket.on_island, deltaTime);
+        applyGroundHazards(rocket);
+    }
+}
+
+#endif
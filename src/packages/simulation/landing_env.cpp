@@ -0,0 +1,285 @@
+#include "landing_env.hpp"
+#include "landing_env.h"
+
+#include <algorithm>
+#include <new>
+
+namespace yume {
+
+    namespace {
+        const vec2<float> rocket_size{ 32.0f, 64.0f };
+        const vec2<float> rocket_start{ 575.0f, 410.0f };
+        constexpr float rocket_gravity = 9.81f;
+
+        // splitmix64, eight bytes of state per environment instead of a mersenne twister each
+        std::uint64_t nextRandom(std::uint64_t& state) {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        // [low, high] like std::uniform_int_distribution
+        int uniformInt(std::uint64_t& state, int low, int high) {
+            std::uint64_t range = static_cast<std::uint64_t>(high - low + 1);
+            return low + static_cast<int>(((nextRandom(state) >> 32) * range) >> 32);
+        }
+    }
+
+    LandingEnvs::LandingEnvs(int count_v, std::uint64_t seed, unsigned threads)
+        : envCount(std::max(count_v, 1)) {
+        if (threads != 1) {
+            jobs = std::make_unique<JobSystem>(threads);
+        }
+
+        std::size_t n = static_cast<std::size_t>(envCount);
+        for (std::vector<float>* field : { &x, &y, &velocityX, &velocityY, &previousX, &previousY, &rotation, &rotationalVelocity,
+            &thrust, &islandX, &islandY, &leftBound, &rightBound, &winTimer }) {
+            field->assign(n, 0.0f);
+        }
+        stage.assign(n, 0);
+        steps.assign(n, 0);
+        flags.assign(n, 0);
+
+        random.resize(n);
+        for (std::size_t i = 0; i < n; i++) {
+            std::uint64_t mixed = seed ^ (i * 0xd1b54a32d192ed03ull);
+            random[i] = nextRandom(mixed);
+        }
+    }
+
+    int LandingEnvs::count() const {
+        return envCount;
+    }
+
+    void LandingEnvs::setMaxSteps(int steps_v) {
+        maxSteps = std::max(steps_v, 0);
+    }
+
+    bool LandingEnvs::setMasks(const AlphaImage& rocketAlpha, const AlphaImage& islandAlpha) {
+        if (rocketAlpha.alpha.empty() || islandAlpha.alpha.empty()) {
+            return false;
+        }
+
+        // the same masks Rocket and Island build from their textures
+        rocketMasks = RotatedMaskSet(rocketAlpha, static_cast<int>(rocket_size.x), static_cast<int>(rocket_size.y), 2.0f);
+        islandMasks.clear();
+        for (int s = 0; s <= final_stage; s++) {
+            vec2<float> size = islandSizeAtStage(s);
+            islandMasks.push_back(CollisionMask::fromAlpha(islandAlpha, static_cast<int>(size.x), static_cast<int>(size.y)));
+        }
+
+        shapes.clear();
+        for (const CollisionMask& mask : islandMasks) {
+            shapes.push_back(CollisionShapes{ &rocketMasks, &mask });
+        }
+        return true;
+    }
+
+    void LandingEnvs::reset(float* observations) {
+        for (int i = 0; i < envCount; i++) {
+            startAttempt(i, 0);
+            observe(i, observations + static_cast<std::size_t>(i) * YUME_OBS_SIZE);
+        }
+    }
+
+    void LandingEnvs::step(const std::int32_t* actions, float* observations, float* rewards, std::uint8_t* dones) {
+        if (jobs) {
+            jobs->parallelFor(static_cast<std::size_t>(envCount), 2048, [&](std::size_t begin, std::size_t end) {
+                stepRange(static_cast<int>(begin), static_cast<int>(end), actions, observations, rewards, dones);
+            });
+        }
+        else {
+            stepRange(0, envCount, actions, observations, rewards, dones);
+        }
+    }
+
+    // what Game::restartProgress() sets up, with the rocket back on the pad and the island somewhere new
+    void LandingEnvs::startAttempt(int env, int nextStage) {
+        x[env] = rocket_start.x;
+        y[env] = rocket_start.y;
+        velocityX[env] = 0.0f;
+        velocityY[env] = 0.0f;
+        previousX[env] = 0.0f;
+        previousY[env] = 0.0f;
+        rotation[env] = 90.0f;
+        rotationalVelocity[env] = 0.0f;
+        thrust[env] = 0.0f;
+
+        // past the final stage there is nothing left to land on, the next episode starts the game over
+        stage[env] = nextStage > final_stage ? 0 : nextStage;
+        islandX[env] = static_cast<float>(uniformInt(random[env], island_spawn_left, island_spawn_right));
+        islandY[env] = static_cast<float>(uniformInt(random[env], island_spawn_top, island_spawn_bottom));
+        leftBound[env] = islandX[env] - 50.0f;
+        rightBound[env] = islandX[env] + 50.0f;
+
+        winTimer[env] = 0.0f;
+        steps[env] = 0;
+        flags[env] = flag_stable;
+    }
+
+    void LandingEnvs::stepRange(int begin, int end, const std::int32_t* actions, float* observations, float* rewards, std::uint8_t* dones) {
+        for (int i = begin; i < end; i++) {
+            std::uint8_t f = flags[i];
+            RocketState rocket{ { x[i], y[i] }, rocket_size, { velocityX[i], velocityY[i] }, { previousX[i], previousY[i] },
+                rotation[i], thrust[i], rocket_gravity, rotationalVelocity[i],
+                (f & flag_grounded) != 0, (f & flag_on_island) != 0, (f & flag_stable) != 0, true };
+            IslandState island{ { islandX[i], islandY[i] }, islandSizeAtStage(stage[i]), leftBound[i], rightBound[i],
+                (f & flag_moving_right) != 0, stage[i], shapes.empty() ? nullptr : &shapes[stage[i]] };
+
+            // the same presses Game::flyAutopilot() makes
+            const std::int32_t* action = actions + static_cast<std::size_t>(i) * YUME_ACTION_SIZE;
+            if (action[YUME_ACTION_THRUST] > 0) increaseThrust(rocket);
+            else if (action[YUME_ACTION_THRUST] < 0) decreaseThrust(rocket);
+            if (action[YUME_ACTION_ROTATE] < 0) rotateLeft(rocket);
+            else if (action[YUME_ACTION_ROTATE] > 0) rotateRight(rocket);
+
+            stepFlight(rocket, island, step_time);
+
+            // Game::update() counts the win timer up while the previous frame predicted the win
+            float timer = (f & flag_win_predict) ? winTimer[i] + step_time : 0.0f;
+
+            bool winPredict = false;
+            float reward = 0.0f;
+            bool done = false;
+            int nextStage = stage[i];
+            if (rocket.grounded) {
+                if (isSafeLanding(rocket)) {
+                    winPredict = true;
+                    if (timer > landing_hold_time) {
+                        reward = 1.0f;
+                        done = true;
+                        nextStage += 1;
+                    }
+                }
+                else if (isCrash(rocket)) {
+                    reward = -1.0f;
+                    done = true;
+                }
+            }
+
+            int taken = steps[i] + 1;
+            if (!done && maxSteps > 0 && taken >= maxSteps) {
+                done = true;
+            }
+
+            rewards[i] = reward;
+            dones[i] = done ? 1 : 0;
+
+            if (done) {
+                startAttempt(i, nextStage);
+            }
+            else {
+                x[i] = rocket.position.x;
+                y[i] = rocket.position.y;
+                velocityX[i] = rocket.velocity.x;
+                velocityY[i] = rocket.velocity.y;
+                previousX[i] = rocket.previousVelocity.x;
+                previousY[i] = rocket.previousVelocity.y;
+                rotation[i] = rocket.rotation;
+                rotationalVelocity[i] = rocket.rotationalVelocity;
+                thrust[i] = rocket.thrust;
+                islandX[i] = island.position.x;
+                winTimer[i] = timer;
+                steps[i] = taken;
+                flags[i] = (rocket.grounded ? flag_grounded : 0) | (rocket.on_island ? flag_on_island : 0) | (rocket.is_stable ? flag_stable : 0)
+                    | (island.movingRight ? flag_moving_right : 0) | (winPredict ? flag_win_predict : 0);
+            }
+
+            observe(i, observations + static_cast<std::size_t>(i) * YUME_OBS_SIZE);
+        }
+    }
+
+    void LandingEnvs::observe(int env, float* row) const {
+        std::uint8_t f = flags[env];
+        vec2<float> size = islandSizeAtStage(stage[env]);
+
+        float islandVelocity = 0.0f;
+        if (islandOscillates(stage[env]) && !(f & flag_on_island)) {
+            islandVelocity = (f & flag_moving_right ? 5.0f : -5.0f) * stage[env];
+        }
+
+        row[YUME_OBS_X] = x[env];
+        row[YUME_OBS_Y] = y[env];
+        row[YUME_OBS_VELOCITY_X] = velocityX[env];
+        row[YUME_OBS_VELOCITY_Y] = velocityY[env];
+        row[YUME_OBS_ROTATION] = rotation[env];
+        row[YUME_OBS_ROTATIONAL_VELOCITY] = rotationalVelocity[env];
+        row[YUME_OBS_THRUST] = thrust[env];
+        row[YUME_OBS_ISLAND_X] = islandX[env];
+        row[YUME_OBS_ISLAND_Y] = islandY[env];
+        row[YUME_OBS_ISLAND_WIDTH] = size.x;
+        row[YUME_OBS_ISLAND_HEIGHT] = size.y;
+        row[YUME_OBS_ISLAND_VELOCITY_X] = islandVelocity;
+        row[YUME_OBS_STAGE] = static_cast<float>(stage[env]);
+        row[YUME_OBS_GROUNDED] = (f & flag_grounded) ? 1.0f : 0.0f;
+        row[YUME_OBS_ON_ISLAND] = (f & flag_on_island) ? 1.0f : 0.0f;
+        row[YUME_OBS_LANDED_TIME] = (f & flag_win_predict) ? winTimer[env] : 0.0f;
+    }
+}
+
+// the C interface, exceptions stop here
+struct yume_env {
+    yume::LandingEnvs envs;
+};
+
+yume_env* yume_env_create(int n_envs, uint64_t seed) {
+    return yume_env_create_threaded(n_envs, seed, 1);
+}
+
+yume_env* yume_env_create_threaded(int n_envs, uint64_t seed, int threads) {
+    if (n_envs <= 0 || threads < 0) {
+        return nullptr;
+    }
+    try {
+        return new yume_env{ { n_envs, seed, static_cast<unsigned>(threads) } };
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void yume_env_destroy(yume_env* env) {
+    delete env;
+}
+
+int yume_env_count(const yume_env* env) {
+    return env != nullptr ? env->envs.count() : 0;
+}
+
+void yume_env_set_max_steps(yume_env* env, int max_steps) {
+    if (env != nullptr) {
+        env->envs.setMaxSteps(max_steps);
+    }
+}
+
+int yume_env_set_masks(yume_env* env, const uint8_t* rocket_alpha, int rocket_width, int rocket_height,
+    const uint8_t* island_alpha, int island_width, int island_height) {
+    if (env == nullptr || rocket_alpha == nullptr || island_alpha == nullptr
+        || rocket_width <= 0 || rocket_height <= 0 || island_width <= 0 || island_height <= 0) {
+        return 0;
+    }
+
+    try {
+        yume::AlphaImage rocket{ rocket_width, rocket_height,
+            std::vector<std::uint8_t>(rocket_alpha, rocket_alpha + static_cast<std::size_t>(rocket_width) * rocket_height) };
+        yume::AlphaImage island{ island_width, island_height,
+            std::vector<std::uint8_t>(island_alpha, island_alpha + static_cast<std::size_t>(island_width) * island_height) };
+        return env->envs.setMasks(rocket, island) ? 1 : 0;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+void yume_env_reset(yume_env* env, float* obs) {
+    if (env != nullptr && obs != nullptr) {
+        env->envs.reset(obs);
+    }
+}
+
+void yume_env_step(yume_env* env, const int32_t* actions, float* obs, float* reward, uint8_t* done) {
+    if (env != nullptr && actions != nullptr && obs != nullptr && reward != nullptr && done != nullptr) {
+        env->envs.step(actions, obs, reward, done);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef YUME_LANDING_ENV_H
+#define YUME_LANDING_ENV_H
+
+/* C interface of the landing environments, for training controllers outside the game.
+ * Every call steps all environments at once and reads and writes only the caller's buffers.
+ * The rules are the game's: the flight model in flight_model.hpp and the win and loss checks of Game::update(),
+ * at a fixed 60 steps per second with the engine on. Wind is left out, the air is still. */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(YUME_ENV_BUILD)
+#    define YUME_ENV_API __declspec(dllexport)
+#  else
+#    define YUME_ENV_API __declspec(dllimport)
+#  endif
+#else
+#  define YUME_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* one row of floats per environment in the observation buffer */
+enum yume_env_observation {
+    YUME_OBS_X = 0,               /* rocket top left corner, pixels */
+    YUME_OBS_Y,
+    YUME_OBS_VELOCITY_X,          /* pixels per second */
+    YUME_OBS_VELOCITY_Y,
+    YUME_OBS_ROTATION,            /* degrees, 90 is upright */
+    YUME_OBS_ROTATIONAL_VELOCITY,
+    YUME_OBS_THRUST,
+    YUME_OBS_ISLAND_X,            /* island top left corner */
+    YUME_OBS_ISLAND_Y,
+    YUME_OBS_ISLAND_WIDTH,
+    YUME_OBS_ISLAND_HEIGHT,
+    YUME_OBS_ISLAND_VELOCITY_X,   /* the island oscillates on stages 2 to 4 */
+    YUME_OBS_STAGE,
+    YUME_OBS_GROUNDED,            /* 0 or 1 */
+    YUME_OBS_ON_ISLAND,           /* 0 or 1 */
+    YUME_OBS_LANDED_TIME,         /* seconds the rocket has stood safely on the island, past 3.9 it wins */
+    YUME_OBS_SIZE
+};
+
+/* two int32 per environment in the action buffer, each -1, 0 or 1 like the arrow keys */
+enum yume_env_action {
+    YUME_ACTION_THRUST = 0,       /* 1 throttles up, -1 throttles down */
+    YUME_ACTION_ROTATE,           /* -1 rotates left, 1 rotates right */
+    YUME_ACTION_SIZE
+};
+
+typedef struct yume_env yume_env;
+
+/* n_envs environments on the calling thread, null when n_envs is not positive or memory runs out */
+YUME_ENV_API yume_env* yume_env_create(int n_envs, uint64_t seed);
+/* the same with the environments split across threads, 0 threads uses every hardware thread */
+YUME_ENV_API yume_env* yume_env_create_threaded(int n_envs, uint64_t seed, int threads);
+YUME_ENV_API void yume_env_destroy(yume_env* env);
+
+YUME_ENV_API int yume_env_count(const yume_env* env);
+
+/* episodes that run this many steps end with done set and no reward, 3600 (a minute) by default, 0 never ends them */
+YUME_ENV_API void yume_env_set_max_steps(yume_env* env, int max_steps);
+
+/* Pixel accurate island collisions like the game, from the alpha channels of rocket.png and island.png
+ * (row major, one byte per pixel). Without them the island is its rectangle. Returns 0 on bad input. */
+YUME_ENV_API int yume_env_set_masks(yume_env* env, const uint8_t* rocket_alpha, int rocket_width, int rocket_height,
+    const uint8_t* island_alpha, int island_width, int island_height);
+
+/* starts every environment over at stage 0 and writes obs[n_envs * YUME_OBS_SIZE] */
+YUME_ENV_API void yume_env_reset(yume_env* env, float* obs);
+
+/* Applies actions[n_envs * YUME_ACTION_SIZE] and advances every environment by one step.
+ * reward[i] is 1 for a landing held long enough to win, -1 for a crash and 0 otherwise, done[i] is 1 when the
+ * episode ended. A finished environment starts its next attempt right away like the game does, a win moves it to
+ * the next stage and a loss keeps the stage, so obs then already holds the first state of the new episode. */
+YUME_ENV_API void yume_env_step(yume_env* env, const int32_t* actions, float* obs, float* reward, uint8_t* done);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
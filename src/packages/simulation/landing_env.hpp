@@ -0,0 +1,65 @@
+#ifndef YUME_LANDING_ENV
+#define YUME_LANDING_ENV
+
+#include "flight_model.hpp"
+#include "../jobs/job_system.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace yume {
+
+    // The state behind the C interface in landing_env.h, one array per field so a step streams through memory and
+    // writes the caller's buffers directly.
+    class LandingEnvs {
+    public:
+        static constexpr float step_time = 1.0f / 60.0f;
+
+        // threads 1 steps on the calling thread, 0 uses every hardware thread
+        LandingEnvs(int count_v, std::uint64_t seed, unsigned threads = 1);
+
+        int count() const;
+        void setMaxSteps(int steps);
+        bool setMasks(const AlphaImage& rocketAlpha, const AlphaImage& islandAlpha);
+
+        void reset(float* observations);
+        void step(const std::int32_t* actions, float* observations, float* rewards, std::uint8_t* dones);
+
+    private:
+        enum Flags : std::uint8_t {
+            flag_grounded = 1 << 0,
+            flag_on_island = 1 << 1,
+            flag_stable = 1 << 2,
+            flag_moving_right = 1 << 3,
+            flag_win_predict = 1 << 4,
+        };
+
+        int envCount;
+        int maxSteps{ 3600 };
+        std::unique_ptr<JobSystem> jobs;
+
+        // rocket
+        std::vector<float> x, y, velocityX, velocityY, previousX, previousY;
+        std::vector<float> rotation, rotationalVelocity, thrust;
+        // island
+        std::vector<float> islandX, islandY, leftBound, rightBound;
+        std::vector<std::int32_t> stage;
+        // rules
+        std::vector<float> winTimer;
+        std::vector<std::int32_t> steps;
+        std::vector<std::uint8_t> flags;
+        std::vector<std::uint64_t> random;
+
+        // one island mask per stage size, the shapes point into them
+        RotatedMaskSet rocketMasks;
+        std::vector<CollisionMask> islandMasks;
+        std::vector<CollisionShapes> shapes;
+
+        void startAttempt(int env, int nextStage);
+        void stepRange(int begin, int end, const std::int32_t* actions, float* observations, float* rewards, std::uint8_t* dones);
+        void observe(int env, float* row) const;
+    };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace yume {
+
+    namespace {
+        constexpr int snapshot_words = sizeof(GameSnapshot) / sizeof(std::uint32_t);
+        constexpr std::uint32_t keyframe_bytes = sizeof(GameSnapshot);
+        constexpr std::uint32_t max_delta_bytes = sizeof(std::uint64_t) + keyframe_bytes;
+    }
+
+    SnapshotHistory::SnapshotHistory(float seconds, float min_step_time, int keyframe_interval, std::size_t pool_bytes)
+        : windowSeconds(seconds), keyframeInterval(std::max(keyframe_interval, 1)) {
+        int capacity = std::max(2, static_cast<int>(std::ceil(seconds / min_step_time)));
+        entries.resize(capacity);
+
+        if (pool_bytes == 0) {
+            pool_bytes = static_cast<std::size_t>(capacity) * (sizeof(std::uint64_t) + keyframe_bytes / 2)
+                + static_cast<std::size_t>(capacity / keyframeInterval + 1) * keyframe_bytes;
+        }
+        // at least one keyframe and one full delta, or a push could never fit
+        pool.resize(std::max<std::size_t>(pool_bytes, keyframe_bytes + max_delta_bytes));
+    }
+
+    void SnapshotHistory::push(const GameSnapshot& snapshot, float delta_time) {
+        if (next - first == entries.size()) {
+            dropOldestGroup();
+        }
+        while (first < next && heldSeconds + delta_time > windowSeconds) {
+            dropOldestGroup();
+        }
+
+        bool keyframe = first == next || next - entry(next - 1).keySequence >= static_cast<std::uint64_t>(keyframeInterval);
+        std::uint64_t keySequence = keyframe ? next : entry(next - 1).keySequence;
+
+        std::uint32_t words[snapshot_words];
+        std::memcpy(words, &snapshot, sizeof(words));
+
+        // a delta is the mask of words that differ from the keyframe followed by their new values
+        std::uint8_t record[max_delta_bytes];
+        std::uint32_t size = 0;
+        if (keyframe) {
+            std::memcpy(record, words, keyframe_bytes);
+            size = keyframe_bytes;
+        }
+        else {
+            std::uint32_t keyWords[snapshot_words];
+            std::memcpy(keyWords, pool.data() + entry(keySequence).offset, sizeof(keyWords));
+
+            std::uint64_t mask = 0;
+            size = sizeof(mask);
+            for (int i = 0; i < snapshot_words; i++) {
+                if (words[i] != keyWords[i]) {
+                    mask |= std::uint64_t{ 1 } << i;
+                    std::memcpy(record + size, &words[i], sizeof(words[i]));
+                    size += sizeof(words[i]);
+                }
+            }
+            std::memcpy(record, &mask, sizeof(mask));
+        }
+
+        // making room can evict the keyframe this delta was coded against, it is stored whole then
+        std::uint32_t offset = reserve(size);
+        if (!keyframe && first > keySequence) {
+            keySequence = next;
+            std::memcpy(record, words, keyframe_bytes);
+            size = keyframe_bytes;
+            offset = reserve(size);
+        }
+
+        std::memcpy(pool.data() + offset, record, size);
+        entries[next % entries.size()] = Entry{ keySequence, offset, size, delta_time };
+        if (next > first) {
+            heldSeconds += delta_time;
+        }
+        head = offset + size;
+        used += size;
+        next += 1;
+    }
+
+    bool SnapshotHistory::restore(int steps_back, GameSnapshot& out) const {
+        if (steps_back < 0 || static_cast<std::uint64_t>(steps_back) >= next - first) {
+            return false;
+        }
+        decode(next - 1 - steps_back, out);
+        return true;
+    }
+
+    bool SnapshotHistory::rewind(int steps, GameSnapshot& out) {
+        if (first == next) {
+            return false;
+        }
+
+        // the oldest snapshot stays, rewinding stops there
+        for (int i = 0; i < steps && next - first > 1; i++) {
+            const Entry& newest = entry(next - 1);
+            head = newest.offset;
+            used -= newest.size;
+            heldSeconds -= newest.deltaTime;
+            next -= 1;
+        }
+
+        decode(next - 1, out);
+        return true;
+    }
+
+    void SnapshotHistory::clear() {
+        first = next;
+        head = 0;
+        used = 0;
+        heldSeconds = 0.0;
+    }
+
+    int SnapshotHistory::size() const {
+        return static_cast<int>(next - first);
+    }
+
+    float SnapshotHistory::seconds() const {
+        return static_cast<float>(heldSeconds);
+    }
+
+    float SnapshotHistory::capacitySeconds() const {
+        return windowSeconds;
+    }
+
+    std::size_t SnapshotHistory::usedBytes() const {
+        return used;
+    }
+
+    std::size_t SnapshotHistory::memoryBytes() const {
+        return entries.size() * sizeof(Entry) + pool.size();
+    }
+
+    float SnapshotHistory::bytesPerSecond() const {
+        float held = seconds();
+        return held > 0.0f ? used / held : 0.0f;
+    }
+
+    const SnapshotHistory::Entry& SnapshotHistory::entry(std::uint64_t sequence) const {
+        return entries[sequence % entries.size()];
+    }
+
+    bool SnapshotHistory::isKeyframe(std::uint64_t sequence) const {
+        return entry(sequence).keySequence == sequence;
+    }
+
+    // a keyframe leaves together with the deltas that need it
+    void SnapshotHistory::dropOldestGroup() {
+        do {
+            used -= entry(first).size;
+            first += 1;
+            // the new oldest entry's frame led up to a snapshot that is gone
+            if (first < next) {
+                heldSeconds -= entry(first).deltaTime;
+            }
+        } while (first < next && !isKeyframe(first));
+
+        if (first == next) {
+            head = 0;
+            heldSeconds = 0.0;
+        }
+    }
+
+    std::uint32_t SnapshotHistory::reserve(std::uint32_t bytes) {
+        for (;;) {
+            if (first == next) {
+                head = 0;
+                return 0;
+            }
+
+            std::size_t tail = entry(first).offset;
+            if (head > tail) {
+                // live records sit in [tail, head), the space after head and before tail is free
+                if (head + bytes <= pool.size()) return static_cast<std::uint32_t>(head);
+                if (bytes <= tail) return 0;
+            }
+            else if (head < tail) {
+                // wrapped, only [head, tail) is free
+                if (head + bytes <= tail) return static_cast<std::uint32_t>(head);
+            }
+
+            dropOldestGroup();
+        }
+    }
+
+    void SnapshotHistory::decode(std::uint64_t sequence, GameSnapshot& out) const {
+        const Entry& target = entry(sequence);
+        std::uint32_t words[snapshot_words];
+        std::memcpy(words, pool.data() + entry(target.keySequence).offset, sizeof(words));
+
+        if (target.keySequence != sequence) {
+            const std::uint8_t* record = pool.data() + target.offset;
+            std::uint64_t mask;
+            std::memcpy(&mask, record, sizeof(mask));
+            record += sizeof(mask);
+
+            for (int i = 0; i < snapshot_words; i++) {
+                if (mask & (std::uint64_t{ 1 } << i)) {
+                    std::memcpy(&words[i], record, sizeof(words[i]));
+                    record += sizeof(words[i]);
+                }
+            }
+        }
+
+        std::memcpy(static_cast<void*>(&out), words, sizeof(words));
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef YUME_SNAPSHOT
+#define YUME_SNAPSHOT
+
+#include "flight_model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yume {
+
+    constexpr std::uint32_t snapshot_moving_right = 1u << 0;
+    constexpr std::uint32_t snapshot_win = 1u << 1;
+    constexpr std::uint32_t snapshot_win_predict = 1u << 2;
+    constexpr std::uint32_t snapshot_lost = 1u << 3;
+    constexpr std::uint32_t snapshot_engine_notification = 1u << 4;
+
+    // Everything Game::update() reads from one frame to the next. Only 4 byte fields and no padding,
+    // so two snapshots can be compared and delta coded word by word.
+    struct GameSnapshot {
+        RocketState rocket;
+
+        vec2<float> islandPosition;
+        vec2<float> islandSize;
+        vec2<float> airstripSize;
+        float islandLeftBound;
+        float islandRightBound;
+        std::int32_t islandStage;
+
+        float timer;
+        float winTimer;
+        float restartTimer;
+        float attractRestartTimer;
+        float flightTime;
+        std::int32_t winStreak;
+        std::uint32_t attempt;
+        std::uint32_t flags;
+    };
+
+    static_assert(sizeof(GameSnapshot) % sizeof(std::uint32_t) == 0, "snapshots are delta coded in 32 bit words");
+    static_assert(sizeof(GameSnapshot) / sizeof(std::uint32_t) <= 64, "the changed word mask is a single 64 bit word");
+
+    // The last few seconds of snapshots in memory allocated once. Every keyframe_interval-th snapshot is stored whole,
+    // the others as the words that differ from their keyframe, so reading any of them back is one copy and one patch.
+    // Each snapshot keeps the length of the frame it ends, so the history covers seconds of play whatever the frame
+    // rate. When the byte pool or the entries fill up the oldest keyframe and its deltas are dropped, the history
+    // then covers less time but never grows.
+    class SnapshotHistory {
+    public:
+        // min_step_time is the shortest frame the entries are sized for, shorter ones cover less than seconds.
+        // pool_bytes 0 sizes the pool for deltas of half a snapshot on average
+        SnapshotHistory(float seconds, float min_step_time, int keyframe_interval = 60, std::size_t pool_bytes = 0);
+
+        // delta_time is how long the frame that ended in snapshot took
+        void push(const GameSnapshot& snapshot, float delta_time);
+        // the snapshot steps_back pushes ago, 0 is the newest, false when the history does not reach that far
+        bool restore(int steps_back, GameSnapshot& out) const;
+        // drops the newest steps snapshots and restores the one that is newest afterwards
+        bool rewind(int steps, GameSnapshot& out);
+        void clear();
+
+        int size() const;
+        float seconds() const;
+        float capacitySeconds() const;
+        std::size_t usedBytes() const;
+        std::size_t memoryBytes() const;  // everything allocated, fixed at construction
+        float bytesPerSecond() const;     // pool bytes the current history takes per second of it
+
+    private:
+        struct Entry {
+            std::uint64_t keySequence;  // the keyframe the delta is against, its own sequence for a keyframe
+            std::uint32_t offset;
+            std::uint32_t size;
+            float deltaTime;
+        };
+
+        float windowSeconds;
+        int keyframeInterval;
+        double heldSeconds{ 0.0 };  // the delta times of every entry but the oldest, which is where a rewind stops
+
+        std::vector<Entry> entries;
+        std::uint64_t first{ 0 };  // sequence number of the oldest entry
+        std::uint64_t next{ 0 };   // sequence number the next push gets
+
+        // records are contiguous, one that does not fit before the end starts over at 0
+        std::vector<std::uint8_t> pool;
+        std::size_t head{ 0 };  // where the record after the newest starts
+        std::size_t used{ 0 };
+
+        const Entry& entry(std::uint64_t sequence) const;
+        bool isKeyframe(std::uint64_t sequence) const;
+        void dropOldestGroup();
+        std::uint32_t reserve(std::uint32_t bytes);
+        void decode(std::uint64_t sequence, GameSnapshot& out) const;
+    };
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include "trajectory.hpp"
+
+#include <chrono>
+
+namespace yume {
+
+    namespace {
+        // how far the real flight may drift from the prediction before it is rebuilt
+        constexpr float position_tolerance = 2.0f;
+        constexpr float rotation_tolerance = 1.5f;
+        constexpr float rotational_velocity_tolerance = 1.0f;
+    }
+
+    void TrajectoryPredictor::update(const RocketState& rocket, const IslandState& island, float deltaTime) {
+        using clock = std::chrono::steady_clock;
+        clock::time_point start = clock::now();
+
+        if (rocket.grounded) {
+            reset();
+        }
+        else {
+            reused = advance(rocket, island, deltaTime);
+            if (!reused) {
+                rebuild(rocket, island);
+            }
+            extend();
+        }
+
+        updateMs = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+    }
+
+    void TrajectoryPredictor::reset() {
+        valid = false;
+        count = 0;
+        head = 0;
+        ended = false;
+        result = LandingVerdict::None;
+        reused = false;
+    }
+
+    int TrajectoryPredictor::size() const {
+        return count;
+    }
+
+    const TrajectorySample& TrajectoryPredictor::sample(int index) const {
+        return samples[(head + index) % max_samples];
+    }
+
+    LandingVerdict TrajectoryPredictor::verdict() const {
+        return result;
+    }
+
+    vec2<float> TrajectoryPredictor::impactPoint() const {
+        return impact;
+    }
+
+    float TrajectoryPredictor::impactSpeed() const {
+        return speed;
+    }
+
+    bool TrajectoryPredictor::reusedLastFrame() const {
+        return reused;
+    }
+
+    float TrajectoryPredictor::lastUpdateMs() const {
+        return updateMs;
+    }
+
+    // Drops the samples the real flight has moved past, false when the prediction no longer describes it.
+    bool TrajectoryPredictor::advance(const RocketState& rocket, const IslandState& island, float deltaTime) {
+        if (!valid || rocket.thrust != tailRocket.thrust || rocket.engine_enable != tailRocket.engine_enable
+            || rocket.gravity != tailRocket.gravity || island.stage != tailIsland.stage) {
+            return false;
+        }
+
+        elapsed += deltaTime;
+        int target = static_cast<int>(std::lround(elapsed / step_time));
+        int steps = target - consumed;
+        if (steps >= count) {
+            return false;
+        }
+
+        head = (head + steps) % max_samples;
+        count -= steps;
+        consumed = target;
+
+        const TrajectorySample& now = samples[head];
+        return std::abs(now.position.x - rocket.position.x) <= position_tolerance
+            && std::abs(now.position.y - rocket.position.y) <= position_tolerance
+            && std::abs(now.rotation - rocket.rotation) <= rotation_tolerance
+            && std::abs(now.rotationalVelocity - rocket.rotationalVelocity) <= rotational_velocity_tolerance
+            && std::abs(now.islandX - island.position.x) <= position_tolerance;
+    }
+
+    void TrajectoryPredictor::rebuild(const RocketState& rocket, const IslandState& island) {
+        valid = true;
+        head = 0;
+        count = 0;
+        elapsed = 0.0f;
+        consumed = 0;
+        ended = false;
+        result = LandingVerdict::None;
+
+        tailRocket = rocket;
+        tailIsland = island;
+        push(rocket, island);
+    }
+
+    void TrajectoryPredictor::extend() {
+        while (!ended && count < max_samples) {
+            stepFlight(tailRocket, tailIsland, step_time);
+            push(tailRocket, tailIsland);
+
+            if (tailRocket.grounded) {
+                ended = true;
+                impact = tailRocket.position;
+                speed = tailRocket.previousVelocity.length();
+
+                if (isSafeLanding(tailRocket)) result = LandingVerdict::Safe;
+                else if (isCrash(tailRocket)) result = LandingVerdict::Crash;
+                else result = LandingVerdict::Missed;
+            }
+        }
+    }
+
+    void TrajectoryPredictor::push(const RocketState& rocket, const IslandState& island) {
+        samples[(head + count) % max_samples] = TrajectorySample{ rocket.position, rocket.velocity, rocket.rotation, rocket.rotationalVelocity, island.position.x };
+        count += 1;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef YUME_TRAJECTORY
+#define YUME_TRAJECTORY
+
+#include "flight_model.hpp"
+
+#include <array>
+
+namespace yume {
+
+    enum class LandingVerdict { None, Safe, Crash, Missed };
+
+    struct TrajectorySample {
+        vec2<float> position;
+        vec2<float> velocity;
+        float rotation;
+        float rotationalVelocity;
+        float islandX;
+    };
+
+    // Flies the rocket forward with the current thrust held and no further input until it touches down or the
+    // horizon runs out. While the real flight keeps following the prediction the samples already flown are
+    // dropped and only the tail is extended, a new input or a drift past the tolerances rebuilds it.
+    class TrajectoryPredictor {
+    public:
+        static constexpr int max_samples = 300;
+        static constexpr float step_time = 1.0f / 60.0f;
+
+        void update(const RocketState& rocket, const IslandState& island, float deltaTime);
+        void reset();
+
+        // sample 0 is the current frame
+        int size() const;
+        const TrajectorySample& sample(int index) const;
+
+        LandingVerdict verdict() const;
+        vec2<float> impactPoint() const;  // where the rocket touches down, top left like RocketState::position
+        float impactSpeed() const;
+
+        bool reusedLastFrame() const;
+        float lastUpdateMs() const;
+
+    private:
+        std::array<TrajectorySample, max_samples> samples{};
+        int head{ 0 };
+        int count{ 0 };
+        bool valid{ false };
+
+        // state after the newest sample, extend() continues from here
+        RocketState tailRocket{};
+        IslandState tailIsland{};
+        bool ended{ false };
+
+        float elapsed{ 0.0f };
+        int consumed{ 0 };
+
+        LandingVerdict result{ LandingVerdict::None };
+        vec2<float> impact{ 0, 0 };
+        float speed{ 0.0f };
+
+        bool reused{ false };
+        float updateMs{ 0.0f };
+
+        bool advance(const RocketState& rocket, const IslandState& island, float deltaTime);
+        void rebuild(const RocketState& rocket, const IslandState& island);
+        void extend();
+        void push(const RocketState& rocket, const IslandState& island);
+    };
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef YUME_VERSUS
+#define YUME_VERSUS
+
+#include "flight_model.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace yume {
+
+    constexpr int versus_max_pilots = 4;
+    constexpr float versus_respawn_delay = 2.0f;  // a crashed pilot sits out this long
+
+    // one pilot's controls for one step, a byte so a network packet carries dozens of them
+    using VersusInput = std::uint8_t;
+    constexpr VersusInput versus_thrust_up = 1u << 0;
+    constexpr VersusInput versus_thrust_down = 1u << 1;
+    constexpr VersusInput versus_rotate_left = 1u << 2;
+    constexpr VersusInput versus_rotate_right = 1u << 3;
+
+    struct VersusPilot {
+        RocketState rocket;
+        vec2<float> pad;
+        std::int32_t score;
+        float landedTime;    // how long the current safe landing has been held
+        float respawnTimer;  // counts down while the wreck is shown
+    };
+
+    // The split screen race as plain data, stepVersus() reads no clock, keyboard or global random generator. Two
+    // machines that step the same state with the same inputs end up with the same state, which is what the
+    // rollback session saves, restores and re-simulates.
+    struct VersusState {
+        std::array<VersusPilot, versus_max_pilots> pilots;
+        std::int32_t pilotCount;
+        vec2<float> islandPosition;
+        vec2<float> islandSize;
+        float islandLeftBound;
+        float islandRightBound;
+        std::int32_t islandStage;
+        bool movingRight;
+        std::uint32_t placements;  // how often the island was put somewhere new, a renderer redraws it when this changes
+        std::uint32_t random;      // xorshift state, where the island goes next is part of what a rollback restores
+        std::uint32_t tick;
+    };
+
+    // Collision masks for every stage. The island's size only depends on the stage, so these cover every state
+    // and both machines test against the same pixels whichever tick they re-simulate.
+    struct VersusShapes {
+        const RotatedMaskSet* rocket{ nullptr };
+        std::array<CollisionMask, final_stage + 1> island;
+    };
+
+    inline std::uint32_t versusRandom(VersusState& state) {
+        std::uint32_t x = state.random;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state.random = x;
+        return x;
+    }
+
+    inline void placeVersusIsland(VersusState& state) {
+        std::uint32_t spanX = static_cast<std::uint32_t>(island_spawn_right - island_spawn_left + 1);
+        std::uint32_t spanY = static_cast<std::uint32_t>(island_spawn_bottom - island_spawn_top + 1);
+        state.islandPosition = vec2<float>(static_cast<float>(island_spawn_left + static_cast<int>(versusRandom(state) % spanX)),
+            static_cast<float>(island_spawn_top + static_cast<int>(versusRandom(state) % spanY)));
+        state.islandSize = islandSizeAtStage(state.islandStage);
+        state.islandLeftBound = state.islandPosition.x - 50.0f;
+        state.islandRightBound = state.islandPosition.x + 50.0f;
+        state.placements += 1;
+
+        // whoever was sitting on the old spot has to fly to the new one
+        for (VersusPilot& pilot : state.pilots) {
+            pilot.landedTime = 0.0f;
+        }
+    }
+
+    inline void respawnVersusPilot(VersusState& state, int pilot) {
+        VersusPilot& current = state.pilots[pilot];
+        current.rocket = RocketState{ current.pad, vec2<float>(32, 64), vec2<float>::ZERO(), vec2<float>::ZERO(), 90, 0, 9.81f, 0,
+            false, false, true, true };
+        current.landedTime = 0.0f;
+        current.respawnTimer = 0.0f;
+    }
+
+    // the pads sit side by side right of the island's range, the seed picks the island positions
+    inline VersusState startVersus(int pilotCount, std::uint32_t seed) {
+        VersusState state{};
+        state.pilotCount = pilotCount < 1 ? 1 : (pilotCount > versus_max_pilots ? versus_max_pilots : pilotCount);
+        state.random = seed != 0 ? seed : 0x9E3779B9u;
+        for (int i = 0; i < versus_max_pilots; i++) {
+            state.pilots[i].pad = vec2<float>(500.0f + 40.0f * i, 410.0f);
+            respawnVersusPilot(state, i);
+        }
+        placeVersusIsland(state);
+        return state;
+    }
+
+    inline IslandState versusIsland(const VersusState& state, const CollisionShapes* shapes) {
+        return IslandState{ state.islandPosition, state.islandSize, state.islandLeftBound, state.islandRightBound, state.movingRight,
+            state.islandStage, shapes };
+    }
+
+    inline void applyVersusInput(RocketState& rocket, VersusInput input) {
+        if (input & versus_thrust_up) {
+            increaseThrust(rocket);
+        }
+        else if (input & versus_thrust_down) {
+            decreaseThrust(rocket);
+        }
+
+        if (input & versus_rotate_left) {
+            rotateLeft(rocket);
+        }
+        else if (input & versus_rotate_right) {
+            rotateRight(rocket);
+        }
+    }
+
+    // One step of the race, inputs holds one entry per pilot. A landing held for landing_hold_time scores and moves
+    // the island on for everyone, the island only oscillates while nobody stands on it.
+    inline void stepVersus(VersusState& state, const VersusInput* inputs, float deltaTime, const VersusShapes* shapes = nullptr) {
+        bool anyOnIsland = false;
+
+        for (int i = 0; i < state.pilotCount; i++) {
+            VersusPilot& pilot = state.pilots[i];
+            RocketState& rocket = pilot.rocket;
+
+            if (pilot.respawnTimer > 0.0f) {
+                pilot.respawnTimer -= deltaTime;
+                if (pilot.respawnTimer <= 0.0f) {
+                    respawnVersusPilot(state, i);
+                }
+                continue;
+            }
+
+            applyVersusInput(rocket, inputs[i]);
+            stepRocket(rocket, deltaTime);
+            if (state.islandStage <= final_stage) {
+                CollisionShapes stageShapes{ nullptr, nullptr };
+                if (shapes != nullptr && shapes->rocket != nullptr) {
+                    stageShapes = CollisionShapes{ shapes->rocket, &shapes->island[state.islandStage] };
+                }
+                collideIsland(rocket, versusIsland(state, stageShapes.rocket != nullptr ? &stageShapes : nullptr));
+            }
+            applyGroundHazards(rocket);
+
+            if (isSafeLanding(rocket)) {
+                pilot.landedTime += deltaTime;
+                if (pilot.landedTime > landing_hold_time) {
+                    pilot.score += 1;
+                    state.islandStage = state.islandStage < final_stage ? state.islandStage + 1 : final_stage;
+                    placeVersusIsland(state);
+                    respawnVersusPilot(state, i);
+                    continue;
+                }
+            }
+            else {
+                pilot.landedTime = 0.0f;
+                if (isCrash(rocket)) {
+                    pilot.respawnTimer = versus_respawn_delay;
+                    continue;
+                }
+            }
+            anyOnIsland = anyOnIsland || rocket.on_island;
+        }
+
+        IslandState island = versusIsland(state, nullptr);
+        moveIsland(island, anyOnIsland, deltaTime);
+        state.islandPosition = island.position;
+        state.movingRight = island.movingRight;
+        state.tick += 1;
+    }
+
+    // FNV-1a over every field, not over the bytes of the struct, so padding after the bools never counts
+    class VersusHasher {
+    public:
+        void add(std::uint32_t value) {
+            for (int i = 0; i < 4; i++) {
+                hash = (hash ^ ((value >> (i * 8)) & 0xFFu)) * 1099511628211ull;
+            }
+        }
+        void add(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            add(bits);
+        }
+        void add(vec2<float> value) {
+            add(value.x);
+            add(value.y);
+        }
+        std::uint64_t value() const { return hash; }
+
+    private:
+        std::uint64_t hash{ 14695981039346656037ull };
+    };
+
+    inline std::uint64_t versusChecksum(const VersusState& state) {
+        VersusHasher hasher;
+        for (int i = 0; i < state.pilotCount; i++) {
+            const VersusPilot& pilot = state.pilots[i];
+            const RocketState& rocket = pilot.rocket;
+            hasher.add(rocket.position);
+            hasher.add(rocket.velocity);
+            hasher.add(rocket.previousVelocity);
+            hasher.add(rocket.rotation);
+            hasher.add(rocket.thrust);
+            hasher.add(rocket.rotationalVelocity);
+            hasher.add(static_cast<std::uint32_t>(rocket.grounded) | static_cast<std::uint32_t>(rocket.on_island) << 1
+                | static_cast<std::uint32_t>(rocket.is_stable) << 2 | static_cast<std::uint32_t>(rocket.engine_enable) << 3);
+            hasher.add(static_cast<std::uint32_t>(pilot.score));
+            hasher.add(pilot.landedTime);
+            hasher.add(pilot.respawnTimer);
+        }
+        hasher.add(state.islandPosition);
+        hasher.add(static_cast<std::uint32_t>(state.islandStage));
+        hasher.add(static_cast<std::uint32_t>(state.movingRight));
+        hasher.add(state.random);
+        hasher.add(state.tick);
+        return hasher.value();
+    }
+}
+
+#endif
@@ -0,0 +1,398 @@
+#include "wind_field.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define YUME_WIND_SSE 1
+#endif
+
+namespace yume {
+
+    namespace {
+        constexpr float viscosity = 0.4f;         // cells squared per second
+        constexpr float damping = 0.35f;          // the share of the wind the field loses per second
+        constexpr float gust_pull = 0.8f;         // how fast a band approaches its gust speed, per second
+        constexpr float max_step_time = 1.0f / 20.0f;
+
+        // dst = (b + a * (left + right + up + down)) * inverse for the inner cells of one row
+        void jacobiRow(float* dst, const float* b, const float* center, const float* up, const float* down, float a, float inverse, int columns) {
+            int x = 1;
+#if defined(YUME_WIND_SSE)
+            __m128 scale = _mm_set1_ps(a);
+            __m128 normalize = _mm_set1_ps(inverse);
+            for (; x + 4 <= columns - 1; x += 4) {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(center + x - 1), _mm_loadu_ps(center + x + 1)),
+                    _mm_add_ps(_mm_loadu_ps(up + x), _mm_loadu_ps(down + x)));
+                __m128 value = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(b + x), _mm_mul_ps(scale, sum)), normalize);
+                _mm_storeu_ps(dst + x, value);
+            }
+#endif
+            for (; x < columns - 1; x++) {
+                dst[x] = (b[x] + a * (center[x - 1] + center[x + 1] + up[x] + down[x])) * inverse;
+            }
+        }
+
+        // divergence = -0.5 * (x right - x left + y down - y up) for the inner cells of one row
+        void divergenceRow(float* dst, const float* x, const float* yUp, const float* yDown, int columns) {
+            int column = 1;
+#if defined(YUME_WIND_SSE)
+            __m128 half = _mm_set1_ps(-0.5f);
+            for (; column + 4 <= columns - 1; column += 4) {
+                __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + column + 1), _mm_loadu_ps(x + column - 1));
+                __m128 dy = _mm_sub_ps(_mm_loadu_ps(yDown + column), _mm_loadu_ps(yUp + column));
+                _mm_storeu_ps(dst + column, _mm_mul_ps(half, _mm_add_ps(dx, dy)));
+            }
+#endif
+            for (; column < columns - 1; column++) {
+                dst[column] = -0.5f * (x[column + 1] - x[column - 1] + yDown[column] - yUp[column]);
+            }
+        }
+
+        // subtracts the pressure gradient from the inner cells of one row
+        void gradientRow(float* x, float* y, const float* p, const float* pUp, const float* pDown, int columns) {
+            int column = 1;
+#if defined(YUME_WIND_SSE)
+            __m128 half = _mm_set1_ps(0.5f);
+            for (; column + 4 <= columns - 1; column += 4) {
+                __m128 dx = _mm_sub_ps(_mm_loadu_ps(p + column + 1), _mm_loadu_ps(p + column - 1));
+                __m128 dy = _mm_sub_ps(_mm_loadu_ps(pDown + column), _mm_loadu_ps(pUp + column));
+                _mm_storeu_ps(x + column, _mm_sub_ps(_mm_loadu_ps(x + column), _mm_mul_ps(half, dx)));
+                _mm_storeu_ps(y + column, _mm_sub_ps(_mm_loadu_ps(y + column), _mm_mul_ps(half, dy)));
+            }
+#endif
+            for (; column < columns - 1; column++) {
+                x[column] -= 0.5f * (p[column + 1] - p[column - 1]);
+                y[column] -= 0.5f * (pDown[column] - pUp[column]);
+            }
+        }
+
+        // semi-Lagrangian advection of the inner cells of one row, every cell pulls its value from where the wind
+        // carried it from. The corners are gathered one lane at a time, the rest is four cells at once
+        void advectRow(float* outX, float* outY, const float* inX, const float* inY, int row, int columns, float scale, float maxX, float maxY) {
+            const float* rowX = inX + row * columns;
+            const float* rowY = inY + row * columns;
+            int column = 1;
+#if defined(YUME_WIND_SSE)
+            __m128 step = _mm_set1_ps(scale);
+            __m128 low = _mm_set1_ps(0.5f);
+            __m128 highX = _mm_set1_ps(maxX);
+            __m128 highY = _mm_set1_ps(maxY);
+            __m128 width = _mm_set1_ps(static_cast<float>(columns));
+            __m128 one = _mm_set1_ps(1.0f);
+            __m128 y = _mm_set1_ps(static_cast<float>(row));
+            alignas(16) int corner[4];
+
+            for (; column + 4 <= columns - 1; column += 4) {
+                __m128 x = _mm_setr_ps(static_cast<float>(column), static_cast<float>(column + 1), static_cast<float>(column + 2), static_cast<float>(column + 3));
+                __m128 fromX = _mm_min_ps(_mm_max_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_loadu_ps(rowX + column), step)), low), highX);
+                __m128 fromY = _mm_min_ps(_mm_max_ps(_mm_sub_ps(y, _mm_mul_ps(_mm_loadu_ps(rowY + column), step)), low), highY);
+
+                // positions are clamped positive, truncation is the floor
+                __m128 x0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(fromX));
+                __m128 y0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(fromY));
+                __m128 fx = _mm_sub_ps(fromX, x0);
+                __m128 fy = _mm_sub_ps(fromY, y0);
+                __m128 gx = _mm_sub_ps(one, fx);
+                __m128 gy = _mm_sub_ps(one, fy);
+                _mm_store_si128(reinterpret_cast<__m128i*>(corner), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(y0, width), x0)));
+
+                const float* in[2] = { inX, inY };
+                float* out[2] = { outX, outY };
+                for (int field = 0; field < 2; field++) {
+                    const float* f = in[field];
+                    __m128 topLeft = _mm_setr_ps(f[corner[0]], f[corner[1]], f[corner[2]], f[corner[3]]);
+                    __m128 topRight = _mm_setr_ps(f[corner[0] + 1], f[corner[1] + 1], f[corner[2] + 1], f[corner[3] + 1]);
+                    __m128 bottomLeft = _mm_setr_ps(f[corner[0] + columns], f[corner[1] + columns], f[corner[2] + columns], f[corner[3] + columns]);
+                    __m128 bottomRight = _mm_setr_ps(f[corner[0] + columns + 1], f[corner[1] + columns + 1], f[corner[2] + columns + 1], f[corner[3] + columns + 1]);
+                    __m128 top = _mm_add_ps(_mm_mul_ps(topLeft, gx), _mm_mul_ps(topRight, fx));
+                    __m128 bottom = _mm_add_ps(_mm_mul_ps(bottomLeft, gx), _mm_mul_ps(bottomRight, fx));
+                    _mm_storeu_ps(out[field] + row * columns + column, _mm_add_ps(_mm_mul_ps(top, gy), _mm_mul_ps(bottom, fy)));
+                }
+            }
+#endif
+            for (; column < columns - 1; column++) {
+                float fromX = std::clamp(column - rowX[column] * scale, 0.5f, maxX);
+                float fromY = std::clamp(row - rowY[column] * scale, 0.5f, maxY);
+                int x0 = static_cast<int>(fromX);
+                int y0 = static_cast<int>(fromY);
+                float fx = fromX - x0;
+                float fy = fromY - y0;
+
+                const float* in[2] = { inX, inY };
+                float* out[2] = { outX, outY };
+                for (int field = 0; field < 2; field++) {
+                    const float* top = in[field] + y0 * columns + x0;
+                    const float* bottom = top + columns;
+                    out[field][row * columns + column] = (top[0] * (1.0f - fx) + top[1] * fx) * (1.0f - fy) + (bottom[0] * (1.0f - fx) + bottom[1] * fx) * fy;
+                }
+            }
+        }
+
+        float bilinear(const std::vector<float>& field, int columns, float x, float y) {
+            int x0 = static_cast<int>(x);
+            int y0 = static_cast<int>(y);
+            float fx = x - x0;
+            float fy = y - y0;
+
+            const float* top = field.data() + y0 * columns + x0;
+            const float* bottom = top + columns;
+            return (top[0] * (1.0f - fx) + top[1] * fx) * (1.0f - fy) + (bottom[0] * (1.0f - fx) + bottom[1] * fx) * fy;
+        }
+
+        // gusts grow with the stage, the calm first stages keep the early game as it was
+        struct StageWeather {
+            float strength;
+            bool fromLeft;
+            bool fromRight;
+            float period;
+        };
+
+        constexpr StageWeather stage_weather[] = {
+            { 0.0f, false, false, 1.0f },
+            { 0.0f, false, false, 1.0f },
+            { 0.0f, false, false, 1.0f },
+            { 25.0f, true, false, 9.0f },
+            { 35.0f, true, false, 8.0f },
+            { 45.0f, false, true, 7.0f },
+            { 55.0f, false, true, 6.0f },
+            { 65.0f, true, true, 6.0f },
+            { 75.0f, true, true, 5.0f },
+            { 85.0f, true, true, 4.0f },
+        };
+    }
+
+    WindField::WindField(int columns_v, int rows_v, float cell_size, JobSystem* jobs_v)
+        : cols(std::max(columns_v, 4)), rowCount(std::max(rows_v, 4)), cellSize(cell_size), jobs(jobs_v) {
+        std::size_t cells = static_cast<std::size_t>(cols) * rowCount;
+        u.assign(cells, 0.0f);
+        v.assign(cells, 0.0f);
+        uPrevious.assign(cells, 0.0f);
+        vPrevious.assign(cells, 0.0f);
+        pressure.assign(cells, 0.0f);
+        pressureScratch.assign(cells, 0.0f);
+        divergence.assign(cells, 0.0f);
+        gusts.reserve(2);
+    }
+
+    void WindField::setStage(int stage) {
+        gusts.clear();
+
+        const StageWeather& weather = stage_weather[std::clamp(stage, 0, static_cast<int>(std::size(stage_weather)) - 1)];
+        if (weather.strength <= 0.0f) {
+            return;
+        }
+
+        float height = rowCount * cellSize;
+        if (weather.fromLeft) {
+            gusts.push_back(GustSource{ height * 0.3f, height * 0.15f, { weather.strength, 0.0f }, weather.period });
+        }
+        if (weather.fromRight) {
+            gusts.push_back(GustSource{ height * 0.6f, height * 0.15f, { -weather.strength, 0.0f }, weather.period * 1.3f });
+        }
+    }
+
+    void WindField::addVelocity(vec2<float> position, vec2<float> velocity, float radius, float deltaTime) {
+        float centerX = position.x / cellSize - 0.5f;
+        float centerY = position.y / cellSize - 0.5f;
+        float cellRadius = std::max(radius / cellSize, 1.0f);
+
+        int left = std::max(1, static_cast<int>(std::floor(centerX - cellRadius)));
+        int right = std::min(cols - 2, static_cast<int>(std::ceil(centerX + cellRadius)));
+        int top = std::max(1, static_cast<int>(std::floor(centerY - cellRadius)));
+        int bottom = std::min(rowCount - 2, static_cast<int>(std::ceil(centerY + cellRadius)));
+
+        // a soft disc so the splat does not leave a square imprint
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                float dx = (x - centerX) / cellRadius;
+                float dy = (y - centerY) / cellRadius;
+                float weight = 1.0f - (dx * dx + dy * dy);
+                if (weight > 0.0f) {
+                    u[index(x, y)] += velocity.x * weight * deltaTime;
+                    v[index(x, y)] += velocity.y * weight * deltaTime;
+                }
+            }
+        }
+    }
+
+    void WindField::applyGust(const GustSource& gust, float deltaTime) {
+        float swell = 0.5f + 0.5f * std::sin(time * 2.0f * static_cast<float>(flight_pi) / gust.period);
+        float targetX = gust.velocity.x * swell;
+        float targetY = gust.velocity.y * swell;
+
+        float center = gust.height / cellSize - 0.5f;
+        float half = std::max(gust.halfHeight / cellSize, 1.0f);
+        int top = std::max(1, static_cast<int>(std::floor(center - half)));
+        int bottom = std::min(rowCount - 2, static_cast<int>(std::ceil(center + half)));
+
+        for (int y = top; y <= bottom; y++) {
+            float offset = (y - center) / half;
+            float pull = (1.0f - offset * offset) * gust_pull * deltaTime;
+            if (pull <= 0.0f) {
+                continue;
+            }
+            float* rowX = u.data() + y * cols;
+            float* rowY = v.data() + y * cols;
+            for (int x = 1; x < cols - 1; x++) {
+                rowX[x] += (targetX - rowX[x]) * pull;
+                rowY[x] += (targetY - rowY[x]) * pull;
+            }
+        }
+    }
+
+    void WindField::step(float deltaTime) {
+        using clock = std::chrono::steady_clock;
+        clock::time_point start = clock::now();
+
+        // a hitch would advect across half the screen at once
+        deltaTime = std::min(deltaTime, max_step_time);
+        time += deltaTime;
+
+        for (const GustSource& gust : gusts) {
+            applyGust(gust, deltaTime);
+        }
+
+        diffuse(deltaTime);
+        project(uPrevious, vPrevious);
+        advect(u, v, uPrevious, vPrevious, deltaTime);
+        project(u, v);
+
+        float keep = std::max(0.0f, 1.0f - damping * deltaTime);
+        for (std::size_t i = 0; i < u.size(); i++) {
+            u[i] *= keep;
+            v[i] *= keep;
+        }
+
+        stepMs = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+    }
+
+    void WindField::clear() {
+        std::fill(u.begin(), u.end(), 0.0f);
+        std::fill(v.begin(), v.end(), 0.0f);
+        std::fill(pressure.begin(), pressure.end(), 0.0f);
+        time = 0.0f;
+    }
+
+    vec2<float> WindField::sample(vec2<float> position) const {
+        float x = position.x / cellSize - 0.5f;
+        float y = position.y / cellSize - 0.5f;
+        if (x < 0.0f || y < 0.0f || x >= cols - 1 || y >= rowCount - 1) {
+            return vec2<float>(0.0f, 0.0f);
+        }
+        return vec2<float>(bilinear(u, cols, x, y), bilinear(v, cols, x, y));
+    }
+
+    int WindField::columns() const {
+        return cols;
+    }
+
+    int WindField::rows() const {
+        return rowCount;
+    }
+
+    float WindField::lastStepMs() const {
+        return stepMs;
+    }
+
+    // inner rows 1 .. rows - 2, in bands on the job system when there is one
+    template<typename F>
+    void WindField::forRows(F&& body) {
+        if (jobs == nullptr) {
+            body(1, rowCount - 1);
+            return;
+        }
+        jobs->parallelFor(static_cast<std::size_t>(rowCount - 2), 8, [&](std::size_t begin, std::size_t end) {
+            body(static_cast<int>(begin) + 1, static_cast<int>(end) + 1);
+        });
+    }
+
+    void WindField::jacobi(std::vector<float>& x, std::vector<float>& scratch, const std::vector<float>& b, float a, float inverse, bool velocity, int iterations) {
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            forRows([&](int begin, int end) {
+                for (int y = begin; y < end; y++) {
+                    const float* center = x.data() + y * cols;
+                    jacobiRow(scratch.data() + y * cols, b.data() + y * cols, center, center - cols, center + cols, a, inverse, cols);
+                }
+            });
+
+            x.swap(scratch);
+            if (velocity) setVelocityBounds(x);
+            else setPressureBounds(x);
+        }
+    }
+
+    void WindField::diffuse(float deltaTime) {
+        float a = deltaTime * viscosity;
+        float inverse = 1.0f / (1.0f + 4.0f * a);
+
+        uPrevious = u;
+        vPrevious = v;
+        jacobi(uPrevious, pressureScratch, u, a, inverse, true, diffuse_iterations);
+        jacobi(vPrevious, pressureScratch, v, a, inverse, true, diffuse_iterations);
+    }
+
+    // removes the divergent part so the wind swirls instead of piling up
+    void WindField::project(std::vector<float>& x, std::vector<float>& y) {
+        forRows([&](int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                const float* yRow = y.data() + row * cols;
+                divergenceRow(divergence.data() + row * cols, x.data() + row * cols, yRow - cols, yRow + cols, cols);
+            }
+        });
+        setPressureBounds(divergence);
+
+        // starts from the last solve, the pressure changes little between two projections
+        jacobi(pressure, pressureScratch, divergence, 1.0f, 0.25f, false, pressure_iterations);
+
+        forRows([&](int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                const float* p = pressure.data() + row * cols;
+                gradientRow(x.data() + row * cols, y.data() + row * cols, p, p - cols, p + cols, cols);
+            }
+        });
+        setVelocityBounds(x);
+        setVelocityBounds(y);
+    }
+
+    void WindField::advect(std::vector<float>& outX, std::vector<float>& outY, const std::vector<float>& inX, const std::vector<float>& inY, float deltaTime) {
+        float scale = deltaTime / cellSize;
+        float maxX = cols - 1.501f;
+        float maxY = rowCount - 1.501f;
+
+        forRows([&](int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                advectRow(outX.data(), outY.data(), inX.data(), inY.data(), row, cols, scale, maxX, maxY);
+            }
+        });
+        setVelocityBounds(outX);
+        setVelocityBounds(outY);
+    }
+
+    // open edges, the wind keeps its speed as it leaves
+    void WindField::setVelocityBounds(std::vector<float>& field) {
+        for (int x = 1; x < cols - 1; x++) {
+            field[index(x, 0)] = field[index(x, 1)];
+            field[index(x, rowCount - 1)] = field[index(x, rowCount - 2)];
+        }
+        for (int y = 0; y < rowCount; y++) {
+            field[index(0, y)] = field[index(1, y)];
+            field[index(cols - 1, y)] = field[index(cols - 2, y)];
+        }
+    }
+
+    // the pressure outside the play area is the ambient one
+    void WindField::setPressureBounds(std::vector<float>& field) {
+        for (int x = 0; x < cols; x++) {
+            field[index(x, 0)] = 0.0f;
+            field[index(x, rowCount - 1)] = 0.0f;
+        }
+        for (int y = 0; y < rowCount; y++) {
+            field[index(0, y)] = 0.0f;
+            field[index(cols - 1, y)] = 0.0f;
+        }
+    }
+}
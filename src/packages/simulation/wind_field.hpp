@@ -0,0 +1,94 @@
+#ifndef YUME_WIND_FIELD
+#define YUME_WIND_FIELD
+
+#include "flight_model.hpp"
+#include "../jobs/job_system.hpp"
+
+#include <vector>
+
+namespace yume {
+
+    // 128x96 cells of 6.25 pixels cover the 800x600 play area, fine enough for the exhaust to stir a few cells
+    constexpr int wind_columns = 128;
+    constexpr int wind_rows = 96;
+    constexpr float wind_cell_size = 6.25f;
+
+    // A band of air across the whole play area pulled towards velocity, the pull swells and fades over period seconds.
+    struct GustSource {
+        float height;      // center of the band
+        float halfHeight;
+        vec2<float> velocity;
+        float period;
+    };
+
+    // Wind over the play area on a coarse grid of square cells, solved like stable fluids: forces, diffuse,
+    // project, advect, project. Velocities are in pixels per second and the edges are open, air leaves the screen
+    // instead of piling up against it. Every pass works on whole rows four cells at a time and splits the rows across
+    // the job system when one is given.
+    class WindField {
+    public:
+        // the viscosity is low enough that the diffusion settles in a few sweeps, the pressure needs more
+        static constexpr int diffuse_iterations = 4;
+        static constexpr int pressure_iterations = 10;
+
+        // the play area is columns_v x rows_v cells of cell_size pixels
+        WindField(int columns_v, int rows_v, float cell_size, JobSystem* jobs_v = nullptr);
+
+        // replaces the gusts with the ones of a stage, the air already moving keeps moving
+        void setStage(int stage);
+        // blows velocity into a disc of the field over deltaTime, used for the exhaust
+        void addVelocity(vec2<float> position, vec2<float> velocity, float radius, float deltaTime);
+        void step(float deltaTime);
+        void clear();
+
+        // bilinear between the cell centers, zero outside the play area
+        vec2<float> sample(vec2<float> position) const;
+
+        int columns() const;
+        int rows() const;
+        float lastStepMs() const;
+
+    private:
+        int cols;
+        int rowCount;
+        float cellSize;
+        JobSystem* jobs;
+
+        std::vector<float> u, v;
+        std::vector<float> uPrevious, vPrevious;
+        std::vector<float> pressure, pressureScratch, divergence;
+
+        std::vector<GustSource> gusts;
+        float time{ 0.0f };
+        float stepMs{ 0.0f };
+
+        int index(int x, int y) const { return x + y * cols; }
+
+        template<typename F>
+        void forRows(F&& body);
+
+        void applyGust(const GustSource& gust, float deltaTime);
+        void jacobi(std::vector<float>& x, std::vector<float>& scratch, const std::vector<float>& b, float a, float inverse, bool velocity, int iterations);
+        void diffuse(float deltaTime);
+        void project(std::vector<float>& x, std::vector<float>& y);
+        void advect(std::vector<float>& outX, std::vector<float>& outY, const std::vector<float>& inX, const std::vector<float>& inY, float deltaTime);
+        void setVelocityBounds(std::vector<float>& field);
+        void setPressureBounds(std::vector<float>& field);
+    };
+
+    // Exhaust leaves the nozzle opposite to the push the thrust gives the rocket.
+    inline void blowExhaust(WindField& field, const RocketState& rocket, float deltaTime) {
+        if (!rocket.engine_enable || rocket.thrust <= 0.0f) {
+            return;
+        }
+
+        float radians = static_cast<float>(rocket.rotation * flight_pi / 180.0);
+        vec2<float> direction(std::cos(radians), std::sin(radians));
+        vec2<float> nozzle(rocket.position.x + rocket.size.x / 2.0f + direction.x * rocket.size.y / 2.0f,
+            rocket.position.y + rocket.size.y / 2.0f + direction.y * rocket.size.y / 2.0f);
+
+        field.addVelocity(nozzle, direction * (rocket.thrust * 3.0f), 12.0f, deltaTime);
+    }
+}
+
+#endif
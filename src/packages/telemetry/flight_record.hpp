@@ -0,0 +1,133 @@
+#ifndef YUME_FLIGHT_RECORD
+#define YUME_FLIGHT_RECORD
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace yume {
+
+    // File layout: FlightLogHeader followed by blocks of up to flight_block_samples samples.
+    // A block is a uint32 sample count followed by every column stored contiguously, in the order of FlightBlock.
+    // Values are written in host byte order, the header magic doubles as a byte order check.
+    constexpr char flight_log_magic[4] = { 'Y', 'T', 'L', 'M' };
+    constexpr std::uint16_t flight_log_version = 1;
+    constexpr std::uint32_t flight_block_samples = 1024;
+
+    enum FlightFlags : std::uint8_t {
+        flight_grounded = 1 << 0,
+        flight_on_island = 1 << 1,
+        flight_stable = 1 << 2,
+        flight_engine = 1 << 3,
+    };
+
+    struct FlightSample {
+        std::uint32_t step;
+        std::uint32_t attempt;
+        float time;
+        float deltaTime;
+        float x;
+        float y;
+        float velocityX;
+        float velocityY;
+        float rotation;
+        float rotationalVelocity;
+        float thrust;
+        std::uint8_t flags;
+        std::uint8_t stage;
+    };
+
+    struct FlightLogHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t reserved;
+        std::uint32_t blockSamples;
+    };
+
+    struct FlightBlock {
+        std::uint32_t count{ 0 };
+        std::array<std::uint32_t, flight_block_samples> step;
+        std::array<std::uint32_t, flight_block_samples> attempt;
+        std::array<float, flight_block_samples> time;
+        std::array<float, flight_block_samples> deltaTime;
+        std::array<float, flight_block_samples> x;
+        std::array<float, flight_block_samples> y;
+        std::array<float, flight_block_samples> velocityX;
+        std::array<float, flight_block_samples> velocityY;
+        std::array<float, flight_block_samples> rotation;
+        std::array<float, flight_block_samples> rotationalVelocity;
+        std::array<float, flight_block_samples> thrust;
+        std::array<std::uint8_t, flight_block_samples> flags;
+        std::array<std::uint8_t, flight_block_samples> stage;
+
+        bool full() const {
+            return count == flight_block_samples;
+        }
+
+        void append(const FlightSample& sample) {
+            step[count] = sample.step;
+            attempt[count] = sample.attempt;
+            time[count] = sample.time;
+            deltaTime[count] = sample.deltaTime;
+            x[count] = sample.x;
+            y[count] = sample.y;
+            velocityX[count] = sample.velocityX;
+            velocityY[count] = sample.velocityY;
+            rotation[count] = sample.rotation;
+            rotationalVelocity[count] = sample.rotationalVelocity;
+            thrust[count] = sample.thrust;
+            flags[count] = sample.flags;
+            stage[count] = sample.stage;
+            count += 1;
+        }
+
+        FlightSample at(std::uint32_t i) const {
+            return FlightSample{ step[i], attempt[i], time[i], deltaTime[i], x[i], y[i], velocityX[i], velocityY[i],
+                rotation[i], rotationalVelocity[i], thrust[i], flags[i], stage[i] };
+        }
+
+        template <typename Column>
+        void writeColumn(std::ostream& out, const Column& column) const {
+            out.write(reinterpret_cast<const char*>(column.data()), count * sizeof(typename Column::value_type));
+        }
+
+        template <typename Column>
+        bool readColumn(std::istream& in, Column& column) {
+            in.read(reinterpret_cast<char*>(column.data()), count * sizeof(typename Column::value_type));
+            return static_cast<bool>(in);
+        }
+
+        void write(std::ostream& out) const {
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            writeColumn(out, step);
+            writeColumn(out, attempt);
+            writeColumn(out, time);
+            writeColumn(out, deltaTime);
+            writeColumn(out, x);
+            writeColumn(out, y);
+            writeColumn(out, velocityX);
+            writeColumn(out, velocityY);
+            writeColumn(out, rotation);
+            writeColumn(out, rotationalVelocity);
+            writeColumn(out, thrust);
+            writeColumn(out, flags);
+            writeColumn(out, stage);
+        }
+
+        // false at the end of the file or on a truncated block
+        bool read(std::istream& in) {
+            if (!in.read(reinterpret_cast<char*>(&count), sizeof(count)) || count > flight_block_samples) {
+                count = 0;
+                return false;
+            }
+
+            return readColumn(in, step) && readColumn(in, attempt) && readColumn(in, time) && readColumn(in, deltaTime)
+                && readColumn(in, x) && readColumn(in, y) && readColumn(in, velocityX) && readColumn(in, velocityY)
+                && readColumn(in, rotation) && readColumn(in, rotationalVelocity) && readColumn(in, thrust)
+                && readColumn(in, flags) && readColumn(in, stage);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,573 @@
+#include "ghost.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace yume {
+
+    namespace {
+        constexpr std::uint16_t probability_one = 1 << 11;
+        constexpr int adapt_shift = 4;  // segments are short, the models have to settle within a few dozen samples
+        constexpr std::uint32_t range_top = 1u << 24;
+
+        std::uint32_t zigzag(std::int32_t value) {
+            return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+        }
+
+        std::int32_t unzigzag(std::uint32_t value) {
+            return static_cast<std::int32_t>((value >> 1) ^ (0u - (value & 1u)));
+        }
+
+        void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        // differences wrap instead of overflowing, decoding adds them back the same way
+        std::int32_t wrapSub(std::int32_t a, std::int32_t b) {
+            return static_cast<std::int32_t>(static_cast<std::uint32_t>(a) - static_cast<std::uint32_t>(b));
+        }
+
+        std::int32_t wrapAdd(std::int32_t a, std::int32_t b) {
+            return static_cast<std::int32_t>(static_cast<std::uint32_t>(a) + static_cast<std::uint32_t>(b));
+        }
+
+        // position and rotation carry on at the speed of the last step, thrust holds
+        std::int32_t predictMoving(std::int32_t previous, std::int32_t beforePrevious) {
+            return wrapAdd(previous, wrapSub(previous, beforePrevious));
+        }
+
+        // LZMA style binary range coder, 11 bit probabilities and a carry propagated through a cached byte
+        class RangeEncoder {
+        public:
+            explicit RangeEncoder(std::vector<std::uint8_t>& out_v)
+                : out(&out_v) {
+            }
+
+            void encodeBit(std::uint16_t& probability, int bit) {
+                std::uint32_t bound = (range >> 11) * probability;
+                if (bit == 0) {
+                    range = bound;
+                    probability += (probability_one - probability) >> adapt_shift;
+                }
+                else {
+                    low += bound;
+                    range -= bound;
+                    probability -= probability >> adapt_shift;
+                }
+                normalize();
+            }
+
+            // an even split, for the low bits of a magnitude that are close to random
+            void encodeDirect(int bit) {
+                range >>= 1;
+                if (bit != 0) {
+                    low += range;
+                }
+                normalize();
+            }
+
+            void flush() {
+                for (int i = 0; i < 5; i++) {
+                    shiftLow();
+                }
+            }
+
+        private:
+            std::vector<std::uint8_t>* out;
+            std::uint64_t low{ 0 };
+            std::uint32_t range{ 0xFFFFFFFFu };
+            std::uint8_t cache{ 0 };
+            std::uint64_t cacheSize{ 1 };
+
+            void normalize() {
+                while (range < range_top) {
+                    range <<= 8;
+                    shiftLow();
+                }
+            }
+
+            void shiftLow() {
+                if (static_cast<std::uint32_t>(low) < 0xFF000000u || (low >> 32) != 0) {
+                    std::uint8_t carry = static_cast<std::uint8_t>(low >> 32);
+                    std::uint8_t next = cache;
+                    do {
+                        out->push_back(static_cast<std::uint8_t>(next + carry));
+                        next = 0xFF;
+                    } while (--cacheSize != 0);
+                    cache = static_cast<std::uint8_t>(low >> 24);
+                }
+                cacheSize += 1;
+                low = (low & 0x00FFFFFFu) << 8;
+            }
+        };
+
+        void encodeResidual(RangeEncoder& encoder, GhostModels::Channel& channel, std::int32_t value) {
+            encoder.encodeBit(channel.zero[channel.lastZero ? 1 : 0], value != 0);
+            channel.lastZero = value == 0;
+            if (value == 0) {
+                return;
+            }
+
+            encoder.encodeBit(channel.sign, value < 0);
+            std::uint32_t magnitude = value < 0 ? 0u - static_cast<std::uint32_t>(value) : static_cast<std::uint32_t>(value);
+            int length = std::bit_width(magnitude);
+            for (int i = 1; i < length; i++) {
+                encoder.encodeBit(channel.length[i - 1], 1);
+            }
+            if (length < GhostModels::max_length) {
+                encoder.encodeBit(channel.length[length - 1], 0);
+            }
+
+            if (length >= 2) {
+                encoder.encodeBit(channel.top[length - 1], (magnitude >> (length - 2)) & 1u);
+                for (int bit = length - 3; bit >= 0; bit--) {
+                    encoder.encodeDirect((magnitude >> bit) & 1u);
+                }
+            }
+        }
+    }
+
+    GhostSample quantizeGhost(const RocketState& rocket) {
+        std::uint8_t flags = 0;
+        if (rocket.grounded) flags |= flight_grounded;
+        if (rocket.on_island) flags |= flight_on_island;
+        if (rocket.is_stable) flags |= flight_stable;
+        if (rocket.engine_enable) flags |= flight_engine;
+
+        return GhostSample{ static_cast<std::int32_t>(std::lround(rocket.position.x * ghost_position_scale)),
+            static_cast<std::int32_t>(std::lround(rocket.position.y * ghost_position_scale)),
+            static_cast<std::int32_t>(std::lround(rocket.rotation * ghost_rotation_scale)),
+            static_cast<std::int32_t>(std::lround(rocket.thrust * ghost_thrust_scale)), flags };
+    }
+
+    GhostPose ghostPose(const GhostSample& a, const GhostSample& b, float at) {
+        auto blend = [at](std::int32_t from, std::int32_t to, float scale) {
+            return (static_cast<float>(from) + (static_cast<float>(to) - static_cast<float>(from)) * at) / scale;
+        };
+        return GhostPose{ vec2<float>(blend(a.x, b.x, ghost_position_scale), blend(a.y, b.y, ghost_position_scale)),
+            blend(a.rotation, b.rotation, ghost_rotation_scale), blend(a.thrust, b.thrust, ghost_thrust_scale), a.flags };
+    }
+
+    void GhostModels::reset() {
+        for (Channel& entry : channel) {
+            entry.zero.fill(probability_one / 2);
+            entry.sign = probability_one / 2;
+            entry.length.fill(probability_one / 2);
+            entry.top.fill(probability_one / 2);
+            entry.lastZero = true;
+        }
+        flagsChanged = probability_one / 2;
+    }
+
+    GhostRecorder::GhostRecorder() {
+        samples.reserve(ghost_max_samples);
+        segmentSizes.reserve(ghost_max_segments);
+        // a wild flight codes to about a byte per sample, calm ones to a fraction of that
+        encoded.reserve(sizeof(GhostHeader) + ghost_max_samples + ghost_max_segments * 16);
+    }
+
+    void GhostRecorder::clear() {
+        samples.clear();
+        overflowed = false;
+    }
+
+    void GhostRecorder::record(const RocketState& rocket, float seconds) {
+        std::size_t wanted = static_cast<std::size_t>(std::max(0.0f, seconds) * ghost_sample_rate) + 1;
+        if (wanted > ghost_max_samples) {
+            overflowed = true;
+            wanted = ghost_max_samples;
+        }
+        if (samples.size() >= wanted) {
+            return;
+        }
+
+        GhostSample sample = quantizeGhost(rocket);
+        samples.resize(wanted, sample);
+    }
+
+    void GhostRecorder::truncate(float seconds) {
+        std::size_t kept = static_cast<std::size_t>(std::max(0.0f, seconds) * ghost_sample_rate) + 1;
+        if (kept < samples.size()) {
+            samples.resize(kept);
+            overflowed = false;
+        }
+    }
+
+    std::uint32_t GhostRecorder::sampleCount() const {
+        return static_cast<std::uint32_t>(samples.size());
+    }
+
+    float GhostRecorder::duration() const {
+        return samples.empty() ? 0.0f : (samples.size() - 1) / ghost_sample_rate;
+    }
+
+    bool GhostRecorder::full() const {
+        return overflowed;
+    }
+
+    void GhostRecorder::encode(int stage) {
+        std::uint32_t count = static_cast<std::uint32_t>(samples.size());
+        std::uint32_t segments = (count + ghost_keyframe_interval - 1) / ghost_keyframe_interval;
+
+        encoded.clear();
+        encoded.resize(sizeof(GhostHeader));
+        segmentSizes.clear();
+        GhostModels models;
+
+        for (std::uint32_t segment = 0; segment < segments; segment++) {
+            std::size_t start = encoded.size();
+            std::uint32_t first = segment * ghost_keyframe_interval;
+            std::uint32_t end = std::min(count, first + ghost_keyframe_interval);
+
+            const GhostSample& key = samples[first];
+            writeVarint(encoded, zigzag(key.x));
+            writeVarint(encoded, zigzag(key.y));
+            writeVarint(encoded, zigzag(key.rotation));
+            writeVarint(encoded, zigzag(key.thrust));
+            writeVarint(encoded, key.flags);
+
+            models.reset();
+            RangeEncoder encoder(encoded);
+            GhostSample previous = key;
+            GhostSample beforePrevious = key;
+            for (std::uint32_t i = first + 1; i < end; i++) {
+                const GhostSample& sample = samples[i];
+                encodeResidual(encoder, models.channel[0], wrapSub(sample.x, predictMoving(previous.x, beforePrevious.x)));
+                encodeResidual(encoder, models.channel[1], wrapSub(sample.y, predictMoving(previous.y, beforePrevious.y)));
+                encodeResidual(encoder, models.channel[2], wrapSub(sample.rotation, predictMoving(previous.rotation, beforePrevious.rotation)));
+                encodeResidual(encoder, models.channel[3], wrapSub(sample.thrust, previous.thrust));
+
+                encoder.encodeBit(models.flagsChanged, sample.flags != previous.flags);
+                if (sample.flags != previous.flags) {
+                    for (int bit = 3; bit >= 0; bit--) {
+                        encoder.encodeDirect((sample.flags >> bit) & 1u);
+                    }
+                }
+
+                beforePrevious = previous;
+                previous = sample;
+            }
+            encoder.flush();
+            segmentSizes.push_back(encoded.size() - start);
+        }
+
+        GhostHeader header{};
+        std::memcpy(header.magic, ghost_magic, sizeof(header.magic));
+        header.version = ghost_version;
+        header.stage = static_cast<std::uint8_t>(stage);
+        header.sampleCount = count;
+        header.segmentCount = segments;
+        header.indexOffset = static_cast<std::uint32_t>(encoded.size());
+        for (std::uint64_t size : segmentSizes) {
+            writeVarint(encoded, size);
+        }
+        std::memcpy(encoded.data(), &header, sizeof(header));
+    }
+
+    bool GhostRecorder::save(const char* file_name, int stage, std::size_t* bytes) {
+        if (samples.empty()) {
+            return false;
+        }
+
+        encode(stage);
+        std::FILE* out = std::fopen(file_name, "wb");
+        if (out == nullptr) {
+            std::printf("Could not write the ghost %s\n", file_name);
+            return false;
+        }
+        bool written = std::fwrite(encoded.data(), 1, encoded.size(), out) == encoded.size();
+        written = std::fclose(out) == 0 && written;
+        if (!written) {
+            std::printf("Could not write the ghost %s\n", file_name);
+            return false;
+        }
+
+        if (bytes != nullptr) {
+            *bytes = encoded.size();
+        }
+        return true;
+    }
+
+    GhostReader::GhostReader() {
+        segmentOffsets.reserve(ghost_max_segments);
+    }
+
+    bool GhostReader::open(const char* file_name) {
+        close();
+        // stdio, so switching ghosts on a restart does not go through operator new on the frame thread
+        file = std::fopen(file_name, "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IONBF, 0);
+
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, ghost_magic, sizeof(header.magic)) == 0
+            && header.version == ghost_version && header.sampleCount != 0 && header.sampleCount <= ghost_max_samples
+            && header.segmentCount == (header.sampleCount + ghost_keyframe_interval - 1) / ghost_keyframe_interval;
+        if (!valid) {
+            std::printf("%s is not a ghost this version can play\n", file_name);
+            close();
+            return false;
+        }
+
+        jump(header.indexOffset);
+        std::uint64_t offset = sizeof(header);
+        for (std::uint32_t segment = 0; segment < header.segmentCount; segment++) {
+            segmentOffsets.push_back(offset);
+            offset += readVarint();
+        }
+        if (offset != header.indexOffset) {
+            std::printf("%s is damaged\n", file_name);
+            close();
+            return false;
+        }
+
+        opened = true;
+        nextIndex = 0;
+        cached = false;
+        return true;
+    }
+
+    void GhostReader::close() {
+        if (file != nullptr) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        segmentOffsets.clear();
+        header = GhostHeader{};
+        bufferStart = 0;
+        bufferSize = 0;
+        cursor = 0;
+        opened = false;
+        cached = false;
+        nextIndex = 0;
+    }
+
+    bool GhostReader::isOpen() const {
+        return opened;
+    }
+
+    int GhostReader::stage() const {
+        return header.stage;
+    }
+
+    std::uint32_t GhostReader::sampleCount() const {
+        return header.sampleCount;
+    }
+
+    float GhostReader::duration() const {
+        return header.sampleCount > 0 ? (header.sampleCount - 1) / ghost_sample_rate : 0.0f;
+    }
+
+    bool GhostReader::seek(std::uint32_t index) {
+        cached = false;
+        if (!opened || index >= header.sampleCount) {
+            return false;
+        }
+
+        // within the segment being decoded and ahead of it, decoding on is cheaper than starting it again
+        std::uint32_t first = index / ghost_keyframe_interval * ghost_keyframe_interval;
+        if (nextIndex <= first || nextIndex > index) {
+            nextIndex = first;
+        }
+
+        GhostSample skipped;
+        while (nextIndex < index) {
+            if (!next(skipped)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool GhostReader::next(GhostSample& sample) {
+        if (!opened || nextIndex >= header.sampleCount) {
+            return false;
+        }
+
+        if (nextIndex % ghost_keyframe_interval == 0) {
+            startSegment(nextIndex / ghost_keyframe_interval);
+            sample = previous;
+        }
+        else {
+            sample.x = wrapAdd(predictMoving(previous.x, beforePrevious.x), decodeResidual(models.channel[0]));
+            sample.y = wrapAdd(predictMoving(previous.y, beforePrevious.y), decodeResidual(models.channel[1]));
+            sample.rotation = wrapAdd(predictMoving(previous.rotation, beforePrevious.rotation), decodeResidual(models.channel[2]));
+            sample.thrust = wrapAdd(previous.thrust, decodeResidual(models.channel[3]));
+
+            sample.flags = previous.flags;
+            if (decodeBit(models.flagsChanged) != 0) {
+                sample.flags = 0;
+                for (int bit = 0; bit < 4; bit++) {
+                    sample.flags = static_cast<std::uint8_t>((sample.flags << 1) | decodeDirect());
+                }
+            }
+
+            beforePrevious = previous;
+            previous = sample;
+        }
+
+        nextIndex += 1;
+        return true;
+    }
+
+    bool GhostReader::poseAt(float seconds, GhostPose& pose) {
+        if (!opened) {
+            return false;
+        }
+
+        std::uint32_t last = header.sampleCount - 1;
+        float position = std::clamp(seconds * ghost_sample_rate, 0.0f, static_cast<float>(last));
+        std::uint32_t index = std::min(static_cast<std::uint32_t>(position), last);
+
+        // a restart or a rewind goes back, a long hitch far ahead, both jump to a keyframe
+        if (!cached || index < cachedIndex || index > cachedIndex + ghost_keyframe_interval) {
+            if (!seek(index) || !next(before)) {
+                return false;
+            }
+            after = before;
+            if (index < last) {
+                next(after);
+            }
+            cachedIndex = index;
+            cached = true;
+        }
+
+        while (cachedIndex < index) {
+            before = after;
+            cachedIndex += 1;
+            if (cachedIndex < last) {
+                next(after);
+            }
+        }
+
+        pose = ghostPose(before, after, position - static_cast<float>(index));
+        return true;
+    }
+
+    bool GhostReader::jump(std::uint64_t offset) {
+        if (offset >= bufferStart && offset < bufferStart + bufferSize) {
+            cursor = static_cast<std::size_t>(offset - bufferStart);
+            return true;
+        }
+
+        bufferStart = offset;
+        bufferSize = 0;
+        cursor = 0;
+        return std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+    }
+
+    std::uint8_t GhostReader::readByte() {
+        if (cursor == bufferSize) {
+            bufferStart += bufferSize;
+            bufferSize = std::fread(buffer.data(), 1, buffer.size(), file);
+            cursor = 0;
+            // a truncated file decodes zeros instead of reading past the end
+            if (bufferSize == 0) {
+                return 0;
+            }
+        }
+        return buffer[cursor++];
+    }
+
+    std::uint64_t GhostReader::readVarint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t byte = readByte();
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    int GhostReader::decodeBit(std::uint16_t& probability) {
+        std::uint32_t bound = (range >> 11) * probability;
+        int bit;
+        if (code < bound) {
+            range = bound;
+            probability += (probability_one - probability) >> adapt_shift;
+            bit = 0;
+        }
+        else {
+            code -= bound;
+            range -= bound;
+            probability -= probability >> adapt_shift;
+            bit = 1;
+        }
+        while (range < range_top) {
+            range <<= 8;
+            code = (code << 8) | readByte();
+        }
+        return bit;
+    }
+
+    int GhostReader::decodeDirect() {
+        range >>= 1;
+        int bit = 0;
+        if (code >= range) {
+            code -= range;
+            bit = 1;
+        }
+        while (range < range_top) {
+            range <<= 8;
+            code = (code << 8) | readByte();
+        }
+        return bit;
+    }
+
+    std::int32_t GhostReader::decodeResidual(GhostModels::Channel& channel) {
+        bool nonZero = decodeBit(channel.zero[channel.lastZero ? 1 : 0]) != 0;
+        channel.lastZero = !nonZero;
+        if (!nonZero) {
+            return 0;
+        }
+
+        bool negative = decodeBit(channel.sign) != 0;
+        int length = 1;
+        while (length < GhostModels::max_length && decodeBit(channel.length[length - 1]) != 0) {
+            length += 1;
+        }
+
+        std::uint32_t magnitude = 1;
+        if (length >= 2) {
+            magnitude = (magnitude << 1) | static_cast<std::uint32_t>(decodeBit(channel.top[length - 1]));
+            for (int bit = length - 3; bit >= 0; bit--) {
+                magnitude = (magnitude << 1) | static_cast<std::uint32_t>(decodeDirect());
+            }
+        }
+        return negative ? static_cast<std::int32_t>(0u - magnitude) : static_cast<std::int32_t>(magnitude);
+    }
+
+    void GhostReader::startSegment(std::uint32_t segment) {
+        jump(segmentOffsets[segment]);
+
+        GhostSample key;
+        key.x = unzigzag(static_cast<std::uint32_t>(readVarint()));
+        key.y = unzigzag(static_cast<std::uint32_t>(readVarint()));
+        key.rotation = unzigzag(static_cast<std::uint32_t>(readVarint()));
+        key.thrust = unzigzag(static_cast<std::uint32_t>(readVarint()));
+        key.flags = static_cast<std::uint8_t>(readVarint());
+
+        models.reset();
+        range = 0xFFFFFFFFu;
+        code = 0;
+        for (int i = 0; i < 5; i++) {
+            code = (code << 8) | readByte();
+        }
+        previous = key;
+        beforePrevious = key;
+    }
+
+    GhostReader::~GhostReader() {
+        close();
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef YUME_GHOST
+#define YUME_GHOST
+
+#include "flight_record.hpp"
+#include "../simulation/flight_model.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace yume {
+
+    // File layout: GhostHeader, the segments back to back, then an index with one varint per segment holding its
+    // size in bytes. A segment covers ghost_keyframe_interval samples. It starts with a keyframe, the first sample
+    // as zigzag varints, and the rest of its samples follow as range coded residuals against a prediction from the
+    // samples before them. Every segment starts its coder and its predictions afresh, so a seek decodes at most
+    // one segment. Values are written in host byte order, the header magic doubles as a byte order check.
+    constexpr char ghost_magic[4] = { 'Y', 'G', 'H', 'O' };
+    constexpr std::uint16_t ghost_version = 1;
+    constexpr float ghost_sample_rate = 60.0f;
+    constexpr std::uint32_t ghost_keyframe_interval = 120;
+    constexpr std::uint32_t ghost_max_samples = 60 * 60 * 10;  // ten minutes, a longer flight is not kept
+    constexpr std::uint32_t ghost_max_segments = (ghost_max_samples + ghost_keyframe_interval - 1) / ghost_keyframe_interval;
+
+    // fixed point steps, 1/16 of a pixel and a degree, thrust moves in exact hundredths
+    constexpr float ghost_position_scale = 16.0f;
+    constexpr float ghost_rotation_scale = 16.0f;
+    constexpr float ghost_thrust_scale = 100.0f;
+
+    struct GhostHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint8_t stage;
+        std::uint8_t reserved;
+        std::uint32_t sampleCount;
+        std::uint32_t segmentCount;
+        std::uint32_t indexOffset;
+    };
+
+    // One 60 Hz sample in fixed point, flags are FlightFlags
+    struct GhostSample {
+        std::int32_t x;
+        std::int32_t y;
+        std::int32_t rotation;
+        std::int32_t thrust;
+        std::uint8_t flags;
+    };
+
+    struct GhostPose {
+        vec2<float> position;
+        float rotation;
+        float thrust;
+        std::uint8_t flags;
+    };
+
+    GhostSample quantizeGhost(const RocketState& rocket);
+    // a pose between two neighbouring samples, at is 0 for a and 1 for b
+    GhostPose ghostPose(const GhostSample& a, const GhostSample& b, float at);
+
+    // Adaptive bit probabilities for one segment. A residual is coded as zero or not, then its sign, the length
+    // of its magnitude in unary and the bits below the leading one. Steady flight predicts almost exactly, so most
+    // residuals are zero and cost a small fraction of a bit.
+    struct GhostModels {
+        static constexpr int channels = 4;  // x, y, rotation, thrust
+        static constexpr int max_length = 32;
+
+        struct Channel {
+            std::array<std::uint16_t, 2> zero;  // by whether the channel's last residual was zero
+            std::uint16_t sign;
+            std::array<std::uint16_t, max_length> length;
+            std::array<std::uint16_t, max_length> top;  // the bit below the leading one, by length
+            bool lastZero;
+        };
+
+        std::array<Channel, channels> channel;
+        std::uint16_t flagsChanged;
+
+        void reset();
+    };
+
+    // Samples one attempt at ghost_sample_rate and writes it as a ghost file. Every buffer is reserved for
+    // ghost_max_samples up front and the file goes through stdio, so recording and saving a run that fits do not
+    // go through operator new on the frame thread.
+    class GhostRecorder {
+    public:
+        GhostRecorder();
+
+        void clear();
+        // samples the rocket up to seconds into the attempt, a long frame repeats it for the samples it covered
+        void record(const RocketState& rocket, float seconds);
+        // forgets the samples after seconds, for a rewind
+        void truncate(float seconds);
+
+        std::uint32_t sampleCount() const;
+        float duration() const;
+        // past ghost_max_samples the rest of the attempt is not recorded
+        bool full() const;
+
+        bool save(const char* file_name, int stage, std::size_t* bytes = nullptr);
+
+    private:
+        std::vector<GhostSample> samples;
+        std::vector<std::uint8_t> encoded;
+        std::vector<std::uint64_t> segmentSizes;
+        bool overflowed{ false };
+
+        void encode(int stage);
+    };
+
+    // Streams a ghost file from disk, only the header and the index are read up front. Decoding forward costs a
+    // few bit decodes per sample, going back or far ahead jumps to the nearest keyframe.
+    class GhostReader {
+    public:
+        GhostReader();
+        GhostReader(const GhostReader&) = delete;
+        GhostReader& operator=(const GhostReader&) = delete;
+
+        // false when the file is missing or not a ghost, the reader is closed then
+        bool open(const char* file_name);
+        void close();
+        bool isOpen() const;
+
+        int stage() const;
+        std::uint32_t sampleCount() const;
+        // seconds of flight from the first sample to the landing
+        float duration() const;
+
+        // the next next() returns sample index
+        bool seek(std::uint32_t index);
+        bool next(GhostSample& sample);
+        // the ghost seconds into its flight, interpolated between samples and held at the last one after the end
+        bool poseAt(float seconds, GhostPose& pose);
+
+        ~GhostReader();
+
+    private:
+        std::FILE* file{ nullptr };
+        GhostHeader header{};
+        std::vector<std::uint64_t> segmentOffsets;  // file offsets
+        bool opened{ false };
+
+        std::array<std::uint8_t, 4096> buffer{};
+        std::uint64_t bufferStart{ 0 };  // file offset of buffer[0]
+        std::size_t bufferSize{ 0 };
+        std::size_t cursor{ 0 };
+
+        // coder state of the segment being decoded
+        std::uint32_t range{ 0 };
+        std::uint32_t code{ 0 };
+        GhostModels models{};
+        GhostSample previous{};
+        GhostSample beforePrevious{};
+        std::uint32_t nextIndex{ 0 };
+
+        // poseAt() keeps the two samples around the last time asked for
+        GhostSample before{};
+        GhostSample after{};
+        std::uint32_t cachedIndex{ 0 };
+        bool cached{ false };
+
+        bool jump(std::uint64_t offset);
+        std::uint8_t readByte();
+        std::uint64_t readVarint();
+        int decodeBit(std::uint16_t& probability);
+        int decodeDirect();
+        std::int32_t decodeResidual(GhostModels::Channel& channel);
+        void startSegment(std::uint32_t segment);
+    };
+}
+
+#endif
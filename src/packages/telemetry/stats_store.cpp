@@ -0,0 +1,381 @@
+#include "stats_store.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yume {
+
+    namespace {
+        constexpr std::intptr_t no_handle = -1;
+        constexpr std::uint32_t grow_records = 1024;  // 32 KB of file at a time, far more than a flush interval needs
+        constexpr auto flush_interval = std::chrono::milliseconds(250);
+        constexpr std::size_t checked_bytes = offsetof(StatsRecord, checksum);
+
+        std::size_t recordOffset(std::uint32_t index) {
+            return sizeof(StatsHeader) + stats_index_size + static_cast<std::size_t>(index) * sizeof(StatsRecord);
+        }
+
+        std::uint32_t fnv1a(std::uint32_t hash, const void* data, std::size_t size) {
+            const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+            for (std::size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 16777619u;
+            }
+            return hash;
+        }
+
+        std::uint32_t indexChecksum(const StatsIndex& index) {
+            return fnv1a(fnv1a(2166136261u, &index.records, sizeof(index.records)), &index.summary, sizeof(index.summary));
+        }
+
+        bool isZero(const StatsRecord& record) {
+            const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&record);
+            return std::all_of(bytes, bytes + sizeof(StatsRecord), [](std::uint8_t byte) { return byte == 0; });
+        }
+
+#if defined(_WIN32)
+        HANDLE native(std::intptr_t handle) {
+            return reinterpret_cast<HANDLE>(handle);
+        }
+#endif
+    }
+
+    std::uint32_t statsChecksum(const StatsRecord& record) {
+        return fnv1a(2166136261u, &record, checked_bytes);
+    }
+
+    float StatsSummary::Stage::averageLandingSpeed() const {
+        return landings == 0 ? 0.0f : static_cast<float>(landingSpeedSum / landings);
+    }
+
+    void StatsSummary::add(const StatsRecord& record) {
+        if (record.flags & stats_autopilot) {
+            assisted++;
+            return;
+        }
+
+        records++;
+        bestStreak = std::max<std::uint32_t>(bestStreak, record.streak);
+        lastStage = record.stage;
+
+        Stage& entry = stages[std::min<int>(record.stage, stats_stages - 1)];
+        entry.attempts++;
+        if (record.kind == stats_landed) {
+            entry.landings++;
+            entry.landingSpeedSum += record.landingSpeed;
+            if (entry.bestSeconds == 0.0f || record.flightSeconds < entry.bestSeconds) {
+                entry.bestSeconds = record.flightSeconds;
+            }
+            highestStage = std::max<int>(highestStage, record.stage);
+        }
+        else if (record.kind == stats_crashed) {
+            entry.crashes++;
+        }
+    }
+
+    const StatsSummary::Stage& StatsSummary::stage(int index) const {
+        return stages[std::clamp(index, 0, stats_stages - 1)];
+    }
+
+    StatsStore::StatsStore()
+        : file(no_handle), mapping(0) {}
+
+    bool StatsStore::open(const char* file_name) {
+        close();
+
+        // the whole log is mapped at once and never moves, only the file behind it grows
+        viewSize = recordOffset(stats_max_records);
+        std::size_t fileSize = 0;
+
+#if defined(_WIN32)
+        HANDLE handle = CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            std::printf("Stats Error: cannot open %s\n", file_name);
+            return false;
+        }
+        file = reinterpret_cast<std::intptr_t>(handle);
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(handle, &size);
+        fileSize = static_cast<std::size_t>(size.QuadPart);
+
+        // a section cannot grow under its view, so on Windows the file takes its full size here
+        HANDLE section = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(viewSize), nullptr);
+        if (section != nullptr) {
+            mapping = reinterpret_cast<std::intptr_t>(section);
+            view = static_cast<std::uint8_t*>(MapViewOfFile(section, FILE_MAP_WRITE, 0, 0, viewSize));
+        }
+#else
+        int descriptor = ::open(file_name, O_RDWR | O_CREAT, 0644);
+        if (descriptor < 0) {
+            std::printf("Stats Error: cannot open %s\n", file_name);
+            return false;
+        }
+        file = descriptor;
+
+        struct stat status;
+        if (fstat(descriptor, &status) == 0) {
+            fileSize = static_cast<std::size_t>(status.st_size);
+        }
+
+        // pages past the end of the file are reserved but not touched until grow() has the file cover them
+        void* address = mmap(nullptr, viewSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (address != MAP_FAILED) {
+            view = static_cast<std::uint8_t*>(address);
+        }
+#endif
+
+        if (view == nullptr) {
+            std::printf("Stats Error: cannot map %s\n", file_name);
+            close();
+            return false;
+        }
+
+        std::uint32_t fileRecords = 0;
+        if (fileSize < sizeof(StatsHeader)) {
+            if (!grow(grow_records)) {
+                std::printf("Stats Error: cannot size %s\n", file_name);
+                close();
+                return false;
+            }
+            StatsHeader header{ { stats_magic[0], stats_magic[1], stats_magic[2], stats_magic[3] }, stats_version, sizeof(StatsRecord), {} };
+            std::memcpy(view, &header, sizeof(header));
+        }
+        else {
+            StatsHeader header;
+            std::memcpy(&header, view, sizeof(header));
+            if (std::memcmp(header.magic, stats_magic, sizeof(stats_magic)) != 0 || header.version != stats_version || header.recordSize != sizeof(StatsRecord)) {
+                std::printf("Stats Error: %s is not a stats file this version reads\n", file_name);
+                close();
+                return false;
+            }
+            if (fileSize > recordOffset(0)) {
+                fileRecords = static_cast<std::uint32_t>(std::min<std::size_t>((fileSize - recordOffset(0)) / sizeof(StatsRecord), stats_max_records));
+            }
+
+            // the index stands for the records it counts while it is intact and the last of them is still there
+            StatsIndex index;
+            std::memcpy(&index, view + sizeof(StatsHeader), sizeof(index));
+            if (index.checksum == indexChecksum(index) && index.records > 0 && index.records <= fileRecords) {
+                const StatsRecord& last = *record(index.records - 1);
+                if (last.sequence == index.records && last.checksum == statsChecksum(last)) {
+                    stats = index.summary;
+                    count = index.records;
+                }
+            }
+        }
+        std::uint32_t indexed = count;
+
+        // the log is every record up to the first one out of sequence or failing its checksum. Whatever a crash left
+        // past it is cleared, a record the disk kept after a torn one would otherwise join the log once the
+        // appends reach its sequence number again
+        while (count < fileRecords) {
+            const StatsRecord& next = *record(count);
+            if (next.sequence != count + 1 || next.checksum != statsChecksum(next)) {
+                break;
+            }
+            stats.add(next);
+            count++;
+        }
+        std::uint32_t cleared = count;
+        for (std::uint32_t i = count; i < fileRecords; i++) {
+            if (!isZero(*record(i))) {
+                std::memset(record(i), 0, sizeof(StatsRecord));
+                discardedRecords++;
+                cleared = i + 1;
+            }
+        }
+        if (cleared > count) {
+            flush(recordOffset(count), recordOffset(cleared), true);
+        }
+
+        if (!grow(std::max(fileRecords, std::min(count + grow_records, stats_max_records)))) {
+            std::printf("Stats Error: cannot size %s\n", file_name);
+            close();
+            return false;
+        }
+
+        indexSummary = stats;
+        indexedRecords = count;
+        if (count != indexed) {
+            writeIndex(count);
+        }
+
+        written.store(count, std::memory_order_release);
+        running = true;
+        flusher = std::thread(&StatsStore::flushLoop, this);
+
+        std::printf("Stats: %u records in %s, %u read past the index", count, file_name, count - indexed);
+        if (discardedRecords > 0) {
+            std::printf(", %u torn or orphaned ones cleared", discardedRecords);
+        }
+        std::printf("\n");
+        return true;
+    }
+
+    void StatsStore::close() {
+        if (flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                running.store(false, std::memory_order_release);
+            }
+            wake.notify_one();
+            flusher.join();
+            std::printf("Stats: %u records, %u dropped\n", count, droppedRecords);
+        }
+        running = false;
+
+#if defined(_WIN32)
+        if (view != nullptr) UnmapViewOfFile(view);
+        if (mapping != 0) CloseHandle(native(mapping));
+        if (file != no_handle) CloseHandle(native(file));
+#else
+        if (view != nullptr) munmap(view, viewSize);
+        if (file != no_handle) ::close(static_cast<int>(file));
+#endif
+
+        view = nullptr;
+        mapping = 0;
+        file = no_handle;
+        stats = StatsSummary{};
+        indexSummary = StatsSummary{};
+        indexedRecords = 0;
+        count = 0;
+        discardedRecords = 0;
+        droppedRecords = 0;
+        written.store(0, std::memory_order_relaxed);
+        capacity.store(0, std::memory_order_relaxed);
+    }
+
+    bool StatsStore::isOpen() const {
+        return view != nullptr;
+    }
+
+    bool StatsStore::append(const StatsRecord& entry) {
+        if (view == nullptr || count >= capacity.load(std::memory_order_acquire)) {
+            droppedRecords++;
+            return false;
+        }
+
+        StatsRecord copy = entry;
+        copy.sequence = count + 1;
+        copy.checksum = statsChecksum(copy);
+
+        // the checksum goes in last, a record is only valid once all of it is there
+        StatsRecord* slot = record(count);
+        std::memcpy(slot, &copy, checked_bytes);
+        std::memcpy(&slot->checksum, &copy.checksum, sizeof(copy.checksum));
+
+        count++;
+        written.store(count, std::memory_order_release);
+        stats.add(copy);
+        return true;
+    }
+
+    const StatsSummary& StatsStore::summary() const {
+        return stats;
+    }
+
+    std::uint32_t StatsStore::discarded() const {
+        return discardedRecords;
+    }
+
+    std::uint32_t StatsStore::dropped() const {
+        return droppedRecords;
+    }
+
+    void StatsStore::flushLoop() {
+        // the header and index of a new file are written out with the first flush
+        std::uint32_t flushed = written.load(std::memory_order_acquire);
+        flush(0, recordOffset(flushed), false);
+
+        while (true) {
+            bool stopping = !running.load(std::memory_order_acquire);
+
+            // the records reach the disk before the index that counts them
+            std::uint32_t end = written.load(std::memory_order_acquire);
+            if (stopping || end > flushed) {
+                flush(stopping ? 0 : recordOffset(flushed), recordOffset(end), true);
+                writeIndex(end);
+                flush(sizeof(StatsHeader), sizeof(StatsHeader) + sizeof(StatsIndex), stopping);
+            }
+            flushed = end;
+
+            std::uint32_t room = capacity.load(std::memory_order_relaxed);
+            if (room < stats_max_records && end + grow_records / 2 > room) {
+                grow(std::min(room + grow_records, stats_max_records));
+            }
+
+            if (stopping) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, flush_interval, [this]() { return !running.load(std::memory_order_acquire); });
+        }
+    }
+
+    bool StatsStore::grow(std::uint32_t records) {
+        if (records <= capacity.load(std::memory_order_relaxed)) {
+            return true;
+        }
+
+#if defined(_WIN32)
+        // the section already gave the file its full size
+        records = stats_max_records;
+#else
+        if (ftruncate(static_cast<int>(file), static_cast<off_t>(recordOffset(records))) != 0) {
+            return false;
+        }
+#endif
+
+        capacity.store(records, std::memory_order_release);
+        return true;
+    }
+
+    void StatsStore::flush(std::size_t from, std::size_t to, bool wait) {
+#if defined(_WIN32)
+        FlushViewOfFile(view + from, to - from);
+        if (wait) {
+            FlushFileBuffers(native(file));
+        }
+#else
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t start = from / page * page;
+        msync(view + start, to - start, wait ? MS_SYNC : MS_ASYNC);
+#endif
+    }
+
+    void StatsStore::writeIndex(std::uint32_t end) {
+        for (std::uint32_t i = indexedRecords; i < end; i++) {
+            indexSummary.add(*record(i));
+        }
+        indexedRecords = end;
+
+        StatsIndex index{};
+        index.records = indexedRecords;
+        index.summary = indexSummary;
+        index.checksum = indexChecksum(index);
+        std::memcpy(view + sizeof(StatsHeader), &index, sizeof(index));
+    }
+
+    StatsRecord* StatsStore::record(std::uint32_t index) const {
+        return reinterpret_cast<StatsRecord*>(view + recordOffset(index));
+    }
+
+    StatsStore::~StatsStore() {
+        close();
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef YUME_STATS_STORE
+#define YUME_STATS_STORE
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace yume {
+
+    // File layout: StatsHeader, the StatsIndex in stats_index_size bytes, then StatsRecord after StatsRecord in the
+    // order they were appended. The file is mapped, a record is written straight into the mapping and is in the
+    // system's page cache as soon as append() returns, so it survives the game crashing. Each record carries its
+    // sequence number and a checksum, a record torn by the machine going down is where the log ends on the next open.
+    // Host byte order, as the flight logs.
+    constexpr char stats_magic[4] = { 'Y', 'S', 'T', 'S' };
+    constexpr std::uint16_t stats_version = 2;
+    constexpr std::size_t stats_index_size = 512;
+    constexpr std::uint32_t stats_max_records = 1 << 16;  // one per attempt, later ones are dropped
+    constexpr int stats_stages = 16;
+
+    enum StatsKind : std::uint8_t {
+        stats_landed = 1,
+        stats_crashed = 2,
+    };
+
+    enum StatsFlags : std::uint8_t {
+        stats_autopilot = 1 << 0,  // the autopilot flew some of the attempt
+    };
+
+    struct StatsHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t recordSize;
+        std::uint8_t reserved[24];
+    };
+
+    // one finished attempt
+    struct StatsRecord {
+        std::uint32_t sequence;  // 1 for the first record, a record out of sequence is not part of the log
+        std::uint32_t unixTime;
+        std::uint32_t attempt;
+        std::uint16_t streak;    // the win streak the attempt ended with
+        std::uint8_t kind;       // StatsKind
+        std::uint8_t stage;
+        std::uint8_t flags;      // StatsFlags
+        std::uint8_t reserved[3];
+        float flightSeconds;
+        float landingSpeed;      // how fast the rocket touched down, for crashes as well
+        std::uint32_t checksum;  // FNV-1a over everything before it
+    };
+
+    static_assert(sizeof(StatsHeader) == 32 && sizeof(StatsRecord) == 32, "the stats file layout changed");
+
+    std::uint32_t statsChecksum(const StatsRecord& record);
+
+    // The aggregates the menu shows, read from the index on open and kept up to date by append(). Attempts the
+    // autopilot helped with are only counted in assisted.
+    struct StatsSummary {
+        struct Stage {
+            std::uint32_t attempts{ 0 };
+            std::uint32_t landings{ 0 };
+            std::uint32_t crashes{ 0 };
+            float bestSeconds{ 0.0f };  // the quickest landing, 0 before the first
+            double landingSpeedSum{ 0.0 };
+
+            float averageLandingSpeed() const;
+        };
+
+        std::uint32_t records{ 0 };
+        std::uint32_t assisted{ 0 };
+        std::uint32_t bestStreak{ 0 };
+        int highestStage{ 0 };  // the highest stage landed on
+        int lastStage{ 0 };
+        std::array<Stage, stats_stages> stages{};  // stages past the last share the last entry
+
+        void add(const StatsRecord& record);
+        const Stage& stage(int index) const;
+    };
+
+    // The summary of the first records records, written by the flusher once they are on disk. open() replays only
+    // the records after them, and the whole log when the checksum fails or the last record counted is not there.
+    struct StatsIndex {
+        std::uint32_t records;
+        std::uint32_t checksum;  // FNV-1a over records and summary
+        StatsSummary summary;
+    };
+
+    static_assert(sizeof(StatsSummary) == 408 && sizeof(StatsIndex) <= stats_index_size, "the stats file layout changed");
+
+    // Append-only log of every attempt. append() is a copy into the mapped file and never waits for the disk, a
+    // background thread asks the system to write the new pages out and grows the file ahead of the records.
+    class StatsStore {
+    public:
+        StatsStore();
+        StatsStore(const StatsStore&) = delete;
+        StatsStore& operator=(const StatsStore&) = delete;
+
+        // creates the file when it is missing, false when it cannot be mapped or is not a stats file
+        bool open(const char* file_name);
+        void close();
+        bool isOpen() const;
+
+        // fills in the sequence and the checksum, false when the record was dropped
+        bool append(const StatsRecord& record);
+
+        const StatsSummary& summary() const;
+        // records cleared on open because a crash left them torn, and records not kept since because the log was full
+        std::uint32_t discarded() const;
+        std::uint32_t dropped() const;
+
+        ~StatsStore();
+
+    private:
+        std::intptr_t file;
+        std::intptr_t mapping;  // the section object on Windows, unused elsewhere
+        std::uint8_t* view{ nullptr };
+        std::size_t viewSize{ 0 };
+
+        StatsSummary stats{};
+        std::uint32_t count{ 0 };
+        std::uint32_t discardedRecords{ 0 };
+        std::uint32_t droppedRecords{ 0 };
+
+        // only the flusher touches these once open() returns
+        StatsSummary indexSummary{};
+        std::uint32_t indexedRecords{ 0 };
+
+        // records below capacity are backed by the file, the flusher moves it ahead of written
+        std::atomic<std::uint32_t> written{ 0 };
+        std::atomic<std::uint32_t> capacity{ 0 };
+        std::atomic<bool> running{ false };
+        std::thread flusher;
+        std::mutex wakeMutex;  // only for close() to wake the flusher early
+        std::condition_variable wake;
+
+        void flushLoop();
+        // makes the file hold records, only the flusher and open() call it
+        bool grow(std::uint32_t records);
+        void flush(std::size_t from, std::size_t to, bool wait);
+        // adds the records up to end to the index and writes it into the mapping
+        void writeIndex(std::uint32_t end);
+        StatsRecord* record(std::uint32_t index) const;
+    };
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "telemetry.hpp"
+
+#include <chrono>
+
+namespace yume {
+
+    TelemetryRecorder::TelemetryRecorder(const std::string& file_name)
+        : file(file_name, std::ios::binary | std::ios::trunc),
+        queue(std::make_unique<SpscQueue<FlightSample, 8192>>()),
+        block(std::make_unique<FlightBlock>()) {
+        if (!file) {
+            std::cout << "Telemetry Error: cannot open " << file_name << '\n';
+            return;
+        }
+
+        FlightLogHeader header{ { flight_log_magic[0], flight_log_magic[1], flight_log_magic[2], flight_log_magic[3] }, flight_log_version, 0, flight_block_samples };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        running = true;
+        writer = std::thread(&TelemetryRecorder::writerLoop, this);
+        std::cout << "Telemetry: recording to " << file_name << '\n';
+    }
+
+    bool TelemetryRecorder::isOpen() const {
+        return running;
+    }
+
+    void TelemetryRecorder::record(const FlightSample& sample) {
+        if (running.load(std::memory_order_relaxed) && !queue->push(sample)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void TelemetryRecorder::writerLoop() {
+        FlightSample sample{};
+
+        while (true) {
+            bool stopping = !running.load(std::memory_order_acquire);
+
+            while (queue->pop(sample)) {
+                block->append(sample);
+                if (block->full()) {
+                    flushBlock();
+                }
+            }
+
+            if (stopping) {
+                break;
+            }
+
+            // 8192 samples is minutes of headroom at frame rate, a short sleep keeps the thread idle
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        flushBlock();
+        file.flush();
+    }
+
+    void TelemetryRecorder::flushBlock() {
+        if (block->count == 0) {
+            return;
+        }
+
+        block->write(file);
+        written += block->count;
+        block->count = 0;
+    }
+
+    TelemetryRecorder::~TelemetryRecorder() {
+        if (!writer.joinable()) {
+            return;
+        }
+
+        running.store(false, std::memory_order_release);
+        writer.join();
+
+        std::cout << "Telemetry: " << written << " samples written, " << dropped.load() << " dropped\n";
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef YUME_TELEMETRY
+#define YUME_TELEMETRY
+
+#include "../../config.hpp"
+#include "../core/spsc_queue.hpp"
+#include "flight_record.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace yume {
+
+    // record() is a struct copy into a preallocated ring, a background thread drains it into columnar blocks on disk.
+    class TelemetryRecorder {
+    public:
+        explicit TelemetryRecorder(const std::string& file_name);
+
+        bool isOpen() const;
+        void record(const FlightSample& sample);
+
+        ~TelemetryRecorder();
+
+    private:
+        std::ofstream file;
+        std::unique_ptr<SpscQueue<FlightSample, 8192>> queue;
+        std::unique_ptr<FlightBlock> block;
+        std::thread writer;
+        std::atomic<bool> running{ false };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::uint64_t written{ 0 };
+
+        void writerLoop();
+        void flushBlock();
+    };
+}
+
+#endif
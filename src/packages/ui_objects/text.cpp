@@ -2,7 +2,9 @@
 #include <string>
 
 Text::Text(yume::vec2<int> position_v, int font_size, SDL_Color color, std::string text_v, SDL_Renderer* renderer)
-	: position(position_v), font(TTF_OpenFont("res/fonts/IBMPlexSans-Medium.ttf", font_size)), textColor(color), text(text_v) {
+	: position(position_v), font(yume::AssetCache::font("res/fonts/IBMPlexSans-Medium.ttf", font_size)), textColor(color), text(text_v) {
+	// HUD lines are rewritten every frame, enough capacity up front keeps the assignments off the heap
+	text.reserve(128);
 	textSurface = TTF_RenderText_Solid(font, text.c_str(), textColor);
 	textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
 	SDL_FreeSurface(textSurface);
@@ -17,8 +19,14 @@ void Text::render(SDL_Renderer* renderer) {
 	SDL_RenderCopy(renderer, textTexture, NULL, &renderQuad);
 }
 
-void Text::updateText(std::string new_text, SDL_Color new_color, SDL_Renderer* renderer) {
-	text = new_text;
+void Text::updateText(std::string_view new_text, SDL_Color new_color, SDL_Renderer* renderer) {
+	bool sameColor = new_color.r == textColor.r && new_color.g == textColor.g && new_color.b == textColor.b && new_color.a == textColor.a;
+	if (textTexture != nullptr && sameColor && text == new_text) {
+		return;
+	}
+
+	text.assign(new_text);
+	textColor = new_color;
 
 	if (textTexture != nullptr) {
 		SDL_DestroyTexture(textTexture);
@@ -33,7 +41,4 @@ Text::~Text() {
 	if (textTexture != nullptr) {
 		SDL_DestroyTexture(textTexture);
 	}
-	if (font != nullptr) {
-		TTF_CloseFont(font);
-	}
 }
@@ -5,6 +5,7 @@
 
 class Text {
 private:
+	// shared with every Text of the same size, the asset cache closes it
 	TTF_Font* font;
 	SDL_Color textColor;
 	SDL_Texture* textTexture;
@@ -15,7 +16,8 @@ public:
 
 	Text(yume::vec2<int> position_v, int font_size, SDL_Color color, std::string text_v, SDL_Renderer* renderer);
 	void render(SDL_Renderer* renderer);
-	void updateText(std::string new_text, SDL_Color new_color, SDL_Renderer* renderer);
+	// re-renders only when the text or the color changed
+	void updateText(std::string_view new_text, SDL_Color new_color, SDL_Renderer* renderer);
 	~Text();
 };
 
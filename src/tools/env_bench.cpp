@@ -0,0 +1,79 @@
+// Measures the landing environments through their C interface: environment steps per second on 1 to N threads.
+// usage: yumesdl_envbench [envs] [steps] [max_threads]
+
+#include "../packages/simulation/landing_env.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    double millisecondsSince(clock_type::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    }
+
+    // random presses are drawn up front so the bench times the environments and not the generator
+    constexpr int action_frames = 64;
+}
+
+int main(int argc, char* args[]) {
+    int envs = argc > 1 ? std::max(1, std::atoi(args[1])) : 65536;
+    int steps = argc > 2 ? std::max(1, std::atoi(args[2])) : 600;
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    unsigned maxThreads = argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(args[3]))) : hardware;
+
+    std::vector<int32_t> actions(static_cast<std::size_t>(envs) * YUME_ACTION_SIZE * action_frames);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> press(-1, 1);
+    for (int32_t& action : actions) {
+        action = press(gen);
+    }
+
+    std::vector<float> obs(static_cast<std::size_t>(envs) * YUME_OBS_SIZE);
+    std::vector<float> reward(envs);
+    std::vector<uint8_t> done(envs);
+
+    std::printf("%d environments, %d steps, %u hardware threads\n", envs, steps, hardware);
+    std::printf("threads      ms   Msteps/s  episodes    wins  crashes\n");
+
+    for (unsigned threads = 1; threads <= maxThreads; threads++) {
+        yume_env* env = yume_env_create_threaded(envs, 1234, static_cast<int>(threads));
+        if (env == nullptr) {
+            std::printf("could not create %d environments\n", envs);
+            return 1;
+        }
+        yume_env_reset(env, obs.data());
+
+        long long episodes = 0, wins = 0, crashes = 0;
+        clock_type::time_point start = clock_type::now();
+        for (int step = 0; step < steps; step++) {
+            const int32_t* frame = actions.data() + static_cast<std::size_t>(step % action_frames) * envs * YUME_ACTION_SIZE;
+            yume_env_step(env, frame, obs.data(), reward.data(), done.data());
+        }
+        double elapsed = millisecondsSince(start);
+
+        // counted in a second run so the tally stays out of the timing
+        yume_env_reset(env, obs.data());
+        for (int step = 0; step < steps; step++) {
+            const int32_t* frame = actions.data() + static_cast<std::size_t>(step % action_frames) * envs * YUME_ACTION_SIZE;
+            yume_env_step(env, frame, obs.data(), reward.data(), done.data());
+            for (int i = 0; i < envs; i++) {
+                episodes += done[i];
+                wins += reward[i] > 0.0f;
+                crashes += reward[i] < 0.0f;
+            }
+        }
+        yume_env_destroy(env);
+
+        double stepsPerSecond = static_cast<double>(envs) * steps / (elapsed / 1000.0);
+        std::printf("%7u %7.1f %10.2f %9lld %7lld %8lld\n", threads, elapsed, stepsPerSecond / 1e6, episodes, wins, crashes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,378 @@
+// Runs the real Menu and Game scenes headless on the software renderer and reports frame costs as JSON.
+// Every scenario gets a fresh scene manager, scripted keys, a fixed 60 Hz clock and a fixed seed, so two runs
+// render the same frames and --checksum can tell whether a rendering change altered any pixel.
+// usage: yumesdl_framebench [--out framebench.json] [--seed N] [--checksum]
+
+#include "../config.hpp"
+#include "../packages/scenes/scene.hpp"
+#include "../packages/scenes/menu.hpp"
+#include "../packages/scenes/game.hpp"
+#include "../packages/scenes/split_screen.hpp"
+#include "../packages/core/allocation_tracker.hpp"
+#include "../packages/render/asset_cache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    // draw calls and texture creations of everything linked into the bench, counted through the linker's --wrap
+    struct CallCounters {
+        std::uint64_t drawCalls{ 0 };
+        std::uint64_t texturesCreated{ 0 };
+    };
+    CallCounters counters;
+}
+
+#if defined(YUME_COUNT_SDL_CALLS)
+extern "C" {
+    int __real_SDL_RenderCopy(SDL_Renderer*, SDL_Texture*, const SDL_Rect*, const SDL_Rect*);
+    int __real_SDL_RenderCopyEx(SDL_Renderer*, SDL_Texture*, const SDL_Rect*, const SDL_Rect*, const double, const SDL_Point*, const SDL_RendererFlip);
+    int __real_SDL_RenderDrawLines(SDL_Renderer*, const SDL_Point*, int);
+    int __real_SDL_RenderFillRect(SDL_Renderer*, const SDL_Rect*);
+    int __real_SDL_RenderClear(SDL_Renderer*);
+    int __real_SDL_RenderGeometry(SDL_Renderer*, SDL_Texture*, const SDL_Vertex*, int, const int*, int);
+    SDL_Texture* __real_SDL_CreateTexture(SDL_Renderer*, Uint32, int, int, int);
+    SDL_Texture* __real_SDL_CreateTextureFromSurface(SDL_Renderer*, SDL_Surface*);
+
+    int __wrap_SDL_RenderCopy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst) {
+        counters.drawCalls++;
+        return __real_SDL_RenderCopy(renderer, texture, src, dst);
+    }
+
+    int __wrap_SDL_RenderCopyEx(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+        const double angle, const SDL_Point* center, const SDL_RendererFlip flip) {
+        counters.drawCalls++;
+        return __real_SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip);
+    }
+
+    int __wrap_SDL_RenderDrawLines(SDL_Renderer* renderer, const SDL_Point* points, int count) {
+        counters.drawCalls++;
+        return __real_SDL_RenderDrawLines(renderer, points, count);
+    }
+
+    int __wrap_SDL_RenderFillRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+        counters.drawCalls++;
+        return __real_SDL_RenderFillRect(renderer, rect);
+    }
+
+    int __wrap_SDL_RenderClear(SDL_Renderer* renderer) {
+        counters.drawCalls++;
+        return __real_SDL_RenderClear(renderer);
+    }
+
+    int __wrap_SDL_RenderGeometry(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Vertex* vertices, int vertexCount,
+        const int* indices, int indexCount) {
+        counters.drawCalls++;
+        return __real_SDL_RenderGeometry(renderer, texture, vertices, vertexCount, indices, indexCount);
+    }
+
+    SDL_Texture* __wrap_SDL_CreateTexture(SDL_Renderer* renderer, Uint32 format, int access, int w, int h) {
+        counters.texturesCreated++;
+        return __real_SDL_CreateTexture(renderer, format, access, w, h);
+    }
+
+    SDL_Texture* __wrap_SDL_CreateTextureFromSurface(SDL_Renderer* renderer, SDL_Surface* surface) {
+        counters.texturesCreated++;
+        return __real_SDL_CreateTextureFromSurface(renderer, surface);
+    }
+}
+constexpr bool calls_counted = true;
+#else
+constexpr bool calls_counted = false;
+#endif
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr int screen_width = 800;
+    constexpr int screen_height = 600;
+    // far above any frame the bench measures, the resolution scaler stays at full size so checksums are comparable
+    constexpr float fixed_scale_frame_ms = 1000.0f;
+
+    // Game with the setup hooks the scenarios need, the members are protected for exactly this
+    class BenchGame : public Game {
+    public:
+        using Game::Game;
+
+        // jumps to a stage and drops the rocket from a few pixels above the middle of the island
+        void dropOnIsland(int stage, float rotation) {
+            islandStage = stage;
+            island->size = yume::vec2<float>{ 100.0f - 6.5f * stage, 66.0f - 6.5f * stage };
+            airstrip->size = island->size;
+            airstrip->position = island->position;
+            refreshIslandLayer();
+
+            rocket->position = yume::vec2<float>{ island->position.x + island->size.x / 2.0f - rocket->size.x / 2.0f, island->position.y - rocket->size.y - 10.0f };
+            rocket->velocity = yume::vec2<float>::ZERO();
+            rocket->previousVelocity = yume::vec2<float>::ZERO();
+            rocket->rotation = rotation;
+            rocket->rotationalVelocity = 0.0f;
+            rocket->thrust = 0.0f;
+        }
+    };
+
+    enum class StartScene { Menu, Game, SplitScreen };
+
+    struct Scenario {
+        const char* name;
+        StartScene scene;
+        int frames;
+        std::function<void(BenchGame&)> setup;
+        // sets the keys held in this frame
+        std::function<void(int, Uint8*)> input;
+        // pilots of the split screen scenarios
+        int pilots{ 0 };
+    };
+
+    struct Result {
+        const char* name;
+        int frames{ 0 };
+        std::vector<float> frameMs;
+        FrameTimings phaseTotals;
+        std::uint64_t drawCalls{ 0 };
+        std::uint64_t texturesCreated{ 0 };
+        std::uint64_t setupTexturesCreated{ 0 };
+        std::uint64_t checksum{ 0 };
+        std::vector<std::uint64_t> frameChecksums;
+    };
+
+    constexpr std::uint64_t fnv_offset = 14695981039346656037ull;
+    constexpr std::uint64_t fnv_prime = 1099511628211ull;
+
+    std::uint64_t hashBytes(std::uint64_t hash, const Uint8* data, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * fnv_prime;
+        }
+        return hash;
+    }
+
+    // the visible rows only, the pitch padding is not part of the frame
+    std::uint64_t hashSurface(SDL_Surface* surface) {
+        std::uint64_t hash = fnv_offset;
+        SDL_LockSurface(surface);
+        for (int y = 0; y < surface->h; y++) {
+            const Uint8* row = static_cast<const Uint8*>(surface->pixels) + static_cast<std::size_t>(y) * surface->pitch;
+            hash = hashBytes(hash, row, static_cast<std::size_t>(surface->w) * surface->format->BytesPerPixel);
+        }
+        SDL_UnlockSurface(surface);
+        return hash;
+    }
+
+    float percentile(std::vector<float> values, float fraction) {
+        if (values.empty()) {
+            return 0.0f;
+        }
+        std::size_t index = static_cast<std::size_t>(fraction * (values.size() - 1) + 0.5f);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    Result runScenario(const Scenario& scenario, SDL_Renderer* renderer, SDL_Surface* target, yume::AudioEngine& audio, yume::JobSystem& jobs,
+        unsigned seed, bool checksum) {
+        Result result;
+        result.name = scenario.name;
+
+        std::vector<Uint8> keys(SDL_NUM_SCANCODES, 0);
+        Uint32 ticks = 0;
+
+        std::uint64_t texturesBefore = counters.texturesCreated;
+
+        SceneManager manager(renderer, nullptr, &audio);
+        manager.setInputOverride(keys.data(), &ticks);
+        manager.addScene<Menu>();
+        manager.addScene<BenchGame>(&audio, nullptr, &jobs, fixed_scale_frame_ms, seed);
+        if (scenario.scene == StartScene::SplitScreen) {
+            manager.addScene<SplitScreen>(&audio, seed);
+            static_cast<SplitScreen*>(manager.getScene(2))->setPilotCount(scenario.pilots);
+            manager.switchScene(2);
+        }
+        else if (scenario.scene == StartScene::Game) {
+            manager.switchScene(1);
+            if (scenario.setup) {
+                scenario.setup(*static_cast<BenchGame*>(manager.getScene(1)));
+            }
+        }
+        else {
+            manager.switchScene(0);
+        }
+
+        result.setupTexturesCreated = counters.texturesCreated - texturesBefore;
+        result.checksum = fnv_offset;
+        result.frameMs.reserve(scenario.frames);
+
+        for (int frame = 0; frame < scenario.frames && manager.isRunning(); frame++) {
+            ticks = static_cast<Uint32>((frame + 1) * 1000.0 / 60.0 + 0.5);
+
+            std::fill(keys.begin(), keys.end(), 0);
+            scenario.input(frame, keys.data());
+
+            // a held key repeats, the scenes only look at the keyboard while events arrive
+            for (int scancode = 0; scancode < SDL_NUM_SCANCODES; scancode++) {
+                if (keys[scancode]) {
+                    SDL_Event event{};
+                    event.type = SDL_KEYDOWN;
+                    event.key.keysym.scancode = static_cast<SDL_Scancode>(scancode);
+                    event.key.repeat = frame > 0;
+                    SDL_PushEvent(&event);
+                }
+            }
+
+            std::uint64_t drawCallsBefore = counters.drawCalls;
+            std::uint64_t texturesBeforeFrame = counters.texturesCreated;
+
+            clock_type::time_point start = clock_type::now();
+            manager.step();
+            result.frameMs.push_back(std::chrono::duration<float, std::milli>(clock_type::now() - start).count());
+
+            const FrameTimings& phases = manager.lastTimings();
+            result.phaseTotals.eventsMs += phases.eventsMs;
+            result.phaseTotals.audioMs += phases.audioMs;
+            result.phaseTotals.updateMs += phases.updateMs;
+            result.phaseTotals.renderMs += phases.renderMs;
+            result.drawCalls += counters.drawCalls - drawCallsBefore;
+            result.texturesCreated += counters.texturesCreated - texturesBeforeFrame;
+            result.frames += 1;
+
+            if (checksum) {
+                std::uint64_t frameHash = hashSurface(target);
+                result.frameChecksums.push_back(frameHash);
+                result.checksum = hashBytes(result.checksum, reinterpret_cast<const Uint8*>(&frameHash), sizeof(frameHash));
+            }
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char* args[]) {
+    const char* outFile = "framebench.json";
+    unsigned seed = 1234;
+    bool checksum = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(args[i], "--out") == 0 && i + 1 < argc) {
+            outFile = args[++i];
+        }
+        else if (std::strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::strtoul(args[++i], nullptr, 10));
+        }
+        else if (std::strcmp(args[i], "--checksum") == 0) {
+            checksum = true;
+        }
+        else {
+            std::cout << "usage: " << args[0] << " [--out framebench.json] [--seed N] [--checksum]\n";
+            return 1;
+        }
+    }
+
+    // headless unless the caller picked drivers, the frames go into a plain surface and never reach a window
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    // a ghost left in ghosts/ by a played game would change what the scenarios draw
+    SDL_setenv("YUME_GHOSTS", "off", 1);
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
+        std::cout << "SDL_Init Error: " << SDL_GetError() << '\n';
+        return 1;
+    }
+    TTF_Init();
+
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, screen_width, screen_height, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (renderer == nullptr) {
+        std::cout << "SDL_CreateSoftwareRenderer Error: " << SDL_GetError() << '\n';
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios = {
+        { "menu_idle", StartScene::Menu, 300, nullptr, [](int, Uint8*) {} },
+        // down, down, up, up, one press every 20 frames
+        { "menu_hover", StartScene::Menu, 320, nullptr, [](int frame, Uint8* keys) {
+            if (frame % 20 == 0) {
+                keys[(frame / 20) % 4 < 2 ? SDL_SCANCODE_DOWN : SDL_SCANCODE_UP] = 1;
+            }
+        } },
+        { "full_thrust_climb", StartScene::Game, 600, nullptr, [](int frame, Uint8* keys) {
+            keys[frame == 0 ? SDL_SCANCODE_UP : SDL_SCANCODE_W] = 1;
+        } },
+        // touches down upright, the four second countdown runs and the win screen shows
+        { "landing", StartScene::Game, 420, [](BenchGame& game) { game.dropOnIsland(0, 90.0f); }, [](int, Uint8*) {} },
+        { "crash_stage_9", StartScene::Game, 240, [](BenchGame& game) { game.dropOnIsland(yume::final_stage, 140.0f); }, [](int, Uint8*) {} },
+        // every pilot climbs at full thrust, the panes follow them up and the frame cost should stay well under
+        // pilots times full_thrust_climb
+        { "split_2", StartScene::SplitScreen, 600, nullptr, [](int, Uint8* keys) {
+            keys[SDL_SCANCODE_W] = keys[SDL_SCANCODE_UP] = 1;
+        }, 2 },
+        { "split_4", StartScene::SplitScreen, 600, nullptr, [](int, Uint8* keys) {
+            keys[SDL_SCANCODE_W] = keys[SDL_SCANCODE_UP] = keys[SDL_SCANCODE_I] = keys[SDL_SCANCODE_KP_8] = 1;
+        }, 4 },
+    };
+
+    std::vector<Result> results;
+    {
+        yume::AudioEngine audio(44100, 512);
+        yume::JobSystem jobs;
+        yume::AllocationTracker::trackThisThread();
+
+        for (const Scenario& scenario : scenarios) {
+            results.push_back(runScenario(scenario, renderer, target, audio, jobs, seed, checksum));
+        }
+    }
+    // the scenarios share the fonts, they stay open until here
+    yume::AssetCache::clear();
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+
+    std::FILE* out = std::fopen(outFile, "w");
+    if (out == nullptr) {
+        std::cout << "cannot open " << outFile << '\n';
+        SDL_Quit();
+        return 1;
+    }
+
+    std::fprintf(out, "{\n  \"renderer\": \"software\",\n  \"width\": %d,\n  \"height\": %d,\n  \"seed\": %u,\n  \"frame_step_ms\": %.4f,\n",
+        screen_width, screen_height, seed, 1000.0 / 60.0);
+    std::fprintf(out, "  \"scenarios\": [\n");
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        float frames = static_cast<float>(std::max(result.frames, 1));
+        float total = 0.0f;
+        for (float ms : result.frameMs) total += ms;
+
+        std::fprintf(out, "    {\n      \"name\": \"%s\",\n      \"frames\": %d,\n", result.name, result.frames);
+        std::fprintf(out, "      \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            total / frames, percentile(result.frameMs, 0.5f), percentile(result.frameMs, 0.9f), percentile(result.frameMs, 0.99f), percentile(result.frameMs, 1.0f));
+        std::fprintf(out, "      \"phase_ms_mean\": { \"events\": %.4f, \"audio\": %.4f, \"update\": %.4f, \"render\": %.4f },\n",
+            result.phaseTotals.eventsMs / frames, result.phaseTotals.audioMs / frames, result.phaseTotals.updateMs / frames, result.phaseTotals.renderMs / frames);
+
+        if (calls_counted) {
+            std::fprintf(out, "      \"draw_calls\": %llu,\n      \"draw_calls_per_frame\": %.2f,\n      \"textures_created\": %llu,\n      \"setup_textures_created\": %llu",
+                static_cast<unsigned long long>(result.drawCalls), result.drawCalls / frames,
+                static_cast<unsigned long long>(result.texturesCreated), static_cast<unsigned long long>(result.setupTexturesCreated));
+        }
+        else {
+            std::fprintf(out, "      \"draw_calls\": null,\n      \"draw_calls_per_frame\": null,\n      \"textures_created\": null,\n      \"setup_textures_created\": null");
+        }
+
+        if (checksum) {
+            std::fprintf(out, ",\n      \"checksum\": \"%016llx\",\n      \"frame_checksums\": [", static_cast<unsigned long long>(result.checksum));
+            for (std::size_t frame = 0; frame < result.frameChecksums.size(); frame++) {
+                std::fprintf(out, "%s\"%016llx\"", frame == 0 ? "" : ", ", static_cast<unsigned long long>(result.frameChecksums[frame]));
+            }
+            std::fprintf(out, "]");
+        }
+        std::fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    std::fclose(out);
+
+    for (const Result& result : results) {
+        std::printf("%-18s %4d frames  p50 %7.3f ms  p99 %7.3f ms\n", result.name, result.frames, percentile(result.frameMs, 0.5f), percentile(result.frameMs, 0.99f));
+    }
+    std::printf("wrote %s\n", outFile);
+
+    SDL_Quit();
+    return 0;
+}
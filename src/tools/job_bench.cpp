@@ -0,0 +1,108 @@
+// Measures the job system: spawn overhead, dependency chains and parallelFor scaling from 1 to N threads.
+// usage: yumesdl_jobbench [max_threads]
+
+#include "../packages/jobs/job_system.hpp"
+#include "../packages/simulation/flight_model.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    double millisecondsSince(clock_type::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    }
+
+    // a few seconds of flight per item, the same kind of work the autopilot fans out
+    float simulateFlight(std::size_t seed) {
+        yume::RocketState rocket{ { 575, 410 }, { 32, 64 }, { 0, 0 }, { 0, 0 }, 90, 0, 9.81f, 0, false, false, true, true };
+        yume::IslandState island{ { 100.0f + seed % 300, 100.0f + seed % 250 }, { 100, 66 }, 0, 0, false, 0 };
+
+        for (int step = 0; step < 600; step++) {
+            if (step % 3 == 0) yume::increaseThrust(rocket);
+            if (step % 17 == 0) yume::rotateLeft(rocket);
+            yume::stepFlight(rocket, island, 1.0f / 60.0f);
+        }
+        return rocket.position.x + rocket.position.y;
+    }
+}
+
+int main(int argc, char* args[]) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    unsigned maxThreads = argc > 1 ? static_cast<unsigned>(std::max(1, std::atoi(args[1]))) : hardware;
+
+    std::printf("hardware threads: %u\n\n", hardware);
+
+    {
+        yume::JobSystem jobs(maxThreads);
+        std::atomic<std::uint64_t> sum{ 0 };
+
+        const int batches = 1000;
+        const int batchSize = 1000;
+        clock_type::time_point start = clock_type::now();
+        for (int batch = 0; batch < batches; batch++) {
+            yume::JobCounter counter;
+            for (int i = 0; i < batchSize; i++) {
+                jobs.run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            jobs.wait(counter);
+        }
+        double elapsed = millisecondsSince(start);
+        std::printf("spawn + run + wait, empty jobs:  %8.1f ns/job  (%llu jobs, %u threads)\n",
+            elapsed * 1e6 / (batches * batchSize), static_cast<unsigned long long>(sum.load()), jobs.threadCount());
+
+        // chains stay well below the per-worker job ring, parked continuations occupy ring slots
+        const int chains = 100;
+        const int chainLength = 1000;
+        std::vector<yume::JobCounter> links(chainLength);
+        start = clock_type::now();
+        for (int chain = 0; chain < chains; chain++) {
+            jobs.run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &links[0]);
+            for (int i = 1; i < chainLength; i++) {
+                jobs.runAfter(links[i - 1], [&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &links[i]);
+            }
+            jobs.wait(links[chainLength - 1]);
+        }
+        elapsed = millisecondsSince(start);
+        std::printf("dependency chain:                %8.1f ns/link (%d x %d links)\n\n", elapsed * 1e6 / (chains * chainLength), chains, chainLength);
+    }
+
+    const std::size_t items = 4096;
+    double baseline = 0.0;
+
+    std::printf("parallelFor over %zu flight simulations\n", items);
+    std::printf("threads      ms   speedup  efficiency\n");
+
+    for (unsigned threads = 1; threads <= maxThreads; threads++) {
+        yume::JobSystem jobs(threads);
+        std::vector<float> results(items);
+
+        // warm up the workers once, then take the best of three
+        double best = 0.0;
+        for (int run = 0; run < 4; run++) {
+            clock_type::time_point start = clock_type::now();
+            jobs.parallelFor(items, 16, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    results[i] = simulateFlight(i);
+                }
+            });
+            double elapsed = millisecondsSince(start);
+            if (run == 1 || (run > 1 && elapsed < best)) {
+                best = elapsed;
+            }
+        }
+
+        if (threads == 1) {
+            baseline = best;
+        }
+        std::printf("%7u %7.2f %8.2fx %10.0f%%\n", threads, best, baseline / best, 100.0 * baseline / best / threads);
+    }
+
+    return 0;
+}
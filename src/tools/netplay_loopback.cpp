@@ -0,0 +1,237 @@
+// Plays a versus race between two rollback sessions over real UDP sockets on 127.0.0.1, in one process and on a
+// virtual 60 Hz clock. The sockets hold back and drop their outgoing packets as configured, two scripted pilots
+// press changing inputs so the predictions keep failing. Reports how deep and how often each side rolled back,
+// what the re-simulation cost and whether both sides ended up with the same confirmed states tick for tick.
+// usage: yumesdl_netplay [--ticks N] [--latency ms] [--jitter ms] [--loss 0..1] [--rollback N] [--delay N] [--seed N]
+//                        [--json netplay.json]
+
+#include "../packages/net/rollback_session.hpp"
+#include "../packages/net/udp_socket.hpp"
+#include "../packages/simulation/versus.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr double tick_ms = 1000.0 / 60.0;
+    constexpr int drain_frames = 60 * 30;  // after the script, how long to wait for both sides to confirm the last tick
+    constexpr int stall_allowance = 4;     // a link too slow for the rollback window stalls, it gets this many frames per tick
+
+    // held for 4 to 40 ticks at a time, mostly climbing with a turn now and then, like a player fighting for the island
+    std::vector<yume::VersusInput> scriptPilot(int ticks, std::uint32_t seed) {
+        const yume::VersusInput presses[] = {
+            yume::versus_thrust_up, yume::versus_thrust_up, yume::versus_thrust_up | yume::versus_rotate_left,
+            yume::versus_thrust_up | yume::versus_rotate_right, yume::versus_thrust_down, yume::versus_rotate_left,
+            yume::versus_rotate_right, 0,
+        };
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> hold(4, 40);
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(sizeof(presses) / sizeof(presses[0])) - 1);
+
+        std::vector<yume::VersusInput> script;
+        script.reserve(ticks);
+        while (static_cast<int>(script.size()) < ticks) {
+            script.insert(script.end(), std::min(hold(random), ticks - static_cast<int>(script.size())), presses[pick(random)]);
+        }
+        return script;
+    }
+
+    struct Peer {
+        std::vector<yume::VersusInput> script;
+        std::vector<std::uint64_t> checksums;  // confirmed checksums in tick order
+        std::vector<float> advanceMs;
+    };
+
+    float percentile(std::vector<float> values, float fraction) {
+        if (values.empty()) {
+            return 0.0f;
+        }
+        std::size_t index = static_cast<std::size_t>(fraction * (values.size() - 1) + 0.5f);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+}
+
+int main(int argc, char* args[]) {
+    int ticks = 60 * 60;
+    yume::NetConditions conditions{ 50.0f, 10.0f, 0.05f, 1 };
+    yume::RollbackSettings settings;
+    std::uint32_t seed = 1234;
+    const char* jsonFile = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(args[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::max(1, std::atoi(args[++i]));
+        }
+        else if (std::strcmp(args[i], "--latency") == 0 && i + 1 < argc) {
+            conditions.latencyMs = std::max(0.0f, static_cast<float>(std::atof(args[++i])));
+        }
+        else if (std::strcmp(args[i], "--jitter") == 0 && i + 1 < argc) {
+            conditions.jitterMs = std::max(0.0f, static_cast<float>(std::atof(args[++i])));
+        }
+        else if (std::strcmp(args[i], "--loss") == 0 && i + 1 < argc) {
+            conditions.loss = std::clamp(static_cast<float>(std::atof(args[++i])), 0.0f, 0.9f);
+        }
+        else if (std::strcmp(args[i], "--rollback") == 0 && i + 1 < argc) {
+            settings.maxRollback = std::atoi(args[++i]);
+        }
+        else if (std::strcmp(args[i], "--delay") == 0 && i + 1 < argc) {
+            settings.inputDelay = std::atoi(args[++i]);
+        }
+        else if (std::strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::strtoul(args[++i], nullptr, 10));
+        }
+        else if (std::strcmp(args[i], "--json") == 0 && i + 1 < argc) {
+            jsonFile = args[++i];
+        }
+        else {
+            std::printf("usage: %s [--ticks N] [--latency ms] [--jitter ms] [--loss 0..1] [--rollback N] [--delay N] [--seed N] [--json netplay.json]\n", args[0]);
+            return 1;
+        }
+    }
+
+    yume::UdpSocket sockets[2];
+    for (yume::UdpSocket& socket : sockets) {
+        if (!socket.open(0)) {
+            return 1;
+        }
+    }
+    for (int p = 0; p < 2; p++) {
+        if (!sockets[p].setPeer("127.0.0.1", sockets[1 - p].localPort())) {
+            return 1;
+        }
+        yume::NetConditions direction = conditions;
+        direction.seed = seed * 2 + static_cast<std::uint32_t>(p) + 1;
+        sockets[p].setConditions(direction);
+    }
+
+    yume::VersusState start = yume::startVersus(2, seed);
+    yume::RollbackSession sessions[2] = {
+        yume::RollbackSession(sockets[0], 0, start, nullptr, settings),
+        yume::RollbackSession(sockets[1], 1, start, nullptr, settings),
+    };
+
+    Peer peers[2];
+    for (int p = 0; p < 2; p++) {
+        peers[p].script = scriptPilot(ticks, seed + 17 * static_cast<std::uint32_t>(p + 1));
+        peers[p].advanceMs.reserve(static_cast<std::size_t>(ticks) * stall_allowance + drain_frames);
+    }
+
+    // after the script both sides press nothing until each has confirmed every scripted tick
+    clock_type::time_point runStart = clock_type::now();
+    int frame = 0;
+    for (; frame < ticks * stall_allowance + drain_frames; frame++) {
+        double now = frame * tick_ms;
+        for (int p = 0; p < 2; p++) {
+            std::uint32_t tick = sessions[p].currentTick();
+            yume::VersusInput input = tick < peers[p].script.size() ? peers[p].script[tick] : 0;
+
+            clock_type::time_point start = clock_type::now();
+            sessions[p].advance(input, now);
+            peers[p].advanceMs.push_back(std::chrono::duration<float, std::milli>(clock_type::now() - start).count());
+
+            std::uint64_t checksum;
+            while (sessions[p].confirmedChecksum(static_cast<std::uint32_t>(peers[p].checksums.size()), checksum)) {
+                peers[p].checksums.push_back(checksum);
+            }
+        }
+
+        if (peers[0].checksums.size() >= static_cast<std::size_t>(ticks) && peers[1].checksums.size() >= static_cast<std::size_t>(ticks)) {
+            break;
+        }
+    }
+    float elapsedMs = std::chrono::duration<float, std::milli>(clock_type::now() - runStart).count();
+
+    std::size_t compared = std::min(peers[0].checksums.size(), peers[1].checksums.size());
+    std::size_t desyncs = 0;
+    long long firstDesync = -1;
+    for (std::size_t tick = 0; tick < compared; tick++) {
+        if (peers[0].checksums[tick] != peers[1].checksums[tick]) {
+            desyncs += 1;
+            if (firstDesync < 0) {
+                firstDesync = static_cast<long long>(tick);
+            }
+        }
+    }
+
+    float seconds = static_cast<float>(frame * tick_ms / 1000.0);
+    std::printf("%d ticks, latency %.0f ms, jitter %.0f ms, loss %.1f%%, rollback %d, delay %d, %d frames in %.0f ms\n\n",
+        ticks, conditions.latencyMs, conditions.jitterMs, conditions.loss * 100.0f, settings.maxRollback, settings.inputDelay, frame, elapsedMs);
+    std::printf("peer  ticks  rollbacks  avg depth  max depth  resim ticks  resim ms avg/max  advance ms p50/p99/max  stalls  waits  sent KB/s\n");
+    for (int p = 0; p < 2; p++) {
+        const yume::RollbackStats& stats = sessions[p].stats();
+        float averageDepth = stats.rollbacks > 0 ? static_cast<float>(stats.resimulatedTicks) / stats.rollbacks : 0.0f;
+        float averageResim = stats.rollbacks > 0 ? static_cast<float>(stats.totalResimMs / stats.rollbacks) : 0.0f;
+        std::printf("%4d  %5llu  %9llu  %9.2f  %9d  %11llu  %7.3f / %6.3f  %6.3f / %6.3f / %6.3f  %6llu  %5llu  %9.2f\n",
+            p, static_cast<unsigned long long>(stats.ticks), static_cast<unsigned long long>(stats.rollbacks), averageDepth, stats.maxDepth,
+            static_cast<unsigned long long>(stats.resimulatedTicks), averageResim, stats.maxResimMs,
+            percentile(peers[p].advanceMs, 0.5f), percentile(peers[p].advanceMs, 0.99f), percentile(peers[p].advanceMs, 1.0f),
+            static_cast<unsigned long long>(stats.stalls), static_cast<unsigned long long>(stats.syncWaits),
+            seconds > 0.0f ? stats.bytesSent / 1024.0f / seconds : 0.0f);
+    }
+
+    std::printf("\nrollback depth histogram (ticks: count, peer 0 / peer 1)\n");
+    for (int depth = 1; depth < yume::RollbackStats::depth_buckets; depth++) {
+        std::uint64_t a = sessions[0].stats().depthHistogram[depth];
+        std::uint64_t b = sessions[1].stats().depthHistogram[depth];
+        if (a != 0 || b != 0) {
+            std::printf("%5d: %llu / %llu\n", depth, static_cast<unsigned long long>(a), static_cast<unsigned long long>(b));
+        }
+    }
+
+    std::printf("\n%zu confirmed ticks compared, %zu desyncs", compared, desyncs);
+    if (firstDesync >= 0) {
+        std::printf(", the first at tick %lld", firstDesync);
+    }
+    std::printf("\n");
+
+    // what each session caught on its own from the checksums in the packets, as it would between two machines
+    std::uint64_t reported = 0;
+    for (int p = 0; p < 2; p++) {
+        const yume::RollbackStats& stats = sessions[p].stats();
+        std::printf("peer %d checked %llu of the peer's checksums, %llu desyncs\n", p,
+            static_cast<unsigned long long>(stats.checksumsCompared), static_cast<unsigned long long>(stats.desyncs));
+        reported += stats.desyncs;
+    }
+
+    if (jsonFile != nullptr) {
+        std::FILE* file = std::fopen(jsonFile, "w");
+        if (file == nullptr) {
+            std::printf("could not write %s\n", jsonFile);
+            return 1;
+        }
+        std::fprintf(file, "{\n  \"ticks\": %d,\n  \"latency_ms\": %.1f,\n  \"jitter_ms\": %.1f,\n  \"loss\": %.3f,\n  \"max_rollback\": %d,\n"
+            "  \"input_delay\": %d,\n  \"compared_ticks\": %zu,\n  \"desyncs\": %zu,\n  \"peers\": [\n",
+            ticks, conditions.latencyMs, conditions.jitterMs, conditions.loss, settings.maxRollback, settings.inputDelay, compared, desyncs);
+        for (int p = 0; p < 2; p++) {
+            const yume::RollbackStats& stats = sessions[p].stats();
+            std::fprintf(file, "    { \"ticks\": %llu, \"rollbacks\": %llu, \"resimulated_ticks\": %llu, \"max_depth\": %d, \"resim_ms_total\": %.3f, "
+                "\"resim_ms_max\": %.3f, \"over_budget\": %llu, \"advance_ms_p99\": %.4f, \"stalls\": %llu, \"sync_waits\": %llu, "
+                "\"packets_sent\": %llu, \"packets_received\": %llu, \"bytes_sent\": %llu, \"checksums_compared\": %llu, \"desyncs\": %llu, "
+                "\"depth_histogram\": [",
+                static_cast<unsigned long long>(stats.ticks), static_cast<unsigned long long>(stats.rollbacks),
+                static_cast<unsigned long long>(stats.resimulatedTicks), stats.maxDepth, stats.totalResimMs, stats.maxResimMs,
+                static_cast<unsigned long long>(stats.overBudget), percentile(peers[p].advanceMs, 0.99f),
+                static_cast<unsigned long long>(stats.stalls), static_cast<unsigned long long>(stats.syncWaits),
+                static_cast<unsigned long long>(stats.packetsSent), static_cast<unsigned long long>(stats.packetsReceived),
+                static_cast<unsigned long long>(stats.bytesSent), static_cast<unsigned long long>(stats.checksumsCompared),
+                static_cast<unsigned long long>(stats.desyncs));
+            for (int depth = 0; depth < yume::RollbackStats::depth_buckets; depth++) {
+                std::fprintf(file, depth == 0 ? "%llu" : ", %llu", static_cast<unsigned long long>(stats.depthHistogram[depth]));
+            }
+            std::fprintf(file, "] }%s\n", p == 0 ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        std::fclose(file);
+    }
+
+    // a desync either way or a side that never confirmed the whole script fails the run
+    return desyncs == 0 && reported == 0 && compared >= static_cast<std::size_t>(ticks) ? 0 : 1;
+}
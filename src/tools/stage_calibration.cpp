@@ -0,0 +1,456 @@
+// Measures how hard every island stage is: thousands of island placements per stage are flown by a scripted pilot
+// and by a randomized one, in parallel on the job system with the game's flight model and landing rules.
+// Reports success, crash and timeout rates and the touchdown speed distribution per stage.
+// The rocket and the island collide by the alpha masks of res/textures, run it from the game's directory.
+// --wind flies with the gusts of YUME_ATMOSPHERE, see WindProfile for how closely.
+// usage: yumesdl_calibrate [--trials N] [--threads N] [--seed N] [--wind] [--json calibration.json]
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "../packages/jobs/job_system.hpp"
+#include "../packages/simulation/collision_mask.hpp"
+#include "../packages/simulation/flight_model.hpp"
+#include "../packages/simulation/autopilot.hpp"
+#include "../packages/simulation/wind_field.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr float step_time = 1.0f / 60.0f;
+    constexpr int max_steps = 60 * 60;  // a minute of flight, after that the attempt counts as timed out
+    constexpr int stage_count = yume::final_stage + 1;
+    constexpr float speed_bin = 5.0f;   // px/s per histogram bin
+    constexpr int speed_bins = 16;      // the last bin takes everything above 75 px/s
+
+    enum class Outcome : std::uint8_t { Landed, Crashed, TimedOut };
+
+    struct Trial {
+        Outcome outcome;
+        float touchdownSpeed;  // speed at the first ground or island contact, negative if it never touched down
+        float touchdownTime;
+    };
+
+    // noise 0 flies the script as written, above that each frame is replaced by a random press with this probability
+    // and the pilot's gains are scaled by up to +-30% per attempt
+    struct Pilot {
+        const char* name;
+        float noise;
+    };
+
+    const Pilot pilots[] = {
+        { "scripted", 0.0f },
+        { "randomized", 0.25f },
+    };
+    constexpr int pilot_count = static_cast<int>(sizeof(pilots) / sizeof(pilots[0]));
+
+    struct Gains {
+        float braking{ 1.5f };  // px/s^2 the pilot plans to stop with, well below what a tilted rocket manages
+        float tilt{ 2.0f };     // degrees of tilt per px/s of missing horizontal speed
+        float cruise{ 60.0f };  // px above the island top it crosses at, never closer than 5 px to the top of the screen
+    };
+
+    // The gusts of one stage as the game's wind field blows them, recorded once per stage on the field's center
+    // column every step from when the attempt starts. The bands run across the whole screen, so the air only
+    // changes with height and time. Left out are the exhaust, which only moves the air below the nozzle, and what
+    // little the open edges bend the bands near the sides.
+    struct WindProfile {
+        int rows{ 0 };
+        float cellSize{ yume::wind_cell_size };
+        std::vector<float> u, v;  // rows values per step
+
+        void record(int stage) {
+            yume::WindField field(yume::wind_columns, yume::wind_rows, yume::wind_cell_size);
+            field.setStage(stage);
+            rows = field.rows();
+            u.resize(static_cast<std::size_t>(rows) * max_steps);
+            v.resize(u.size());
+
+            float centerX = yume::wind_columns * yume::wind_cell_size / 2.0f;
+            for (int step = 0; step < max_steps; step++) {
+                field.step(step_time);
+                for (int row = 0; row < rows; row++) {
+                    yume::vec2<float> wind = field.sample({ centerX, (row + 0.5f) * cellSize });
+                    u[static_cast<std::size_t>(step) * rows + row] = wind.x;
+                    v[static_cast<std::size_t>(step) * rows + row] = wind.y;
+                }
+            }
+        }
+
+        yume::vec2<float> at(int step, float y) const {
+            if (rows == 0) {
+                return yume::vec2<float>(0.0f, 0.0f);
+            }
+            float row = std::clamp(y / cellSize - 0.5f, 0.0f, rows - 1.001f);
+            int below = static_cast<int>(row);
+            float share = row - below;
+            std::size_t i = static_cast<std::size_t>(step) * rows + below;
+            return yume::vec2<float>(u[i] * (1.0f - share) + u[i + 1] * share, v[i] * (1.0f - share) + v[i + 1] * share);
+        }
+    };
+
+    // the alpha channel of a texture as RenderManager::loadAlpha() reads it, decoding needs no window or renderer
+    yume::AlphaImage loadAlpha(const char* file) {
+        yume::AlphaImage image;
+        SDL_Surface* loaded = IMG_Load(file);
+        if (loaded == nullptr) {
+            std::printf("IMG_Load Error: %s\n", IMG_GetError());
+            return image;
+        }
+
+        SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (surface == nullptr) {
+            std::printf("SDL_ConvertSurfaceFormat Error: %s\n", SDL_GetError());
+            return image;
+        }
+
+        image.width = surface->w;
+        image.height = surface->h;
+        image.alpha.resize(static_cast<std::size_t>(surface->w) * surface->h);
+        SDL_LockSurface(surface);
+        for (int y = 0; y < surface->h; y++) {
+            const Uint8* row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch;
+            for (int x = 0; x < surface->w; x++) {
+                image.alpha[static_cast<std::size_t>(y) * surface->w + x] = row[x * 4 + 3];
+            }
+        }
+        SDL_UnlockSurface(surface);
+        SDL_FreeSurface(surface);
+        return image;
+    }
+
+    // The masks Rocket and Island build from their textures, one island mask per stage size.
+    struct Shapes {
+        yume::RotatedMaskSet rocket;
+        std::vector<yume::CollisionMask> islands;
+        std::vector<yume::CollisionShapes> stages;
+
+        bool load() {
+            yume::AlphaImage rocketAlpha = loadAlpha("res/textures/rocket.png");
+            yume::AlphaImage islandAlpha = loadAlpha("res/textures/island.png");
+            if (rocketAlpha.alpha.empty() || islandAlpha.alpha.empty()) {
+                return false;
+            }
+
+            rocket = yume::RotatedMaskSet(rocketAlpha, 32, 64, 2.0f);
+            for (int stage = 0; stage < stage_count; stage++) {
+                yume::vec2<float> size = yume::islandSizeAtStage(stage);
+                islands.push_back(yume::CollisionMask::fromAlpha(islandAlpha, static_cast<int>(size.x), static_cast<int>(size.y)));
+            }
+            for (const yume::CollisionMask& island : islands) {
+                stages.push_back(yume::CollisionShapes{ &rocket, &island });
+            }
+            return true;
+        }
+    };
+
+    // the speed from which braking at a stops exactly after distance
+    float approachSpeed(float distance, float braking, float limit) {
+        float speed = std::min(std::sqrt(2.0f * braking * std::abs(distance)), limit);
+        return distance < 0.0f ? -speed : speed;
+    }
+
+    // Climbs beside the island, flies over it at a safe height, then drops onto its middle. Horizontal speed comes
+    // from tilting away from upright, vertical speed from throttling against gravity, the same presses a player has.
+    yume::AutopilotInput flyScripted(const yume::RocketState& rocket, const yume::IslandState& island, const Gains& gains) {
+        yume::AutopilotInput input{ 0, 0 };
+
+        if (rocket.on_island) {
+            input.thrust = -1;
+            return input;
+        }
+
+        float rocketX = rocket.position.x + rocket.size.x / 2.0f;
+        float dx = (island.position.x + island.size.x / 2.0f) - rocketX;
+        float height = island.position.y - (rocket.position.y + rocket.size.y);
+
+        float targetX = island.position.x + island.size.x / 2.0f;
+        float cruise = gains.cruise;
+        bool drop = std::abs(dx) < island.size.x * 0.25f && std::abs(rocket.velocity.x) < 8.0f;
+
+        // on stages 2-4 it hovers just above the middle of the island's swing and drops when the island
+        // will be under it a second later, moveIsland() moves it by stage * 5 px/s
+        if (yume::islandOscillates(island.stage)) {
+            float islandVelocity = (island.movingRight ? 5.0f : -5.0f) * island.stage;
+            targetX = (island.leftBound + island.rightBound + island.size.x) / 2.0f;
+            cruise = 12.0f;
+            drop = std::abs(targetX - rocketX) < 20.0f && std::abs(rocket.velocity.x) < 5.0f && height < 30.0f
+                && std::abs(dx + islandVelocity) < island.size.x * 0.2f;
+        }
+
+        // below the island's top it climbs beside the island instead of into its underside
+        float offset = targetX - rocketX;
+        if (height < 10.0f) {
+            float clearance = island.size.x / 2.0f + rocket.size.x / 2.0f + 30.0f;
+            offset = dx > 0.0f ? dx - clearance : dx + clearance;
+        }
+
+        float desiredVelocityX = approachSpeed(offset, gains.braking, 30.0f);
+        float desiredVelocityY = drop ? std::clamp(approachSpeed(height, gains.braking, 18.0f), 4.0f, 18.0f)
+            : approachSpeed(std::max(height - cruise, 5.0f - rocket.position.y), gains.braking, 30.0f);
+
+        // close to the island only small corrections, a touchdown outside 75-105 degrees is a crash
+        float maxTilt = height < 40.0f && std::abs(dx) < island.size.x ? 8.0f : 25.0f;
+        float desiredRotation = 90.0f + std::clamp((desiredVelocityX - rocket.velocity.x) * gains.tilt, -maxTilt, maxTilt);
+        input.thrust = rocket.velocity.y > desiredVelocityY ? 1 : -1;
+
+        // the spin only decays by 2% a frame, steering on where half a second of it ends up keeps the tilt from overshooting
+        float predicted = rocket.rotation + rocket.rotationalVelocity * 0.5f;
+        if (predicted < desiredRotation - 1.5f) input.rotate = 1;
+        else if (predicted > desiredRotation + 1.5f) input.rotate = -1;
+        return input;
+    }
+
+    // one attempt from the launch pad, the rules Game::update() applies every frame
+    Trial runTrial(int stage, const Pilot& pilot, std::uint32_t seed, const WindProfile& wind, const yume::CollisionShapes& shapes) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> dis_x{ yume::island_spawn_left, yume::island_spawn_right };
+        std::uniform_int_distribution<> dis_y{ yume::island_spawn_top, yume::island_spawn_bottom };
+        std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+        std::uniform_int_distribution<> press{ -1, 1 };
+
+        yume::RocketState rocket{ { 575, 410 }, { 32, 64 }, yume::vec2<float>::ZERO(), yume::vec2<float>::ZERO(), 90, 0, 9.81f, 0,
+            false, false, true, true };
+        yume::vec2<float> position{ static_cast<float>(dis_x(gen)), static_cast<float>(dis_y(gen)) };
+        yume::IslandState island{ position, yume::islandSizeAtStage(stage), position.x - 50.0f, position.x + 50.0f, false, stage, &shapes };
+
+        Gains gains;
+        if (pilot.noise > 0.0f) {
+            gains.braking *= 0.7f + 0.6f * unit(gen);
+            gains.tilt *= 0.7f + 0.6f * unit(gen);
+            gains.cruise *= 0.7f + 0.6f * unit(gen);
+        }
+
+        Trial trial{ Outcome::TimedOut, -1.0f, 0.0f };
+        bool airborne = false;  // settling onto the pad does not count as a touchdown
+        bool winPredict = false;
+        float winTimer = 0.0f;
+
+        for (int step = 0; step < max_steps; step++) {
+            yume::AutopilotInput input = flyScripted(rocket, island, gains);
+            if (pilot.noise > 0.0f && unit(gen) < pilot.noise) {
+                input = yume::AutopilotInput{ press(gen), press(gen) };
+            }
+
+            if (input.thrust > 0) yume::increaseThrust(rocket);
+            else if (input.thrust < 0) yume::decreaseThrust(rocket);
+            if (input.rotate < 0) yume::rotateLeft(rocket);
+            else if (input.rotate > 0) yume::rotateRight(rocket);
+
+            rocket.wind = wind.at(step, rocket.position.y + rocket.size.y / 2.0f);
+            yume::stepFlight(rocket, island, step_time);
+
+            if (!rocket.grounded && rocket.position.y < yume::ground_level - rocket.size.y - 10.0f) {
+                airborne = true;
+            }
+            if (airborne && rocket.grounded && trial.touchdownSpeed < 0.0f) {
+                trial.touchdownSpeed = rocket.previousVelocity.length();
+                trial.touchdownTime = step * step_time;
+            }
+
+            winTimer = winPredict ? winTimer + step_time : 0.0f;
+            winPredict = false;
+            if (rocket.grounded) {
+                if (yume::isSafeLanding(rocket)) {
+                    winPredict = true;
+                    if (winTimer > yume::landing_hold_time) {
+                        trial.outcome = Outcome::Landed;
+                        break;
+                    }
+                }
+                else if (yume::isCrash(rocket)) {
+                    trial.outcome = Outcome::Crashed;
+                    break;
+                }
+            }
+        }
+        return trial;
+    }
+
+    struct StageReport {
+        int stage;
+        const Pilot* pilot;
+        int trials;
+        float landed, crashed, timedOut;  // shares of the trials
+        float speedMean, speedP10, speedP50, speedP90;
+        float landingTime;                // median seconds to the touchdown of the successful attempts
+        int histogram[speed_bins];
+    };
+
+    float percentile(const std::vector<float>& sorted, float share) {
+        if (sorted.empty()) {
+            return 0.0f;
+        }
+        std::size_t index = static_cast<std::size_t>(share * (sorted.size() - 1) + 0.5f);
+        return sorted[index];
+    }
+
+    StageReport summarize(int stage, const Pilot& pilot, const Trial* trials, int count) {
+        StageReport report{};
+        report.stage = stage;
+        report.pilot = &pilot;
+        report.trials = count;
+        std::vector<float> speeds;
+        std::vector<float> times;
+        int landed = 0, crashed = 0;
+
+        for (int i = 0; i < count; i++) {
+            const Trial& trial = trials[i];
+            if (trial.outcome == Outcome::Landed) {
+                landed++;
+                times.push_back(trial.touchdownTime);
+            }
+            else if (trial.outcome == Outcome::Crashed) {
+                crashed++;
+            }
+
+            if (trial.touchdownSpeed >= 0.0f) {
+                speeds.push_back(trial.touchdownSpeed);
+                report.histogram[std::min(static_cast<int>(trial.touchdownSpeed / speed_bin), speed_bins - 1)]++;
+            }
+        }
+
+        std::sort(speeds.begin(), speeds.end());
+        std::sort(times.begin(), times.end());
+
+        float sum = 0.0f;
+        for (float speed : speeds) sum += speed;
+
+        report.landed = static_cast<float>(landed) / count;
+        report.crashed = static_cast<float>(crashed) / count;
+        report.timedOut = 1.0f - report.landed - report.crashed;
+        report.speedMean = speeds.empty() ? 0.0f : sum / speeds.size();
+        report.speedP10 = percentile(speeds, 0.1f);
+        report.speedP50 = percentile(speeds, 0.5f);
+        report.speedP90 = percentile(speeds, 0.9f);
+        report.landingTime = percentile(times, 0.5f);
+        return report;
+    }
+
+    void writeJson(std::FILE* file, const std::vector<StageReport>& reports, int trials, bool wind, double elapsedMs) {
+        std::fprintf(file, "{\n  \"trials_per_stage\": %d,\n  \"wind\": %s,\n  \"elapsed_ms\": %.1f,\n  \"speed_bin\": %.1f,\n  \"landing_max_speed\": %.1f,\n  \"stages\": [\n",
+            trials, wind ? "\"gust profile\"" : "false", elapsedMs, speed_bin, yume::landing_max_speed);
+        for (std::size_t i = 0; i < reports.size(); i++) {
+            const StageReport& r = reports[i];
+            std::fprintf(file, "    { \"stage\": %d, \"pilot\": \"%s\", \"island_width\": %.1f, \"landed\": %.4f, \"crashed\": %.4f, \"timed_out\": %.4f, "
+                "\"touchdown_speed\": { \"mean\": %.2f, \"p10\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"histogram\": [",
+                r.stage, r.pilot->name, yume::islandSizeAtStage(r.stage).x, r.landed, r.crashed, r.timedOut,
+                r.speedMean, r.speedP10, r.speedP50, r.speedP90);
+            for (int b = 0; b < speed_bins; b++) {
+                std::fprintf(file, b == 0 ? "%d" : ", %d", r.histogram[b]);
+            }
+            std::fprintf(file, "] }, \"median_touchdown_time\": %.2f }%s\n", r.landingTime, i + 1 < reports.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+    }
+}
+
+int main(int argc, char* args[]) {
+    int trials = 2000;
+    unsigned threads = 0;
+    std::uint32_t seed = 1;
+    const char* jsonFile = nullptr;
+    bool wind = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(args[i], "--trials") == 0 && i + 1 < argc) {
+            trials = std::max(1, std::atoi(args[++i]));
+        }
+        else if (std::strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i])));
+        }
+        else if (std::strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::strtoul(args[++i], nullptr, 10));
+        }
+        else if (std::strcmp(args[i], "--json") == 0 && i + 1 < argc) {
+            jsonFile = args[++i];
+        }
+        else if (std::strcmp(args[i], "--wind") == 0) {
+            wind = true;
+        }
+        else {
+            std::printf("usage: %s [--trials N] [--threads N] [--seed N] [--wind] [--json calibration.json]\n", args[0]);
+            return 1;
+        }
+    }
+
+    Shapes shapes;
+    if (!shapes.load()) {
+        std::printf("the masks come from res/textures/rocket.png and island.png, run from the game's directory\n");
+        return 1;
+    }
+
+    yume::JobSystem jobs(threads);
+
+    // empty profiles are still air, the game's default
+    std::vector<WindProfile> winds(stage_count);
+    double windMs = 0.0;
+    if (wind) {
+        clock_type::time_point windStart = clock_type::now();
+        jobs.parallelFor(static_cast<std::size_t>(stage_count), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t stage = begin; stage < end; stage++) {
+                winds[stage].record(static_cast<int>(stage));
+            }
+        });
+        windMs = std::chrono::duration<double, std::milli>(clock_type::now() - windStart).count();
+    }
+
+    // every attempt has its own seed, the results do not depend on how the work is split
+    std::size_t perGroup = static_cast<std::size_t>(trials);
+    std::size_t total = perGroup * stage_count * pilot_count;
+    std::vector<Trial> results(total);
+
+    clock_type::time_point start = clock_type::now();
+    jobs.parallelFor(total, 64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            std::size_t group = i / perGroup;
+            int stage = static_cast<int>(group / pilot_count);
+            int pilot = static_cast<int>(group % pilot_count);
+            results[i] = runTrial(stage, pilots[pilot], seed * 2654435761u + static_cast<std::uint32_t>(i), winds[stage], shapes.stages[stage]);
+        }
+    });
+    double elapsed = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+
+    std::vector<StageReport> reports;
+    for (std::size_t group = 0; group < static_cast<std::size_t>(stage_count * pilot_count); group++) {
+        reports.push_back(summarize(static_cast<int>(group / pilot_count), pilots[group % pilot_count],
+            results.data() + group * perGroup, trials));
+    }
+
+    std::printf("%d attempts per stage and pilot, %zu in total on %u threads in %.0f ms\n", trials, total, jobs.threadCount(), elapsed);
+    if (wind) {
+        std::printf("wind: the gusts of each stage by height and time, recorded in %.0f ms, without the exhaust's own air or the bands bending at the edges\n\n", windMs);
+    }
+    else {
+        std::printf("wind: none, as the game without YUME_ATMOSPHERE. --wind adds the gusts of stages 3 and up\n\n");
+    }
+    std::printf("stage  island  pilot        landed  crashed  timeout   touchdown px/s p10/p50/p90   touchdown s\n");
+    for (const StageReport& r : reports) {
+        std::printf("%5d  %6.1f  %-10s  %6.1f%%  %6.1f%%  %6.1f%%   %6.1f %6.1f %6.1f          %6.1f\n",
+            r.stage, yume::islandSizeAtStage(r.stage).x, r.pilot->name, r.landed * 100.0f, r.crashed * 100.0f, r.timedOut * 100.0f,
+            r.speedP10, r.speedP50, r.speedP90, r.landingTime);
+    }
+
+    if (jsonFile != nullptr) {
+        std::FILE* file = std::fopen(jsonFile, "w");
+        if (file == nullptr) {
+            std::printf("could not write %s\n", jsonFile);
+            return 1;
+        }
+        writeJson(file, reports, trials, wind, elapsed);
+        std::fclose(file);
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Converts a binary flight log written by yume::TelemetryRecorder into CSV.
+// usage: yumesdl_telemetry_csv <flight.ytl> [out.csv]
+
+#include "../packages/telemetry/flight_record.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+int main(int argc, char* args[]) {
+    if (argc < 2) {
+        std::cout << "usage: " << args[0] << " <flight.ytl> [out.csv]\n";
+        return 1;
+    }
+
+    std::ifstream in(args[1], std::ios::binary);
+    if (!in) {
+        std::cout << "cannot open " << args[1] << '\n';
+        return 1;
+    }
+
+    yume::FlightLogHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, yume::flight_log_magic, 4) != 0) {
+        std::cout << args[1] << " is not a flight log\n";
+        return 1;
+    }
+    if (header.version != yume::flight_log_version || header.blockSamples != yume::flight_block_samples) {
+        std::cout << "unsupported flight log version " << header.version << " (or written on a machine with another byte order)\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc >= 3) {
+        file.open(args[2]);
+        if (!file) {
+            std::cout << "cannot open " << args[2] << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out = argc >= 3 ? file : std::cout;
+
+    out << "step,attempt,time,delta_time,x,y,velocity_x,velocity_y,rotation,rotational_velocity,thrust,grounded,on_island,stable,engine,stage\n";
+
+    auto block = std::make_unique<yume::FlightBlock>();
+    std::uint64_t samples = 0;
+
+    while (block->read(in)) {
+        for (std::uint32_t i = 0; i < block->count; i++) {
+            yume::FlightSample s = block->at(i);
+            out << s.step << ',' << s.attempt << ',' << s.time << ',' << s.deltaTime << ','
+                << s.x << ',' << s.y << ',' << s.velocityX << ',' << s.velocityY << ','
+                << s.rotation << ',' << s.rotationalVelocity << ',' << s.thrust << ','
+                << ((s.flags & yume::flight_grounded) != 0) << ',' << ((s.flags & yume::flight_on_island) != 0) << ','
+                << ((s.flags & yume::flight_stable) != 0) << ',' << ((s.flags & yume::flight_engine) != 0) << ','
+                << static_cast<int>(s.stage) << '\n';
+        }
+        samples += block->count;
+    }
+
+    if (block->count != 0 || !in.eof()) {
+        std::cerr << "warning: the log ends with a truncated block\n";
+    }
+    std::cerr << samples << " samples converted\n";
+
+    return 0;
+}
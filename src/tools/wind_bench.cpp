@@ -0,0 +1,46 @@
+// Times WindField::step() on the grid the game uses, with the stage 9 gusts and the exhaust of a hovering rocket.
+// usage: yumesdl_windbench [steps] [columns rows]
+
+#include "../packages/simulation/wind_field.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char* args[]) {
+    int steps = argc > 1 ? std::max(1, std::atoi(args[1])) : 3000;
+    int columns = argc > 3 ? std::max(4, std::atoi(args[2])) : yume::wind_columns;
+    int rows = argc > 3 ? std::max(4, std::atoi(args[3])) : yume::wind_rows;
+    float cellSize = yume::wind_columns * yume::wind_cell_size / columns;
+
+    yume::WindField field(columns, rows, cellSize);
+    field.setStage(9);
+    yume::RocketState rocket{ { 400, 300 }, { 32, 64 }, { 0, 0 }, { 0, 0 }, 90, 10.0f, 9.81f, 0, false, false, true, true };
+
+    // a few seconds for the gusts to fill their bands before anything is timed
+    for (int i = 0; i < 300; i++) {
+        yume::blowExhaust(field, rocket, 1.0f / 60.0f);
+        field.step(1.0f / 60.0f);
+    }
+
+    std::vector<double> times;
+    times.reserve(steps);
+    for (int i = 0; i < steps; i++) {
+        yume::blowExhaust(field, rocket, 1.0f / 60.0f);
+        auto start = std::chrono::steady_clock::now();
+        field.step(1.0f / 60.0f);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    double total = 0.0;
+    for (double ms : times) total += ms;
+    std::sort(times.begin(), times.end());
+
+    yume::vec2<float> wind = field.sample({ 400, 180 });
+    std::printf("%dx%d cells of %.2f px, %d steps: mean %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms\n",
+        columns, rows, cellSize, steps, total / steps, times[steps / 2], times[steps * 99 / 100], times.back());
+    std::printf("wind at (400, 180): %.2f, %.2f px/s\n", wind.x, wind.y);
+    return 0;
+}